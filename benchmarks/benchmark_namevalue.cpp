@@ -0,0 +1,90 @@
+#include <datareaderstream.h>
+#include <datawriterstream.h>
+#include <msgparams.h>
+#include <namevalue.h>
+#include <fcgi_responder/requestparams.h>
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace fcgi;
+
+namespace {
+
+// names and values longer than 127 bytes are encoded with 4-byte lengths
+NameValue makeNameValue(bool isLong)
+{
+    if (isLong)
+        return NameValue{"HTTP_" + std::string(200, 'N'), std::string(1000, 'v')};
+    return NameValue{"HTTP_HOST", "localhost"};
+}
+
+void nameValueToStream(benchmark::State& state)
+{
+    const auto nameValue = makeNameValue(state.range(0));
+    auto stream = DataWriterStream{};
+    for (auto _ : state) {
+        stream.resetBuffer(nameValue.size());
+        nameValue.toStream(stream);
+        benchmark::DoNotOptimize(stream.buffer().data());
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * nameValue.size()));
+}
+
+void nameValueFromStream(benchmark::State& state)
+{
+    const auto nameValue = makeNameValue(state.range(0));
+    auto output = std::ostringstream{};
+    nameValue.toStream(output);
+    const auto data = output.str();
+    for (auto _ : state) {
+        auto stream = DataReaderStream{std::string_view{data}};
+        auto result = NameValue{data.size()};
+        result.fromStream(stream);
+        benchmark::DoNotOptimize(result.value().data());
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * data.size()));
+}
+
+std::vector<std::pair<std::string, std::string>> makeParams(std::int64_t paramsNumber)
+{
+    auto result = std::vector<std::pair<std::string, std::string>>{};
+    for (auto i = std::int64_t{}; i < paramsNumber; ++i)
+        result.emplace_back("HTTP_HEADER_" + std::to_string(i), "value of the header " + std::to_string(i));
+    return result;
+}
+
+// encoding of the Requester's parameters before RequestParams, with a lookup of the duplicates on each insertion
+void msgParamsToStream(benchmark::State& state)
+{
+    const auto params = makeParams(state.range(0));
+    auto stream = DataWriterStream{};
+    for (auto _ : state) {
+        auto msg = MsgParams{};
+        for (const auto& [name, value] : params)
+            msg.setParam(name, value);
+        stream.resetBuffer(msg.size());
+        msg.toStream(stream);
+        benchmark::DoNotOptimize(stream.buffer().data());
+    }
+}
+
+void requestParamsAdd(benchmark::State& state)
+{
+    const auto params = makeParams(state.range(0));
+    auto requestParams = RequestParams{};
+    for (auto _ : state) {
+        requestParams.clear();
+        for (const auto& [name, value] : params)
+            requestParams.add(name, value);
+        benchmark::DoNotOptimize(requestParams.data().data());
+    }
+}
+
+} //namespace
+
+BENCHMARK(nameValueToStream)->ArgName("long")->Arg(0)->Arg(1);
+BENCHMARK(nameValueFromStream)->ArgName("long")->Arg(0)->Arg(1);
+BENCHMARK(msgParamsToStream)->ArgName("params")->Arg(8)->Arg(64);
+BENCHMARK(requestParamsAdd)->ArgName("params")->Arg(8)->Arg(64);
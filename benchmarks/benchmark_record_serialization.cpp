@@ -0,0 +1,140 @@
+#include "benchmark_utils.h"
+#include <constants.h>
+#include <datareaderstream.h>
+#include <datawriterstream.h>
+#include <msgabortrequest.h>
+#include <msgbeginrequest.h>
+#include <msgendrequest.h>
+#include <msggetvalues.h>
+#include <msggetvaluesresult.h>
+#include <msgparams.h>
+#include <msgunknowntype.h>
+#include <record.h>
+#include <streamdatamessage.h>
+#include <benchmark/benchmark.h>
+
+using namespace fcgi;
+
+namespace {
+
+template<typename TMsg>
+TMsg makeMessage();
+
+template<>
+MsgBeginRequest makeMessage()
+{
+    return MsgBeginRequest{Role::Responder, ResultConnectionState::KeepOpen};
+}
+
+template<>
+MsgEndRequest makeMessage()
+{
+    return MsgEndRequest{0, ProtocolStatus::RequestComplete};
+}
+
+template<>
+MsgAbortRequest makeMessage()
+{
+    return MsgAbortRequest{};
+}
+
+template<>
+MsgUnknownType makeMessage()
+{
+    return MsgUnknownType{42};
+}
+
+template<>
+MsgGetValues makeMessage()
+{
+    auto msg = MsgGetValues{};
+    msg.requestValue(ValueRequest::MaxConns);
+    msg.requestValue(ValueRequest::MaxReqs);
+    msg.requestValue(ValueRequest::MpxsConns);
+    return msg;
+}
+
+template<>
+MsgGetValuesResult makeMessage()
+{
+    auto msg = MsgGetValuesResult{};
+    msg.setRequestValue(ValueRequest::MaxConns, "100");
+    msg.setRequestValue(ValueRequest::MaxReqs, "10");
+    msg.setRequestValue(ValueRequest::MpxsConns, "1");
+    return msg;
+}
+
+template<>
+MsgParams makeMessage()
+{
+    return benchmarks::makeParamsMessage();
+}
+
+template<typename TMsg>
+void recordToStream(benchmark::State& state)
+{
+    const auto record = Record{makeMessage<TMsg>(), 1};
+    auto stream = DataWriterStream{};
+    for (auto _ : state) {
+        stream.resetBuffer(record.size());
+        record.toStream(stream);
+        benchmark::DoNotOptimize(stream.buffer().data());
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * record.size()));
+}
+
+template<typename TMsg>
+void recordFromStream(benchmark::State& state)
+{
+    const auto data = benchmarks::messageData(makeMessage<TMsg>(), 1);
+    for (auto _ : state) {
+        auto stream = DataReaderStream{std::string_view{data}};
+        auto record = Record{};
+        benchmark::DoNotOptimize(record.fromStream(stream, data.size()));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * data.size()));
+}
+
+void stdOutRecordToStream(benchmark::State& state)
+{
+    const auto data = std::string(static_cast<std::size_t>(state.range(0)), 'x');
+    const auto record = Record{MsgStdOut{data}, 1};
+    auto stream = DataWriterStream{};
+    for (auto _ : state) {
+        stream.resetBuffer(record.size());
+        record.toStream(stream);
+        benchmark::DoNotOptimize(stream.buffer().data());
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * record.size()));
+}
+
+void stdInRecordFromStream(benchmark::State& state)
+{
+    const auto data = benchmarks::messageData(MsgStdIn{std::string(static_cast<std::size_t>(state.range(0)), 'x')}, 1);
+    for (auto _ : state) {
+        auto stream = DataReaderStream{std::string_view{data}};
+        auto record = Record{};
+        benchmark::DoNotOptimize(record.fromStream(stream, data.size()));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * data.size()));
+}
+
+} //namespace
+
+BENCHMARK_TEMPLATE(recordToStream, MsgBeginRequest);
+BENCHMARK_TEMPLATE(recordToStream, MsgEndRequest);
+BENCHMARK_TEMPLATE(recordToStream, MsgAbortRequest);
+BENCHMARK_TEMPLATE(recordToStream, MsgUnknownType);
+BENCHMARK_TEMPLATE(recordToStream, MsgGetValues);
+BENCHMARK_TEMPLATE(recordToStream, MsgGetValuesResult);
+BENCHMARK_TEMPLATE(recordToStream, MsgParams);
+BENCHMARK(stdOutRecordToStream)->Arg(64)->Arg(4096)->Arg(hardcoded::maxDataMessageSize);
+
+BENCHMARK_TEMPLATE(recordFromStream, MsgBeginRequest);
+BENCHMARK_TEMPLATE(recordFromStream, MsgEndRequest);
+BENCHMARK_TEMPLATE(recordFromStream, MsgAbortRequest);
+BENCHMARK_TEMPLATE(recordFromStream, MsgUnknownType);
+BENCHMARK_TEMPLATE(recordFromStream, MsgGetValues);
+BENCHMARK_TEMPLATE(recordFromStream, MsgGetValuesResult);
+BENCHMARK_TEMPLATE(recordFromStream, MsgParams);
+BENCHMARK(stdInRecordFromStream)->Arg(64)->Arg(4096)->Arg(hardcoded::maxDataMessageSize);
@@ -0,0 +1,45 @@
+#include "benchmark_utils.h"
+#include <msgbeginrequest.h>
+#include <msgparams.h>
+#include <record.h>
+#include <recordreader.h>
+#include <streamdatamessage.h>
+#include <benchmark/benchmark.h>
+#include <algorithm>
+
+using namespace fcgi;
+
+namespace {
+
+// records of a request with nginx parameters and a 16 KB body
+std::string makeRequestData()
+{
+    auto data = benchmarks::messageData(MsgBeginRequest{Role::Responder, ResultConnectionState::KeepOpen}, 1);
+    data += benchmarks::messageData(benchmarks::makeParamsMessage(), 1);
+    data += benchmarks::messageData(MsgParams{}, 1);
+    data += benchmarks::messageData(MsgStdIn{std::string(16 * 1024, 'x')}, 1);
+    data += benchmarks::messageData(MsgStdIn{}, 1);
+    return data;
+}
+
+void recordReaderRead(benchmark::State& state)
+{
+    const auto data = makeRequestData();
+    const auto fragmentSize = state.range(0) ? static_cast<std::size_t>(state.range(0)) : data.size();
+    auto recordsNumber = 0;
+    auto recordReader = RecordReader{[&recordsNumber](Record&)
+                                     {
+                                         ++recordsNumber;
+                                     }};
+    for (auto _ : state) {
+        for (auto offset = std::size_t{}; offset < data.size(); offset += fragmentSize)
+            recordReader.read(data.data() + offset, std::min(fragmentSize, data.size() - offset));
+    }
+    benchmark::DoNotOptimize(recordsNumber);
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * data.size()));
+}
+
+} //namespace
+
+// fragment size, 0 - all records are read at once
+BENCHMARK(recordReaderRead)->ArgName("fragment")->Arg(0)->Arg(16384)->Arg(4096)->Arg(1024)->Arg(128)->Arg(16);
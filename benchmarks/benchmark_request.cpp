@@ -0,0 +1,37 @@
+#include "benchmark_utils.h"
+#include <msgparams.h>
+#include <requestdata.h>
+#include <streamdatamessage.h>
+#include <fcgi_responder/request.h>
+#include <benchmark/benchmark.h>
+
+using namespace fcgi;
+
+namespace {
+
+void requestFromMessages(benchmark::State& state)
+{
+    const auto paramsMsg = benchmarks::makeParamsMessage(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        auto requestData = RequestData{true};
+        requestData.addMessage(paramsMsg);
+        requestData.addMessage(MsgStdIn{});
+        auto request = requestData.makeRequest();
+        benchmark::DoNotOptimize(request->params().data());
+    }
+}
+
+void requestParamLookup(benchmark::State& state)
+{
+    const auto paramsMsg = benchmarks::makeParamsMessage(static_cast<std::size_t>(state.range(0)));
+    auto requestData = RequestData{true};
+    requestData.addMessage(paramsMsg);
+    const auto request = requestData.makeRequest();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(request->param("HTTP_HOST").data());
+}
+
+} //namespace
+
+BENCHMARK(requestFromMessages)->ArgName("params")->Arg(10)->Arg(50)->Arg(200);
+BENCHMARK(requestParamLookup)->ArgName("params")->Arg(10)->Arg(50)->Arg(200);
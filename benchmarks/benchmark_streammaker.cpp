@@ -0,0 +1,20 @@
+#include <streamdatamessage.h>
+#include <streammaker.h>
+#include <benchmark/benchmark.h>
+
+using namespace fcgi;
+
+namespace {
+
+void makeStdOutStream(benchmark::State& state)
+{
+    const auto data = std::string(static_cast<std::size_t>(state.range(0)), 'x');
+    for (auto _ : state) {
+        auto stream = makeStream<MsgStdOut>(1, data);
+        benchmark::DoNotOptimize(stream.data());
+    }
+}
+
+} //namespace
+
+BENCHMARK(makeStdOutStream)->Arg(64 * 1024)->Arg(1024 * 1024)->Arg(16 * 1024 * 1024);
@@ -0,0 +1,65 @@
+#pragma once
+#include <msgparams.h>
+#include <record.h>
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fcgi::benchmarks {
+
+///
+/// Parameters set by nginx with the default fastcgi_params file, extended with HTTP_X_PARAM_N headers
+/// if more parameters are requested
+///
+inline std::vector<std::pair<std::string, std::string>> makeParams(std::size_t paramsNumber = 0)
+{
+    auto params = std::vector<std::pair<std::string, std::string>>{
+            {"QUERY_STRING", "page=1"},
+            {"REQUEST_METHOD", "GET"},
+            {"CONTENT_TYPE", ""},
+            {"CONTENT_LENGTH", ""},
+            {"SCRIPT_NAME", "/index.php"},
+            {"REQUEST_URI", "/index.php?page=1"},
+            {"DOCUMENT_URI", "/index.php"},
+            {"DOCUMENT_ROOT", "/var/www/html"},
+            {"SERVER_PROTOCOL", "HTTP/1.1"},
+            {"REQUEST_SCHEME", "http"},
+            {"GATEWAY_INTERFACE", "CGI/1.1"},
+            {"SERVER_SOFTWARE", "nginx/1.24.0"},
+            {"REMOTE_ADDR", "127.0.0.1"},
+            {"REMOTE_PORT", "48624"},
+            {"SERVER_ADDR", "127.0.0.1"},
+            {"SERVER_PORT", "80"},
+            {"SERVER_NAME", "localhost"},
+            {"REDIRECT_STATUS", "200"},
+            {"HTTP_HOST", "localhost"},
+            {"HTTP_USER_AGENT", "Mozilla/5.0 (X11; Linux x86_64; rv:109.0) Gecko/20100101 Firefox/115.0"}};
+    if (paramsNumber == 0)
+        return params;
+    params.resize(std::min(params.size(), paramsNumber));
+    for (auto i = params.size(); i < paramsNumber; ++i)
+        params.emplace_back("HTTP_X_PARAM_" + std::to_string(i), "value of the parameter #" + std::to_string(i));
+    return params;
+}
+
+inline MsgParams makeParamsMessage(std::size_t paramsNumber = 0)
+{
+    auto msg = MsgParams{};
+    for (const auto& [name, value] : makeParams(paramsNumber))
+        msg.setParam(name, value);
+    return msg;
+}
+
+template<typename TMsg>
+std::string messageData(TMsg&& msg, std::uint16_t requestId)
+{
+    auto record = Record{std::forward<TMsg>(msg), requestId};
+    auto recordStream = std::ostringstream{};
+    record.toStream(recordStream);
+    return recordStream.str();
+}
+
+} //namespace fcgi::benchmarks
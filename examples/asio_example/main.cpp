@@ -1,57 +1,18 @@
-#include "asio.hpp"
-#include <fcgi_responder/responder.h>
+#include <fcgi_responder/asio.h>
 #include <iostream>
+#include <memory>
 
 using unixdomain = asio::local::stream_protocol;
 
-class Connection : public fcgi::Responder{
+///
+/// fcgi::AsioResponderConnection reads the socket data and writes the response data asynchronously,
+/// the connection stays alive while its socket is open
+///
+class Connection : public fcgi::AsioResponderConnection<unixdomain::socket>{
 public:
-    explicit Connection(unixdomain::socket&& socket)
-    : socket_(std::move(socket))
-    {
-    }
-
-    void process()
-    {
-        while(isOpened_){
-            try {
-                auto receivedDataSize = socket_.read_some(asio::buffer(buffer_));
-                ///
-                /// Passing read socket data with fcgi::Responder::receiveData method
-                ///
-                receiveData(buffer_.data(), receivedDataSize);
-            }
-            catch(...){
-                isOpened_ = false;
-                return;
-            }
-        }
-    }
+    using fcgi::AsioResponderConnection<unixdomain::socket>::AsioResponderConnection;
 
 private:
-    ///
-    /// Overriding fcgi::Responder::sendData to send response data to the web server
-    ///
-    void sendData(const std::string& data) override
-    {
-        asio::write(socket_, asio::buffer(data, data.size()));
-    }
-
-    ///
-    /// Overriding fcgi::Responder::disconnect to close connection with the web server
-    ///
-    void disconnect() override
-    {
-        try{
-            socket_.shutdown(unixdomain::socket::shutdown_both);
-            socket_.close();
-        }
-        catch(const std::system_error& e){
-            std::cerr << "socket close error:" << e.code();
-        }
-        isOpened_ = false;
-    };
-
     ///
     /// Overriding fcgi::Responder::processRequest to form response data
     ///
@@ -63,13 +24,19 @@ private:
                          "HELLO WORLD USING ASIO!");
         response.send();
     }
-
-private:
-    unixdomain::socket socket_;
-    std::array<char, 65536> buffer_;
-    bool isOpened_ = true;
 };
 
+void accept(unixdomain::acceptor& acceptor)
+{
+    acceptor.async_accept([&acceptor](const asio::error_code& error, unixdomain::socket socket){
+        if (!error)
+            std::make_shared<Connection>(std::move(socket))->start();
+        else
+            std::cerr << "accept error:" << error;
+        accept(acceptor);
+    });
+}
+
 int main ()
 {
     auto socketPath = std::string{"/tmp/fcgi.sock"};
@@ -79,11 +46,7 @@ int main ()
 
     auto io = asio::io_context{};
     auto acceptor = unixdomain::acceptor{io, unixdomain::endpoint{socketPath}};
-
-    while (true) {
-        auto socket = acceptor.accept();
-        auto connection = Connection{std::move(socket)};
-        connection.process();
-    }
+    accept(acceptor);
+    io.run();
     return 0;
 }
@@ -1,58 +1,9 @@
-#include "asio.hpp"
-#include <fcgi_responder/requester.h>
+#include <fcgi_responder/asio.h>
 #include <iostream>
+#include <memory>
 
 using unixdomain = asio::local::stream_protocol;
 
-
-class Client : public fcgi::Requester{
-public:
-    explicit Client(unixdomain::socket&& socket)
-    : socket_(std::move(socket))
-    {
-    }
-
-    void process()
-    {
-        while(isOpened_){
-            auto receivedDataSize = socket_.read_some(asio::buffer(buffer_));
-            ///
-            /// Passing read socket data with fcgi::Requester::receiveData method
-            ///
-            receiveData(buffer_.data(), receivedDataSize);
-        }
-    }
-
-private:
-    ///
-    /// Overriding fcgi::Requester::sendData to send request data to the FastCGI application
-    ///
-    void sendData(const std::string& data) override
-    {
-        asio::write(socket_, asio::buffer(data, data.size()));
-    }
-
-    ///
-    /// Overriding fcgi::Requester::disconnect to close connection with the FastCGI application
-    ///
-    void disconnect() override
-    {
-        try{
-            socket_.shutdown(unixdomain::socket::shutdown_both);
-            socket_.close();
-        }
-        catch(const std::system_error& e){
-            std::cerr << "socket close error:" << e.code();
-        }
-        isOpened_ = false;
-    };
-
-private:
-    unixdomain::socket socket_;
-    std::array<char, 65536> buffer_;
-    bool isOpened_ = true;
-};
-
 void onResponseReceived(const std::optional<fcgi::ResponseData>& response)
 {
     std::cout << "Response:" << std::endl;
@@ -75,14 +26,18 @@ int main ()
         return 1;
     }
 
-    auto client = Client{std::move(socket)};
-    client.setErrorInfoHandler([](const std::string& error){
+    ///
+    /// fcgi::AsioRequesterConnection reads the socket data and writes the request data asynchronously
+    ///
+    auto client = std::make_shared<fcgi::AsioRequesterConnection<unixdomain::socket>>(std::move(socket));
+    client->setErrorInfoHandler([](const std::string& error){
         std::cout << error << std::endl;
     });
-    client.sendRequest({{"REQUEST_METHOD","GET"},
-                        {"REMOTE_ADDR","127.0.0.1"},
-                        {"HTTP_HOST","localhost"},
-                        {"REQUEST_URI","/"}}, {}, onResponseReceived);
-    client.process();
+    client->start();
+    client->sendRequest({{"REQUEST_METHOD","GET"},
+                         {"REMOTE_ADDR","127.0.0.1"},
+                         {"HTTP_HOST","localhost"},
+                         {"REQUEST_URI","/"}}, {}, onResponseReceived);
+    io.run();
     return 0;
-}
\ No newline at end of file
+}
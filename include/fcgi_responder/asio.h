@@ -0,0 +1,321 @@
+#pragma once
+#include "authorizer.h"
+#include "filter.h"
+#include "requester.h"
+#include "responder.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#ifdef FCGI_RESPONDER_BOOST_ASIO
+#include <boost/asio.hpp>
+#else
+#include <asio.hpp>
+#endif
+
+///
+/// Header-only adapters for serving and making FastCGI requests over Asio sockets.
+/// Standalone Asio is used by default, define FCGI_RESPONDER_BOOST_ASIO to use Boost.Asio instead.
+///
+
+namespace fcgi {
+
+namespace asio_support {
+#ifdef FCGI_RESPONDER_BOOST_ASIO
+namespace net = boost::asio;
+using error_code = boost::system::error_code;
+#else
+namespace net = ::asio;
+using error_code = ::asio::error_code;
+#endif
+
+///
+/// \brief Read and write loop of the connections, shared by AsioResponderConnection and AsioRequesterConnection.
+/// Received data is read into a reusable buffer, outgoing data is queued and sent with gathered writes,
+/// each write takes all data queued while the previous one was in progress.
+/// All handlers are invoked by the socket's executor, so a socket created with a strand
+/// can be used with an io_context running in multiple threads.
+///
+template<typename TBase, typename TSocket>
+class AsioConnection : public TBase, public std::enable_shared_from_this<AsioConnection<TBase, TSocket>> {
+    static constexpr bool isResponder = std::is_base_of_v<Responder, TBase>;
+
+public:
+    using Socket = TSocket;
+    using Executor = typename TSocket::executor_type;
+
+    ///
+    /// \brief start
+    /// Starts reading the connection's socket.
+    /// The connection must be owned by std::shared_ptr, pending operations keep it alive until the socket is closed.
+    ///
+    void start()
+    {
+        read();
+    }
+
+    ///
+    /// \brief close
+    /// Closes the connection's socket without waiting for the queued data to be sent
+    ///
+    void close()
+    {
+        if (isClosed_)
+            return;
+        isClosed_ = true;
+        auto error = error_code{};
+        socket_.shutdown(TSocket::shutdown_both, error);
+        socket_.close(error);
+    }
+
+    ///
+    /// \brief isClosed
+    /// \return true if the connection's socket is closed
+    ///
+    bool isClosed() const
+    {
+        return isClosed_;
+    }
+
+    ///
+    /// \brief executor
+    /// Responder and Requester aren't thread-safe: to send responses or requests from other threads,
+    /// post them to this executor.
+    /// \return executor of the connection's socket
+    ///
+    Executor executor()
+    {
+        return socket_.get_executor();
+    }
+
+    ///
+    /// \brief socket
+    /// \return the connection's socket
+    ///
+    TSocket& socket()
+    {
+        return socket_;
+    }
+
+    ///
+    /// \brief writeQueueSize
+    /// \return size of the data queued for writing to the socket
+    ///
+    std::size_t writeQueueSize() const
+    {
+        return writeQueueSize_;
+    }
+
+protected:
+    explicit AsioConnection(TSocket&& socket, std::size_t readBufferSize)
+        : socket_{std::move(socket)}
+        , readBuffer_(readBufferSize)
+    {
+    }
+
+    void sendData(const std::string& data) override
+    {
+        if (isClosed_ || data.empty())
+            return;
+        auto buffer = std::string{};
+        if (!freeBuffers_.empty()) {
+            buffer = std::move(freeBuffers_.back());
+            freeBuffers_.pop_back();
+        }
+        buffer.assign(data);
+        pendingBuffers_.emplace_back(std::move(buffer));
+        writeQueueSize_ += data.size();
+        if (!isWriting_)
+            write();
+    }
+
+    void disconnect() override
+    {
+        isDisconnectRequested_ = true;
+        if (!isWriting_)
+            close();
+    }
+
+private:
+    void read()
+    {
+        if (isClosed_)
+            return;
+        if constexpr (isResponder) {
+            if (isReadingPaused())
+                return;
+        }
+        isReading_ = true;
+        socket_.async_read_some(
+                net::buffer(readBuffer_),
+                [self = this->shared_from_this()](const auto& error, std::size_t size)
+                {
+                    self->onRead(error, size);
+                });
+    }
+
+    void onRead(const error_code& error, std::size_t size)
+    {
+        isReading_ = false;
+        if (error) {
+            close();
+            return;
+        }
+        this->receiveData(readBuffer_.data(), size);
+        read();
+    }
+
+    void write()
+    {
+        if (isWriting_ || pendingBuffers_.empty() || isClosed_)
+            return;
+        isWriting_ = true;
+        std::swap(pendingBuffers_, writingBuffers_);
+        writeBufferSequence_.clear();
+        for (const auto& buffer : writingBuffers_)
+            writeBufferSequence_.emplace_back(net::buffer(buffer));
+
+        net::async_write(
+                socket_,
+                writeBufferSequence_,
+                [self = this->shared_from_this()](const auto& error, std::size_t size)
+                {
+                    self->onWritten(error, size);
+                });
+    }
+
+    void onWritten(const error_code& error, std::size_t size)
+    {
+        isWriting_ = false;
+        writeQueueSize_ -= size;
+        for (auto& buffer : writingBuffers_) {
+            buffer.clear();
+            freeBuffers_.emplace_back(std::move(buffer));
+        }
+        writingBuffers_.clear();
+        if (error) {
+            close();
+            return;
+        }
+
+        this->onWritable();
+        write();
+        if (isDisconnectRequested_ && !isWriting_) {
+            close();
+            return;
+        }
+        if (!isReading_)
+            read();
+    }
+
+    bool isReadingPaused() const
+    {
+        return this->isOutputQueueFull() || writeQueueSize_ >= this->outputHighWaterMark();
+    }
+
+protected:
+    TSocket socket_;
+
+private:
+    std::vector<char> readBuffer_;
+    std::vector<std::string> pendingBuffers_;
+    std::vector<std::string> writingBuffers_;
+    std::vector<std::string> freeBuffers_;
+    std::vector<net::const_buffer> writeBufferSequence_;
+    std::size_t writeQueueSize_ = 0;
+    bool isReading_ = false;
+    bool isWriting_ = false;
+    bool isDisconnectRequested_ = false;
+    bool isClosed_ = false;
+};
+
+} //namespace asio_support
+
+///
+/// \brief Responder serving a connection with the web server over an Asio stream socket,
+/// for example asio::local::stream_protocol::socket or asio::ip::tcp::socket.
+/// Implement processRequest in a subclass, create it with std::make_shared and call start().
+/// Response data exceeding the output high-water mark is kept in the Responder's output queue,
+/// and reading of the socket is paused until the written data is drained.
+/// Pass fcgi::Authorizer or fcgi::Filter as TResponder to serve the other roles,
+/// see AsioAuthorizerConnection and AsioFilterConnection.
+///
+template<typename TSocket, typename TResponder = Responder>
+class AsioResponderConnection : public asio_support::AsioConnection<TResponder, TSocket> {
+public:
+    explicit AsioResponderConnection(TSocket&& socket, std::size_t readBufferSize = 65536)
+        : asio_support::AsioConnection<TResponder, TSocket>{std::move(socket), readBufferSize}
+    {
+    }
+
+protected:
+    std::size_t trySendData(const std::string& data) override
+    {
+        if (this->writeQueueSize() >= this->outputHighWaterMark())
+            return 0;
+        this->sendData(data);
+        return data.size();
+    }
+};
+
+///
+/// \brief Authorizer serving a connection with the web server over an Asio stream socket.
+/// Implement authorizeRequest in a subclass, create it with std::make_shared and call start().
+///
+template<typename TSocket>
+using AsioAuthorizerConnection = AsioResponderConnection<TSocket, Authorizer>;
+
+///
+/// \brief Filter serving a connection with the web server over an Asio stream socket.
+/// Implement processFilterRequest in a subclass, create it with std::make_shared and call start().
+///
+template<typename TSocket>
+using AsioFilterConnection = AsioResponderConnection<TSocket, Filter>;
+
+///
+/// \brief Requester making requests to the FastCGI application over a connected Asio stream socket.
+/// Create it with std::make_shared and call start() before sending the requests.
+/// The writers of the requests started with startRequest are notified each time the socket write completes.
+///
+template<typename TSocket>
+class AsioRequesterConnection : public asio_support::AsioConnection<Requester, TSocket> {
+public:
+    explicit AsioRequesterConnection(TSocket&& socket, std::size_t readBufferSize = 65536)
+        : asio_support::AsioConnection<Requester, TSocket>{std::move(socket), readBufferSize}
+    {
+    }
+
+    ///
+    /// \brief setOutputHighWaterMark
+    /// Sets a size of the data queued for writing to the socket,
+    /// above which the writers of the streamed request data wait until it's drained.
+    /// Default value is 1 MB.
+    /// \param size
+    ///
+    void setOutputHighWaterMark(std::size_t size)
+    {
+        outputHighWaterMark_ = size;
+    }
+
+    ///
+    /// \brief outputHighWaterMark
+    /// \return Size of the queued data above which the request data writers wait
+    ///
+    std::size_t outputHighWaterMark() const
+    {
+        return outputHighWaterMark_;
+    }
+
+protected:
+    bool isWritable() const override
+    {
+        return this->writeQueueSize() < outputHighWaterMark_;
+    }
+
+private:
+    std::size_t outputHighWaterMark_ = 1024 * 1024;
+};
+
+} //namespace fcgi
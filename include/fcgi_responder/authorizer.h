@@ -0,0 +1,32 @@
+#pragma once
+#include "authorizerresponse.h"
+#include "responder.h"
+
+namespace fcgi {
+
+///
+/// \brief Abstract class which implements message flow of the FastCGI protocol's
+/// Authorizer role between application and web server.
+/// It accepts only the requests with the Authorizer role and passes them to authorizeRequest
+/// as soon as their parameters are received. The settings and the transport methods are the same
+/// as in fcgi::Responder.
+///
+class Authorizer : public Responder {
+protected:
+    Authorizer();
+
+    ///
+    /// \brief authorizeRequest
+    /// Implement this method to make the authorization decision for the web server
+    /// and send it using the fcgi::AuthorizerResponse object
+    /// \param request - HTTP request parameters, the request data isn't passed to authorizers
+    /// \param response
+    ///
+    virtual void authorizeRequest(Request&& request, AuthorizerResponse&& response) = 0;
+
+private:
+    // requests are passed to authorizeRequest instead
+    void processRequest(Request&& request, Response&& response) final;
+};
+
+} //namespace fcgi
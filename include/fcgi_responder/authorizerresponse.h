@@ -0,0 +1,96 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace fcgi {
+class CancellationToken;
+
+///
+/// \brief Move-only object used to send the authorization decision from the application.
+/// The decision is encoded as CGI response headers while it's being set,
+/// an authorizer response doesn't have a body.
+///
+class AuthorizerResponse {
+    using ResponseSender = std::function<void(std::string&& headers)>;
+
+public:
+    ///
+    /// \brief Constructor
+    /// \param sender - a function sending the encoded response headers
+    /// \param cancellationToken - state of the request, set by fcgi::Authorizer
+    ///
+    explicit AuthorizerResponse(ResponseSender sender, std::shared_ptr<CancellationToken> cancellationToken = {});
+
+    ///
+    /// \brief allow
+    /// Authorizes the request by setting the "200 OK" response status
+    ///
+    void allow();
+
+    ///
+    /// \brief deny
+    /// Denies the request by setting the response status, which is passed by the web server to the client.
+    /// Requests are denied with the "403 Forbidden" status unless allow() is called.
+    /// \param httpStatus
+    ///
+    void deny(int httpStatus = 403);
+
+    ///
+    /// \brief setVariable
+    /// Adds a "Variable-<name>" header. The web server passes variables of an authorized request
+    /// to the environment of the application processing it.
+    /// \param name
+    /// \param value
+    ///
+    void setVariable(std::string_view name, std::string_view value);
+
+    ///
+    /// \brief setHeader
+    /// Adds a response header, for example "WWW-Authenticate" for a denied request.
+    /// \param name
+    /// \param value
+    ///
+    void setHeader(std::string_view name, std::string_view value);
+
+    ///
+    /// \brief isCancelled
+    /// \return true if the request is aborted by the web server or its connection is closed
+    ///
+    bool isCancelled() const;
+
+    ///
+    /// \brief setCancellationHandler
+    /// Registers a function called when the request is cancelled, see fcgi::Response::setCancellationHandler
+    /// \param handler
+    ///
+    void setCancellationHandler(std::function<void()> handler);
+
+    ///
+    /// \brief send
+    /// Sends the response during the first call only,
+    /// the next calls of this method do nothing.
+    ///
+    void send();
+
+    ///
+    /// \brief isValid
+    /// \return check whether the response is valid and can be sent
+    ///
+    bool isValid() const;
+
+    ///
+    /// \brief operator bool()
+    /// \return check whether the response is valid and can be sent
+    ///
+    operator bool() const;
+
+private:
+    int status_ = 403;
+    std::string headers_;
+    ResponseSender sender_;
+    std::shared_ptr<CancellationToken> cancellationToken_;
+};
+
+} //namespace fcgi
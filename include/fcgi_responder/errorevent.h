@@ -0,0 +1,121 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace fcgi {
+
+enum class ErrorCode {
+    // received record isn't expected in the current state, requestId and recordType are set
+    UnexpectedRecord,
+    // received record has an invalid type, recordType and detail are set to its value
+    InvalidRecordType,
+    // received record has an unsupported protocol version, detail is set to its value
+    UnsupportedVersion,
+    // content of the received record can't be read, description is set
+    MalformedRecord,
+    // received data can't be read, description is set
+    InvalidRecord,
+    // record can't be serialized, requestId, recordType and description are set
+    RecordSerializationError,
+    // request parameters or data exceed the size limit, requestId is set
+    RequestDataSizeExceeded,
+    // response data can't be read from a file, detail is set to the file descriptor
+    FileReadError,
+    // request waiting for the connection initialization is cancelled
+    ConnectionInitializationCancelled,
+    // request can't be sent as the maximum requests number is reached
+    MaximumRequestsNumberReached,
+    // FCGI_MAX_REQS value received from the application is invalid, description is set to the value
+    InvalidMaxReqsValue,
+    // FCGI_MPXS_CONNS value received from the application is invalid, description is set to the value
+    InvalidMpxsConnsValue,
+    // FCGI_UNKNOWN_TYPE record is received, requestId is set, detail is set to the unknown type value
+    UnknownTypeReceived,
+    // request isn't received, processed or responded to within the configured timeout, requestId is set
+    RequestTimeout
+};
+constexpr auto errorCodesNumber = std::size_t{14};
+
+///
+/// \brief Information about a protocol or stream error, passed to the handler registered with
+/// Responder::setErrorEventHandler or Requester::setErrorEventHandler.
+/// The description refers to data that is valid only during the handler call.
+///
+struct ErrorEvent {
+    ErrorEvent(
+            ErrorCode code = ErrorCode::InvalidRecord,
+            std::uint16_t requestId = 0,
+            std::uint8_t recordType = 0,
+            std::uint64_t detail = 0,
+            std::string_view description = {})
+        : code{code}
+        , requestId{requestId}
+        , recordType{recordType}
+        , detail{detail}
+        , description{description}
+    {
+    }
+
+    ErrorCode code;
+    std::uint16_t requestId;
+    std::uint8_t recordType;
+    std::uint64_t detail;
+    std::string_view description;
+};
+
+///
+/// \brief toString
+/// \param event
+/// \return text of the error, the same as passed to the error info handler
+///
+std::string toString(const ErrorEvent& event);
+
+///
+/// \brief Error event handler passing to the wrapped handler only the first event of each error code
+/// within an interval. Repeated events are counted, and their number is passed along with the next
+/// reported event of the same code, or by calling flush().
+/// It isn't thread-safe, so each connection should use its own instance.
+///
+class ErrorEventAggregator {
+public:
+    ///
+    /// \brief Constructor
+    /// \param handler function receiving the reported event and the number of events suppressed before it
+    /// \param interval minimal time between the reported events of the same code
+    ///
+    explicit ErrorEventAggregator(
+            std::function<void(const ErrorEvent& event, std::uint64_t suppressedEventsNumber)> handler,
+            std::chrono::steady_clock::duration interval = std::chrono::seconds{1});
+
+    ///
+    /// \brief operator()
+    /// Handles an error event, it can be registered as the error event handler
+    /// \param event
+    ///
+    void operator()(const ErrorEvent& event);
+
+    ///
+    /// \brief flush
+    /// Passes to the handler the last suppressed event of each code with the number of suppressed events.
+    /// The description of these events is empty.
+    ///
+    void flush();
+
+private:
+    struct CodeState {
+        std::chrono::steady_clock::time_point lastReportTime;
+        bool isReported = false;
+        std::uint64_t suppressedEventsNumber = 0;
+        ErrorEvent lastSuppressedEvent;
+    };
+
+    std::function<void(const ErrorEvent&, std::uint64_t)> handler_;
+    std::chrono::steady_clock::duration interval_;
+    std::array<CodeState, errorCodesNumber> codeStates_;
+};
+
+} //namespace fcgi
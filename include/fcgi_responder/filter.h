@@ -0,0 +1,35 @@
+#pragma once
+#include "filterstreams.h"
+#include "responder.h"
+
+namespace fcgi {
+
+///
+/// \brief Abstract class which implements message flow of the FastCGI protocol's
+/// Filter role between application and web server.
+/// It accepts only the requests with the Filter role and passes them to processFilterRequest
+/// as soon as their parameters are received. The request data and the filtered file are passed
+/// to the returned handlers as they arrive, and the output can be sent before they're received completely.
+/// The settings and the transport methods are the same as in fcgi::Responder, the size limits
+/// of the request data aren't applied, as it isn't buffered.
+///
+class Filter : public Responder {
+protected:
+    Filter();
+
+    ///
+    /// \brief processFilterRequest
+    /// Implement this method to start processing of a filter request
+    /// and keep the fcgi::FilterOutput object to send the output
+    /// \param request - HTTP request parameters, including FCGI_DATA_LENGTH and FCGI_DATA_LAST_MOD
+    /// \param output
+    /// \return handlers of the request data and the filtered file streams
+    ///
+    virtual FilterInput processFilterRequest(Request&& request, FilterOutput&& output) = 0;
+
+private:
+    // requests are passed to processFilterRequest instead
+    void processRequest(Request&& request, Response&& response) final;
+};
+
+} //namespace fcgi
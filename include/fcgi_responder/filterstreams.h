@@ -0,0 +1,91 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string_view>
+
+namespace fcgi {
+class CancellationToken;
+
+///
+/// \brief Handlers of the data streams of a filter request, returned by fcgi::Filter::processFilterRequest.
+/// The streams are passed in chunks as their records are received, without buffering,
+/// an empty chunk marks the end of the stream. The web server sends the filtered file after the request data.
+///
+struct FilterInput {
+    // receives the HTTP request data (FCGI_STDIN stream)
+    std::function<void(std::string_view data)> onStdIn;
+    // receives the filtered file (FCGI_DATA stream)
+    std::function<void(std::string_view data)> onData;
+};
+
+///
+/// \brief Move-only object used to stream the filter output from the application.
+/// Written data is sent right away, the request is finished by calling end().
+///
+class FilterOutput {
+    using OutputSender = std::function<void(std::string_view data, std::string_view errorData, bool isEnd)>;
+
+public:
+    ///
+    /// \brief Constructor
+    /// \param sender - a function sending the output and error data, and finishing the request if isEnd is true
+    /// \param cancellationToken - state of the request, set by fcgi::Filter
+    ///
+    explicit FilterOutput(OutputSender sender, std::shared_ptr<CancellationToken> cancellationToken = {});
+    FilterOutput(FilterOutput&&) = default;
+    FilterOutput& operator=(FilterOutput&&) = default;
+    FilterOutput(const FilterOutput&) = delete;
+    FilterOutput& operator=(const FilterOutput&) = delete;
+
+    ///
+    /// \brief write
+    /// Sends HTTP response data, empty data is ignored
+    /// \param data
+    ///
+    void write(std::string_view data);
+
+    ///
+    /// \brief writeError
+    /// Sends error information, empty data is ignored
+    /// \param errorData
+    ///
+    void writeError(std::string_view errorData);
+
+    ///
+    /// \brief end
+    /// Finishes the output and the request during the first call only, the next calls of this method
+    /// and writes after it do nothing. Unreceived data of the request's input streams is discarded.
+    ///
+    void end();
+
+    ///
+    /// \brief isCancelled
+    /// \return true if the request is aborted by the web server or its connection is closed
+    ///
+    bool isCancelled() const;
+
+    ///
+    /// \brief setCancellationHandler
+    /// Registers a function called when the request is cancelled, see fcgi::Response::setCancellationHandler
+    /// \param handler
+    ///
+    void setCancellationHandler(std::function<void()> handler);
+
+    ///
+    /// \brief isValid
+    /// \return check whether the output isn't finished and can be written
+    ///
+    bool isValid() const;
+
+    ///
+    /// \brief operator bool()
+    /// \return check whether the output isn't finished and can be written
+    ///
+    operator bool() const;
+
+private:
+    OutputSender sender_;
+    std::shared_ptr<CancellationToken> cancellationToken_;
+};
+
+} //namespace fcgi
@@ -0,0 +1,92 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+namespace fcgi {
+class ConnectionMetricsCounters;
+class ConnectionMetrics;
+
+///
+/// \brief Values of the Metrics counters at the moment of taking the snapshot.
+/// Record counters are indexed by the FastCGI record type value (FCGI_BEGIN_REQUEST = 1 ... FCGI_UNKNOWN_TYPE = 11),
+/// counters of the ended requests are indexed by the FastCGI protocol status value
+/// (FCGI_REQUEST_COMPLETE = 0, FCGI_CANT_MPX_CONN = 1, FCGI_OVERLOADED = 2, FCGI_UNKNOWN_ROLE = 3),
+/// counters of the decode errors are indexed by the MetricsSnapshot::DecodeError value.
+///
+struct MetricsSnapshot {
+    enum class DecodeError {
+        UnsupportedVersion,
+        InvalidRecordType,
+        MalformedRecord,
+        UnexpectedRecord,
+        Other
+    };
+    static constexpr auto recordTypesNumber = std::size_t{12};
+    static constexpr auto protocolStatusesNumber = std::size_t{4};
+    static constexpr auto decodeErrorsNumber = std::size_t{5};
+
+    std::array<std::uint64_t, recordTypesNumber> receivedRecords{};
+    std::array<std::uint64_t, recordTypesNumber> sentRecords{};
+    std::uint64_t receivedBytes = 0;
+    std::uint64_t sentBytes = 0;
+    // requests accepted by Responders or sent by Requesters
+    std::uint64_t startedRequests = 0;
+    // requests aborted by the web server or cancelled by Requesters
+    std::uint64_t abortedRequests = 0;
+    // requests completed or rejected with the FCGI_END_REQUEST record
+    std::array<std::uint64_t, protocolStatusesNumber> endedRequests{};
+    std::array<std::uint64_t, decodeErrorsNumber> decodeErrors{};
+
+    std::uint64_t connections = 0;
+    std::uint64_t activeRequests = 0;
+    // size of the received request data and queued output of Responders, or of the received response data of Requesters
+    std::uint64_t bufferedBytes = 0;
+};
+
+///
+/// \brief Object collecting the protocol counters of the Responder and Requester instances sharing it,
+/// set with Responder::setMetrics, ResponderGroup::setMetrics or Requester::setMetrics.
+/// Each connection updates its own counters without locking, they are aggregated only when a snapshot is taken.
+/// Counters of the detached connections are kept in the totals, the connection gauges are dropped.
+/// Connections without a Metrics object don't collect anything.
+/// All methods are thread-safe.
+///
+class Metrics {
+public:
+    Metrics();
+    ~Metrics();
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    ///
+    /// \brief snapshot
+    /// \return sum of the counters of all attached and detached connections
+    ///
+    MetricsSnapshot snapshot() const;
+
+private:
+    void attachConnection(const ConnectionMetricsCounters* counters);
+    void detachConnection(const ConnectionMetricsCounters* counters);
+    friend class ConnectionMetrics;
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_set<const ConnectionMetricsCounters*> connections_;
+    MetricsSnapshot detachedConnectionsTotals_;
+};
+
+///
+/// \brief toPrometheusText
+/// Formats the snapshot in the Prometheus text exposition format
+/// \param snapshot
+/// \param prefix prefix of the metric names
+/// \return text of the metrics exposition
+///
+std::string toPrometheusText(const MetricsSnapshot& snapshot, const std::string& prefix = "fcgi");
+
+} //namespace fcgi
@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+
+namespace fcgi {
+
+///
+/// \brief Object tracking the load of the Responder instances sharing it,
+/// and adapting the maximum number of concurrently processed requests.
+/// The requests limit is adjusted with the AIMD algorithm:
+/// it's increased by one after a batch of requests processed within the target latency,
+/// and is decreased multiplicatively when the processing latency exceeds the target.
+/// The limit is advertised to the web server as the FCGI_MAX_REQS value, and requests
+/// exceeding it are rejected with the overloaded status.
+///
+class OverloadControl {
+public:
+    ///
+    /// \brief Constructor
+    /// \param latencyTarget maximum desired time between passing a request to the processRequest method
+    /// and sending its response
+    /// \param minRequestsLimit minimal value of the requests limit
+    /// \param maxRequestsLimit maximal and initial value of the requests limit
+    ///
+    explicit OverloadControl(
+            std::chrono::microseconds latencyTarget,
+            int minRequestsLimit = 1,
+            int maxRequestsLimit = 1000);
+
+    ///
+    /// \brief setDecreaseFactor
+    /// Sets a multiplier applied to the requests limit when the latency target is exceeded
+    /// \param factor value in the range (0, 1)
+    ///
+    void setDecreaseFactor(double factor);
+
+    ///
+    /// \brief setMaximumOutputQueueSize
+    /// Sets a maximum total size of the output queues of all connections,
+    /// upon reaching which incoming requests are rejected
+    /// \param size
+    ///
+    void setMaximumOutputQueueSize(std::size_t size);
+
+    ///
+    /// \brief requestsLimit
+    /// \return current maximum number of concurrently processed requests
+    ///
+    int requestsLimit() const;
+
+    ///
+    /// \brief activeRequestsNumber
+    /// \return number of requests that are being processed
+    ///
+    int activeRequestsNumber() const;
+
+    ///
+    /// \brief outputQueueSize
+    /// \return total size of the output queues of all connections
+    ///
+    std::size_t outputQueueSize() const;
+
+    ///
+    /// \brief lastLatency
+    /// \return processing latency of the last completed request
+    ///
+    std::chrono::microseconds lastLatency() const;
+
+    ///
+    /// \brief tryAcquireRequest
+    /// Registers a new request if the requests limit and output queue size limit aren't reached
+    /// \return true if request was registered
+    ///
+    bool tryAcquireRequest();
+
+    ///
+    /// \brief acquireRequest
+    /// Registers a request regardless of the limits, it's used for the requests already being processed
+    /// by a Responder switching to this object from another one
+    ///
+    void acquireRequest();
+
+    ///
+    /// \brief releaseRequest
+    /// Unregisters a request acquired with tryAcquireRequest
+    ///
+    void releaseRequest();
+
+    ///
+    /// \brief addLatencySample
+    /// Adjusts the requests limit according to the processing latency of a completed request
+    /// \param latency
+    ///
+    void addLatencySample(std::chrono::microseconds latency);
+
+    ///
+    /// \brief updateOutputQueueSize
+    /// Adds the change of a connection's output queue size to the total size
+    /// \param previousSize
+    /// \param size
+    ///
+    void updateOutputQueueSize(std::size_t previousSize, std::size_t size);
+
+private:
+    const std::chrono::microseconds latencyTarget_;
+    const double minRequestsLimit_;
+    const double maxRequestsLimit_;
+    double decreaseFactor_ = 0.7;
+    double requestsLimit_;
+    int activeRequestsNumber_ = 0;
+    int samplesUntilNextDecrease_ = 0;
+    std::chrono::microseconds lastLatency_{};
+    mutable std::mutex mutex_;
+    std::atomic<std::size_t> outputQueueSize_{0};
+    std::atomic<std::size_t> maxOutputQueueSize_{std::numeric_limits<std::size_t>::max()};
+};
+
+} //namespace fcgi
@@ -1,12 +1,19 @@
 #pragma once
+#include "errorevent.h"
+#include "requestparams.h"
+#include <chrono>
 #include <functional>
 #include <map>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 
 namespace fcgi {
 class RequesterImpl;
+class Metrics;
+class TimerWheel;
+class RequestDataStream;
 
 class RequestHandle {
 public:
@@ -17,11 +24,91 @@ private:
     std::weak_ptr<std::function<void()>> cancelRequestHandler_;
 };
 
+///
+/// \brief Object used to stream the data of a request started with fcgi::Requester::startRequest.
+/// Written data is sent to the FastCGI application right away, the data stream is finished by calling end().
+/// The writer becomes invalid when the request is ended, cancelled or timed out.
+///
+class RequestDataWriter {
+public:
+    ///
+    /// \brief Constructor
+    /// \param stream - state of the request data stream, owned by fcgi::Requester
+    /// \param requestHandle - handle used to cancel the request
+    ///
+    RequestDataWriter(std::weak_ptr<RequestDataStream> stream, RequestHandle requestHandle);
+
+    ///
+    /// \brief write
+    /// Sends request data, empty data is ignored.
+    /// Data written before the connection with the FastCGI application is initialized is buffered.
+    /// \param data
+    ///
+    void write(std::string_view data);
+
+    ///
+    /// \brief end
+    /// Finishes the request data stream, the next writes do nothing
+    ///
+    void end();
+
+    ///
+    /// \brief isWritable
+    /// Large data should be written in chunks while this method returns true,
+    /// and resumed by the writable handler, so it doesn't pile up in the transport's output queue.
+    /// \return true if the request is sent and the transport can accept more data
+    ///
+    bool isWritable() const;
+
+    ///
+    /// \brief setWritableHandler
+    /// Registers a function called when the request is sent to the FastCGI application,
+    /// and each time the Requester's transport becomes writable, until the data stream is finished.
+    /// \param handler
+    ///
+    void setWritableHandler(std::function<void()> handler);
+
+    ///
+    /// \brief cancelRequest
+    /// Cancels the request, the response handler is called with an empty value
+    ///
+    void cancelRequest();
+
+    ///
+    /// \brief isValid
+    /// \return check whether the data stream isn't finished and can be written
+    ///
+    bool isValid() const;
+
+    ///
+    /// \brief operator bool()
+    /// \return check whether the data stream isn't finished and can be written
+    ///
+    operator bool() const;
+
+private:
+    std::weak_ptr<RequestDataStream> stream_;
+    RequestHandle requestHandle_;
+};
+
 struct ResponseData {
     std::string data;
     std::string errorMsg;
 };
 
+///
+/// \brief Handlers receiving the response of a request as it arrives, without buffering it.
+/// Received data is valid only during the handler call.
+///
+struct ResponseStreamHandler {
+    // called for each received chunk of the response data
+    std::function<void(std::string_view data)> onData;
+    // called for each received chunk of the response error stream
+    std::function<void(std::string_view errorMsg)> onErrorMsg;
+    // called when the response is ended, isComplete is false if the request failed, was cancelled or timed out
+    std::function<void(bool isComplete)> onEnd;
+};
+
 ///
 /// \brief Abstract class which implements the client logic for making requests to FastCGI applications
 ///
@@ -42,6 +129,82 @@ public:
             std::string data,
             const std::function<void(std::optional<ResponseData>)>& responseHandler,
             bool keepConnection = false);
+
+    ///
+    /// \brief sendRequest
+    /// Send request to the FastCGI application, receiving its response as a stream.
+    /// It's suited for proxying large responses, as the data is passed to the handlers without being buffered.
+    /// \param params request parameters
+    /// \param data request data
+    /// \param responseStreamHandler handlers of the response data chunks and of the response end
+    /// \param keepConnection true if FastCGI application should keep the connection alive after response is sent
+    /// \return RequestHandle - object which can be used to cancel request
+    ///
+    std::optional<RequestHandle> sendRequest(
+            std::map<std::string, std::string> params,
+            std::string data,
+            ResponseStreamHandler responseStreamHandler,
+            bool keepConnection = false);
+
+    ///
+    /// \brief sendPreparedRequest
+    /// Send request to the FastCGI application with the parameters encoded beforehand.
+    /// It's suited for the requests sharing the same parameters, which are copied straight into the sent records.
+    /// \param params encoded request parameters
+    /// \param data request data
+    /// \param responseHandler response handler
+    /// \param keepConnection true if FastCGI application should keep the connection alive after response is sent
+    /// \return RequestHandle - object which can be used to cancel request
+    ///
+    std::optional<RequestHandle> sendPreparedRequest(
+            const RequestParams& params,
+            std::string data,
+            const std::function<void(std::optional<ResponseData>)>& responseHandler,
+            bool keepConnection = false);
+
+    ///
+    /// \brief sendPreparedRequest
+    /// Send request to the FastCGI application with the parameters encoded beforehand,
+    /// receiving its response as a stream
+    /// \param params encoded request parameters
+    /// \param data request data
+    /// \param responseStreamHandler handlers of the response data chunks and of the response end
+    /// \param keepConnection true if FastCGI application should keep the connection alive after response is sent
+    /// \return RequestHandle - object which can be used to cancel request
+    ///
+    std::optional<RequestHandle> sendPreparedRequest(
+            const RequestParams& params,
+            std::string data,
+            ResponseStreamHandler responseStreamHandler,
+            bool keepConnection = false);
+
+    ///
+    /// \brief startRequest
+    /// Send request to the FastCGI application, whose data is streamed with the returned writer
+    /// instead of being passed as a whole, which allows uploading large request bodies.
+    /// \param params request parameters
+    /// \param responseHandler response handler
+    /// \param keepConnection true if FastCGI application should keep the connection alive after response is sent
+    /// \return RequestDataWriter - object used to send the request data and to cancel the request
+    ///
+    std::optional<RequestDataWriter> startRequest(
+            std::map<std::string, std::string> params,
+            const std::function<void(std::optional<ResponseData>)>& responseHandler,
+            bool keepConnection = false);
+
+    ///
+    /// \brief startRequest
+    /// Send request to the FastCGI application, streaming both its data and the response
+    /// \param params request parameters
+    /// \param responseStreamHandler handlers of the response data chunks and of the response end
+    /// \param keepConnection true if FastCGI application should keep the connection alive after response is sent
+    /// \return RequestDataWriter - object used to send the request data and to cancel the request
+    ///
+    std::optional<RequestDataWriter> startRequest(
+            std::map<std::string, std::string> params,
+            ResponseStreamHandler responseStreamHandler,
+            bool keepConnection = false);
+
     ///
     /// \brief setErrorInfoHandler
     /// Protocol and stream errors are handled internally and silently,
@@ -51,6 +214,61 @@ public:
     ///
     void setErrorInfoHandler(const std::function<void(const std::string&)>& handler);
 
+    ///
+    /// \brief setErrorEventHandler
+    /// Registers a handler receiving the structured information about the protocol and stream errors.
+    /// Unlike the error info handler, it doesn't require formatting the error text,
+    /// which can be done on demand with fcgi::toString.
+    /// \param handler
+    ///
+    void setErrorEventHandler(const std::function<void(const ErrorEvent&)>& handler);
+
+    ///
+    /// \brief setThreadLocalSerializationBufferEnabled
+    /// Enables or disables serialization of the FastCGI records in a buffer shared by all Requesters
+    /// of the current thread instead of the Requester's own buffer.
+    /// \param state
+    ///
+    void setThreadLocalSerializationBufferEnabled(bool state);
+
+    ///
+    /// \brief isThreadLocalSerializationBufferEnabled
+    /// \return true if the records are serialized in the buffer shared by the Requesters of the current thread
+    ///
+    bool isThreadLocalSerializationBufferEnabled() const;
+
+    ///
+    /// \brief setMetrics
+    /// Sets an object collecting the protocol counters of this Requester.
+    /// It can be shared by multiple Responder and Requester instances, which don't collect anything without it.
+    /// \param metrics
+    ///
+    void setMetrics(std::shared_ptr<Metrics> metrics);
+
+    ///
+    /// \brief setTimerWheel
+    /// Sets a timer wheel that drives the response timeout, it isn't checked without it.
+    /// The wheel can be shared with other connections of the same thread.
+    /// \param timerWheel
+    ///
+    void setTimerWheel(std::shared_ptr<TimerWheel> timerWheel);
+
+    ///
+    /// \brief setResponseTimeout
+    /// Sets a maximum time of waiting for the response of a request, and for the reply of the FastCGI application
+    /// when the connection is initialized. On timeout the response handler is called with an empty value.
+    /// The request is aborted if the connection is kept alive, otherwise the connection is closed.
+    /// Zero value disables the timeout.
+    /// \param timeout
+    ///
+    void setResponseTimeout(std::chrono::milliseconds timeout);
+
+    ///
+    /// \brief responseTimeout
+    /// \return Maximum time of waiting for a response, zero if it isn't limited
+    ///
+    std::chrono::milliseconds responseTimeout() const;
+
     ///
     /// \brief availableRequestsNumber
     /// \return number of available requests
@@ -84,9 +302,26 @@ protected:
     Requester& operator=(Requester&&) = default;
 
     void receiveData(const char* data, std::size_t size);
+
+    ///
+    /// \brief onWritable
+    /// Call this method when the connection with the FastCGI application becomes writable again
+    /// to notify the writers of the streamed request data
+    ///
+    void onWritable();
+
     virtual void sendData(const std::string& data) = 0;
     virtual void disconnect() = 0;
 
+    ///
+    /// \brief isWritable
+    /// Override this method to report that the transport's output queue is full,
+    /// so the writers of the streamed request data wait for a call of onWritable.
+    /// Default implementation always returns true.
+    /// \return true if the transport can accept more data
+    ///
+    virtual bool isWritable() const;
+
 private:
     RequesterImpl& impl();
     const RequesterImpl& impl() const;
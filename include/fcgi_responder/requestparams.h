@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace fcgi {
+
+///
+/// \brief Request parameters encoded in the FastCGI name-value format once, when they're added.
+/// Passed to fcgi::Requester::sendPreparedRequest, the encoded block is copied straight into the PARAMS records,
+/// so the same parameters can be reused by many requests without being encoded again.
+/// Names aren't checked for duplicates, each added parameter is sent.
+///
+class RequestParams {
+public:
+    RequestParams() = default;
+
+    ///
+    /// \brief Constructor
+    /// \param params - names and values of the parameters
+    ///
+    RequestParams(std::initializer_list<std::pair<std::string_view, std::string_view>> params);
+
+    ///
+    /// \brief Constructor
+    /// Adds the parameters of a range of name and value pairs, for example of std::map<std::string, std::string>
+    /// or of std::vector<std::pair<std::string_view, std::string_view>>
+    /// \param first
+    /// \param last
+    ///
+    template<typename TIterator>
+    RequestParams(TIterator first, TIterator last)
+    {
+        for (; first != last; ++first)
+            add(first->first, first->second);
+    }
+
+    ///
+    /// \brief add
+    /// Encodes the parameter and appends it to the block
+    /// \param name
+    /// \param value
+    ///
+    void add(std::string_view name, std::string_view value);
+
+    ///
+    /// \brief clear
+    /// Removes all parameters, keeping the allocated memory for reuse
+    ///
+    void clear();
+
+    ///
+    /// \brief isEmpty
+    /// \return true if no parameters are added
+    ///
+    bool isEmpty() const;
+
+    ///
+    /// \brief data
+    /// \return the parameters in the FastCGI name-value format
+    ///
+    std::string_view data() const;
+
+private:
+    std::string data_;
+};
+
+} //namespace fcgi
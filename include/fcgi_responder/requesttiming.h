@@ -0,0 +1,30 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+namespace fcgi {
+
+///
+/// \brief Time points of the lifecycle of a request processed by the Responder.
+/// Timing records are reported only if the library is built with the ENABLE_REQUEST_TIMING option
+/// (FCGI_RESPONDER_REQUEST_TIMING definition), otherwise their collection is compiled out.
+///
+struct RequestTiming {
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    std::uint16_t requestId = 0;
+    // FCGI_BEGIN_REQUEST record is received
+    TimePoint beginRequestReceived;
+    // the terminating FCGI_PARAMS record is received
+    TimePoint paramsReceived;
+    // the terminating FCGI_STDIN record is received
+    TimePoint stdInReceived;
+    // Responder::processRequest is invoked
+    TimePoint processingStarted;
+    // Response::send is called
+    TimePoint responseSent;
+    // the last record of the response is passed to Responder::sendData or Responder::trySendData
+    TimePoint outputWritten;
+};
+
+} //namespace fcgi
@@ -1,11 +1,19 @@
 #pragma once
+#include "errorevent.h"
 #include "request.h"
+#include "requesttiming.h"
 #include "response.h"
+#include <chrono>
+#include <functional>
 #include <memory>
 
 namespace fcgi{
 
 class ResponderImpl;
+class OverloadControl;
+class ResponderGroup;
+class Metrics;
+class TimerWheel;
 
 ///
 /// \brief Abstract class which implements message flow of the FastCGI protocol's
@@ -38,6 +46,123 @@ public:
     ///
     void setMultiplexingEnabled(bool state);
 
+    ///
+    /// \brief setOutputHighWaterMark
+    /// Sets a size of the output queue, upon reaching which incoming requests are rejected as overloaded.
+    /// The output queue stores the response data that wasn't accepted by trySendData or trySendFileData.
+    /// \param size
+    ///
+    void setOutputHighWaterMark(std::size_t size);
+
+    ///
+    /// \brief setMaximumRequestParamsSize
+    /// Sets a maximum size of the request parameters.
+    /// Requests exceeding this limit are ended with the overloaded status.
+    /// \param size
+    ///
+    void setMaximumRequestParamsSize(std::size_t size);
+
+    ///
+    /// \brief setMaximumRequestDataSize
+    /// Sets a maximum size of the request data.
+    /// Requests exceeding this limit are ended with the overloaded status.
+    /// \param size
+    ///
+    void setMaximumRequestDataSize(std::size_t size);
+
+    ///
+    /// \brief setMaximumConnectionBufferSize
+    /// Sets a maximum size of the parameters and data of all requests being received on the connection.
+    /// Requests, which data exceeds this limit, are ended with the overloaded status.
+    /// \param size
+    ///
+    void setMaximumConnectionBufferSize(std::size_t size);
+
+    ///
+    /// \brief setThreadLocalSerializationBufferEnabled
+    /// Enables or disables serialization of the FastCGI records in a buffer shared by all Responders
+    /// of the current thread instead of the Responder's own buffer, which otherwise keeps the size of
+    /// the largest sent record for the lifetime of the connection.
+    /// \param state
+    ///
+    void setThreadLocalSerializationBufferEnabled(bool state);
+
+    ///
+    /// \brief setOverloadControl
+    /// Sets an object that limits the number of concurrently processed requests
+    /// according to their processing latency. It can be shared by multiple Responder instances,
+    /// and should be set before receiving the requests.
+    /// \param overloadControl
+    ///
+    void setOverloadControl(std::shared_ptr<OverloadControl> overloadControl);
+
+    ///
+    /// \brief setResponderGroup
+    /// Joins the group shared by the Responders of all connections:
+    /// the group's settings and overload control are applied to this Responder,
+    /// the group's maximum connections number is advertised as FCGI_MAX_CONNS value,
+    /// and the requests of this Responder are counted in the group's counters.
+    /// Other settings can be changed individually after joining the group.
+    /// Acquiring a connection slot with ResponderGroup::tryAcquireConnection is up to the transport.
+    /// \param responderGroup
+    ///
+    void setResponderGroup(std::shared_ptr<ResponderGroup> responderGroup);
+
+    ///
+    /// \brief setMetrics
+    /// Sets an object collecting the protocol counters of this Responder.
+    /// It can be shared by multiple Responder and Requester instances, which don't collect anything without it.
+    /// \param metrics
+    ///
+    void setMetrics(std::shared_ptr<Metrics> metrics);
+
+    ///
+    /// \brief setTimerWheel
+    /// Sets a timer wheel that drives the request and idle connection timeouts.
+    /// The timeouts aren't checked without it. The wheel can be shared by the Responders
+    /// and Requesters of the same thread, its tick() must be called by that thread.
+    /// \param timerWheel
+    ///
+    void setTimerWheel(std::shared_ptr<TimerWheel> timerWheel);
+
+    ///
+    /// \brief setRequestReceiveTimeout
+    /// Sets a maximum time between receiving the beginning of a request and receiving all of its parameters
+    /// and data. Requests exceeding it are ended, and the rest of their data is ignored.
+    /// Zero value disables the timeout.
+    /// \param timeout
+    ///
+    void setRequestReceiveTimeout(std::chrono::milliseconds timeout);
+
+    ///
+    /// \brief setRequestProcessingTimeout
+    /// Sets a maximum time of the request processing, starting from the call of processRequest.
+    /// Requests exceeding it are ended and their Response objects are cancelled.
+    /// Zero value disables the timeout.
+    /// \param timeout
+    ///
+    void setRequestProcessingTimeout(std::chrono::milliseconds timeout);
+
+    ///
+    /// \brief setIdleConnectionTimeout
+    /// Sets a maximum time the connection can stay open without any requests in progress,
+    /// after which it's closed with disconnect(). Zero value disables the timeout.
+    /// \param timeout
+    ///
+    void setIdleConnectionTimeout(std::chrono::milliseconds timeout);
+
+#ifdef FCGI_RESPONDER_REQUEST_TIMING
+    ///
+    /// \brief setRequestTimingHandler
+    /// Registers a handler receiving the lifecycle time points of each request,
+    /// after the last record of its response is passed to the transport.
+    /// Aborted requests aren't reported.
+    /// Available only if the library is built with the ENABLE_REQUEST_TIMING option.
+    /// \param handler
+    ///
+    void setRequestTimingHandler(std::function<void(const RequestTiming&)> handler);
+#endif
+
     ///
     /// \brief maximumConnectionsNumber
     /// \return Maximum connections number
@@ -56,6 +181,73 @@ public:
     ///
     bool isMultiplexingEnabled() const;
 
+    ///
+    /// \brief outputHighWaterMark
+    /// \return Output queue size limit
+    ///
+    std::size_t outputHighWaterMark() const;
+
+    ///
+    /// \brief outputQueueSize
+    /// \return Size of the response data waiting to be sent
+    ///
+    std::size_t outputQueueSize() const;
+
+    ///
+    /// \brief isOutputQueueFull
+    /// Non-blocking transports should stop reading the incoming data while the output queue is full.
+    /// \return true if the output queue size reached the high-water mark
+    ///
+    bool isOutputQueueFull() const;
+
+    ///
+    /// \brief maximumRequestParamsSize
+    /// \return Maximum request parameters size
+    ///
+    std::size_t maximumRequestParamsSize() const;
+
+    ///
+    /// \brief maximumRequestDataSize
+    /// \return Maximum request data size
+    ///
+    std::size_t maximumRequestDataSize() const;
+
+    ///
+    /// \brief maximumConnectionBufferSize
+    /// \return Maximum size of the received requests data on the connection
+    ///
+    std::size_t maximumConnectionBufferSize() const;
+
+    ///
+    /// \brief isThreadLocalSerializationBufferEnabled
+    /// \return true if the records are serialized in the buffer shared by the Responders of the current thread
+    ///
+    bool isThreadLocalSerializationBufferEnabled() const;
+
+    ///
+    /// \brief bufferedRequestDataSize
+    /// \return Size of the parameters and data of the requests that are being received on the connection
+    ///
+    std::size_t bufferedRequestDataSize() const;
+
+    ///
+    /// \brief requestReceiveTimeout
+    /// \return Maximum time of receiving a request, zero if it isn't limited
+    ///
+    std::chrono::milliseconds requestReceiveTimeout() const;
+
+    ///
+    /// \brief requestProcessingTimeout
+    /// \return Maximum time of processing a request, zero if it isn't limited
+    ///
+    std::chrono::milliseconds requestProcessingTimeout() const;
+
+    ///
+    /// \brief idleConnectionTimeout
+    /// \return Maximum time of keeping an idle connection open, zero if it isn't limited
+    ///
+    std::chrono::milliseconds idleConnectionTimeout() const;
+
     ///
     /// \brief setErrorInfoHandler
     /// Protocol and stream errors are handled internally and silently,
@@ -65,6 +257,15 @@ public:
     ///
     void setErrorInfoHandler(std::function<void(const std::string&)> errorInfoHandler);
 
+    ///
+    /// \brief setErrorEventHandler
+    /// Registers a handler receiving the structured information about the protocol and stream errors.
+    /// Unlike the error info handler, it doesn't require formatting the error text,
+    /// which can be done on demand with fcgi::toString.
+    /// \param errorEventHandler
+    ///
+    void setErrorEventHandler(std::function<void(const ErrorEvent&)> errorEventHandler);
+
     Responder(const Responder&) = delete;
     Responder& operator=(const Responder&) = delete;
 
@@ -82,6 +283,23 @@ protected:
     ///
     void receiveData(const char* data, std::size_t size);
 
+    ///
+    /// \brief onWritable
+    /// Call this method when the connection with the web server becomes writable again
+    /// to resume sending the queued response data
+    ///
+    void onWritable();
+
+    ///
+    /// \brief reset
+    /// Prepares the Responder for serving a new connection, so it can be reused from a pool
+    /// without reallocating its buffers. Received and queued data and the state of unfinished requests
+    /// are discarded, the settings are kept. Responses of the requests received before the reset are
+    /// never sent to the new connection: sending them has no effect.
+    /// The Responder isn't counted in the connections of its Metrics object until it receives data again.
+    ///
+    void reset();
+
     ///
     /// \brief sendData
     /// Implement this method to send response data to the web server
@@ -89,6 +307,37 @@ protected:
     ///
     virtual void sendData(const std::string& data) = 0;
 
+    ///
+    /// \brief sendFileData
+    /// Override this method to send a file region set with fcgi::Response::setFileData
+    /// to the web server directly, for example with sendfile().
+    /// It's called between the data of FastCGI record headers passed to sendData,
+    /// the region size never exceeds the maximum FastCGI record content length.
+    /// Default implementation reads the file region and passes it to sendData.
+    /// \param fileRegion
+    ///
+    virtual void sendFileData(const FileRegion& fileRegion);
+
+    ///
+    /// \brief trySendData
+    /// Override this method to send response data to the web server without blocking.
+    /// The data that wasn't accepted is queued and passed to this method again after a call of onWritable.
+    /// Default implementation passes all data to sendData.
+    /// \param data
+    /// \return number of sent bytes
+    ///
+    virtual std::size_t trySendData(const std::string& data);
+
+    ///
+    /// \brief trySendFileData
+    /// Override this method to send a file region to the web server without blocking.
+    /// The file region part that wasn't accepted is queued and passed to this method again after a call of onWritable.
+    /// Default implementation passes the file region to sendFileData.
+    /// \param fileRegion
+    /// \return number of sent bytes
+    ///
+    virtual std::size_t trySendFileData(const FileRegion& fileRegion);
+
     ///
     /// \brief disconnect
     /// Implement this method to close the current connection with the web server
@@ -107,6 +356,8 @@ protected:
 private:
     ResponderImpl& impl();
     const ResponderImpl& impl() const;
+    friend class Authorizer;
+    friend class Filter;
 
 private:
     std::unique_ptr<ResponderImpl> impl_;
@@ -0,0 +1,225 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+namespace fcgi {
+class OverloadControl;
+class Metrics;
+class ResponderImpl;
+
+///
+/// \brief Object shared by the Responder instances of all connections of an application.
+/// It stores the settings applied to each Responder joining the group with Responder::setResponderGroup
+/// (changes of the settings affect only the Responders joining afterwards),
+/// enforces the maximum connections number, and counts the connections and requests of the group.
+/// Transports should call tryAcquireConnection() right after accepting a connection,
+/// and close it without creating a Responder if the limit is reached.
+/// All methods are thread-safe.
+///
+class ResponderGroup {
+public:
+    ///
+    /// \brief Constructor
+    /// \param maxConnectionsNumber maximum number of connections, advertised to the web server as FCGI_MAX_CONNS value
+    ///
+    explicit ResponderGroup(int maxConnectionsNumber = std::numeric_limits<int>::max());
+
+    ///
+    /// \brief tryAcquireConnection
+    /// Registers a new connection if the connections limit isn't reached
+    /// \return true if connection was registered, false if it should be closed
+    ///
+    bool tryAcquireConnection();
+
+    ///
+    /// \brief releaseConnection
+    /// Unregisters a connection acquired with tryAcquireConnection
+    ///
+    void releaseConnection();
+
+    ///
+    /// \brief setMaximumConnectionsNumber
+    /// Sets a maximum connections number. Connections acquired before reducing the limit aren't closed.
+    /// \param value
+    ///
+    void setMaximumConnectionsNumber(int value);
+
+    ///
+    /// \brief setMaximumRequestsNumber
+    /// Sets a maximum requests number of each connection.
+    /// \param value
+    ///
+    void setMaximumRequestsNumber(int value);
+
+    ///
+    /// \brief setMultiplexingEnabled
+    /// Enables or disables multiplexing of requests on each connection.
+    /// \param state
+    ///
+    void setMultiplexingEnabled(bool state);
+
+    ///
+    /// \brief setOutputHighWaterMark
+    /// Sets an output queue size limit of each connection.
+    /// \param size
+    ///
+    void setOutputHighWaterMark(std::size_t size);
+
+    ///
+    /// \brief setMaximumRequestParamsSize
+    /// Sets a maximum size of the request parameters.
+    /// \param size
+    ///
+    void setMaximumRequestParamsSize(std::size_t size);
+
+    ///
+    /// \brief setMaximumRequestDataSize
+    /// Sets a maximum size of the request data.
+    /// \param size
+    ///
+    void setMaximumRequestDataSize(std::size_t size);
+
+    ///
+    /// \brief setMaximumConnectionBufferSize
+    /// Sets a maximum size of the parameters and data of all requests being received on each connection.
+    /// \param size
+    ///
+    void setMaximumConnectionBufferSize(std::size_t size);
+
+    ///
+    /// \brief setThreadLocalSerializationBufferEnabled
+    /// Enables or disables serialization of the FastCGI records of each connection
+    /// in a buffer shared by all Responders of the current thread.
+    /// \param state
+    ///
+    void setThreadLocalSerializationBufferEnabled(bool state);
+
+    ///
+    /// \brief setOverloadControl
+    /// Sets an overload control object shared by all Responders of the group.
+    /// \param overloadControl
+    ///
+    void setOverloadControl(std::shared_ptr<OverloadControl> overloadControl);
+
+    ///
+    /// \brief setMetrics
+    /// Sets a metrics object collecting the counters of all Responders of the group.
+    /// \param metrics
+    ///
+    void setMetrics(std::shared_ptr<Metrics> metrics);
+
+    ///
+    /// \brief maximumConnectionsNumber
+    /// \return Maximum connections number
+    ///
+    int maximumConnectionsNumber() const;
+
+    ///
+    /// \brief maximumRequestsNumber
+    /// \return Maximum requests number of each connection
+    ///
+    int maximumRequestsNumber() const;
+
+    ///
+    /// \brief isMultiplexingEnabled
+    /// \return Multiplexing state
+    ///
+    bool isMultiplexingEnabled() const;
+
+    ///
+    /// \brief outputHighWaterMark
+    /// \return Output queue size limit of each connection
+    ///
+    std::size_t outputHighWaterMark() const;
+
+    ///
+    /// \brief maximumRequestParamsSize
+    /// \return Maximum request parameters size
+    ///
+    std::size_t maximumRequestParamsSize() const;
+
+    ///
+    /// \brief maximumRequestDataSize
+    /// \return Maximum request data size
+    ///
+    std::size_t maximumRequestDataSize() const;
+
+    ///
+    /// \brief maximumConnectionBufferSize
+    /// \return Maximum size of the received requests data on each connection
+    ///
+    std::size_t maximumConnectionBufferSize() const;
+
+    ///
+    /// \brief isThreadLocalSerializationBufferEnabled
+    /// \return true if the records are serialized in the buffer shared by the Responders of the current thread
+    ///
+    bool isThreadLocalSerializationBufferEnabled() const;
+
+    ///
+    /// \brief overloadControl
+    /// \return Overload control object shared by the Responders of the group
+    ///
+    std::shared_ptr<OverloadControl> overloadControl() const;
+
+    ///
+    /// \brief metrics
+    /// \return Metrics object shared by the Responders of the group
+    ///
+    std::shared_ptr<Metrics> metrics() const;
+
+    ///
+    /// \brief connectionsNumber
+    /// \return number of acquired connections
+    ///
+    int connectionsNumber() const;
+
+    ///
+    /// \brief rejectedConnectionsNumber
+    /// \return number of connections that weren't acquired due to the connections limit
+    ///
+    std::uint64_t rejectedConnectionsNumber() const;
+
+    ///
+    /// \brief activeRequestsNumber
+    /// \return number of requests that are being received or processed by the Responders of the group
+    ///
+    int activeRequestsNumber() const;
+
+    ///
+    /// \brief processedRequestsNumber
+    /// \return number of requests completed by the Responders of the group
+    ///
+    std::uint64_t processedRequestsNumber() const;
+
+private:
+    void onRequestStarted();
+    void onRequestFinished();
+    void onRequestCompleted();
+    friend class ResponderImpl;
+
+private:
+    std::atomic<int> maxConnectionsNumber_;
+    std::atomic<int> maxRequestsNumber_{10};
+    std::atomic<bool> multiplexingEnabled_{true};
+    std::atomic<std::size_t> outputHighWaterMark_{1024 * 1024};
+    std::atomic<std::size_t> maxRequestParamsSize_{std::numeric_limits<std::size_t>::max()};
+    std::atomic<std::size_t> maxRequestDataSize_{std::numeric_limits<std::size_t>::max()};
+    std::atomic<std::size_t> maxConnectionBufferSize_{std::numeric_limits<std::size_t>::max()};
+    std::atomic<bool> threadLocalSerializationBufferEnabled_{false};
+    mutable std::mutex overloadControlMutex_;
+    std::shared_ptr<OverloadControl> overloadControl_;
+    mutable std::mutex metricsMutex_;
+    std::shared_ptr<Metrics> metrics_;
+
+    std::atomic<int> connectionsNumber_{0};
+    std::atomic<std::uint64_t> rejectedConnectionsNumber_{0};
+    std::atomic<int> activeRequestsNumber_{0};
+    std::atomic<std::uint64_t> processedRequestsNumber_{0};
+};
+
+} //namespace fcgi
@@ -1,21 +1,43 @@
 #pragma once
 #include <functional>
+#include <memory>
+#include <optional>
 #include <string>
 
 namespace fcgi {
+class CancellationToken;
+
+///
+/// \brief Region of an opened file which is used as HTTP response data
+///
+struct FileRegion {
+    int fileDescriptor = -1;
+    std::size_t offset = 0;
+    std::size_t size = 0;
+};
 
 ///
 /// \brief Move-only object used to send response data from the application
 ///
 class Response {
     using ResponseSender = std::function<void(std::string&& data, std::string&& errorData)>;
+    using FileResponseSender = std::function<void(const FileRegion& fileRegion, std::string&& errorData)>;
+    using SharedResponseSender =
+            std::function<void(const std::shared_ptr<const std::string>& data, std::string&& errorData)>;
 
 public:
     ///
     /// \brief Constructor
     /// \param sender - a response sending function
+    /// \param fileSender - a function sending a response with data stored in a file
+    /// \param sharedSender - a function sending a response with data stored in a shared buffer
+    /// \param cancellationToken - state of the request, set by fcgi::Responder
     ///
-    explicit Response(ResponseSender sender);
+    explicit Response(
+            ResponseSender sender,
+            FileResponseSender fileSender = {},
+            SharedResponseSender sharedSender = {},
+            std::shared_ptr<CancellationToken> cancellationToken = {});
 
     ///
     /// \brief setData
@@ -24,6 +46,25 @@ public:
     ///
     void setData(std::string data);
 
+    ///
+    /// \brief setData
+    /// Sets HTTP response data stored in a shared immutable buffer.
+    /// The buffer isn't copied, so the same data can be used in multiple responses
+    /// without an overhead of copying it for each request.
+    /// \param data
+    ///
+    void setData(std::shared_ptr<const std::string> data);
+
+    ///
+    /// \brief setFileData
+    /// Sets a file region as HTTP response data.
+    /// The file content isn't read by the library, only the FastCGI record headers are created,
+    /// and the file region is passed to fcgi::Responder::sendFileData between them.
+    /// The file descriptor must stay valid until the response is sent.
+    /// \param fileRegion
+    ///
+    void setFileData(const FileRegion& fileRegion);
+
     ///
     /// \brief setErrorMsg
     /// Sets error information
@@ -31,6 +72,23 @@ public:
     ///
     void setErrorMsg(std::string errorMsg);
 
+    ///
+    /// \brief isCancelled
+    /// Can be called from any thread to stop processing of a request early.
+    /// \return true if the request is aborted by the web server or its connection is closed,
+    /// so the response won't be sent
+    ///
+    bool isCancelled() const;
+
+    ///
+    /// \brief setCancellationHandler
+    /// Registers a function called once by the Responder's thread when the request is aborted by the web server
+    /// or its connection is closed. If the request is already cancelled, the function is called right away.
+    /// Can be called from any thread.
+    /// \param handler
+    ///
+    void setCancellationHandler(std::function<void()> handler);
+
     ///
     /// \brief send
     /// Sends the response data during the first call only,
@@ -54,8 +112,13 @@ public:
 
 private:
     std::string data_;
+    std::shared_ptr<const std::string> sharedData_;
+    std::optional<FileRegion> fileData_;
     std::string errorMsg_;
     ResponseSender sender_;
+    FileResponseSender fileSender_;
+    SharedResponseSender sharedSender_;
+    std::shared_ptr<CancellationToken> cancellationToken_;
 };
 
 } //namespace fcgi
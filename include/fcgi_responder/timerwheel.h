@@ -0,0 +1,131 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace fcgi {
+
+///
+/// \brief Hierarchical timer wheel driving the timeouts of Responders and Requesters.
+/// It doesn't depend on any event loop: the time is advanced by calling tick(), for example on each iteration
+/// of the loop or by a periodic timer. Arming and cancelling of a timer take constant time.
+/// It isn't thread-safe, so it should be shared only by the connections served by the same thread.
+///
+class TimerWheel {
+    struct Node {
+        Node* prev = nullptr;
+        Node* next = nullptr;
+    };
+
+public:
+    ///
+    /// \brief Timer that can be armed on a TimerWheel, it's cancelled when destroyed.
+    /// Moving an armed timer keeps it armed.
+    ///
+    class Timer : private Node {
+    public:
+        explicit Timer(std::function<void()> handler = {});
+        ~Timer();
+        Timer(Timer&& other) noexcept;
+        Timer& operator=(Timer&& other) noexcept;
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        ///
+        /// \brief setHandler
+        /// Sets a function called by TimerWheel::tick when the timer expires
+        /// \param handler
+        ///
+        void setHandler(std::function<void()> handler);
+
+        ///
+        /// \brief cancel
+        /// Disarms the timer, does nothing if it isn't armed
+        ///
+        void cancel();
+
+        ///
+        /// \brief isArmed
+        /// \return true if the timer is armed and hasn't expired yet
+        ///
+        bool isArmed() const;
+
+    private:
+        void takeListPosition(Timer& other);
+
+    private:
+        friend class TimerWheel;
+        std::function<void()> handler_;
+        TimerWheel* wheel_ = nullptr;
+        std::uint64_t expirationTick_ = 0;
+    };
+
+    ///
+    /// \brief Constructor
+    /// \param resolution - duration of a single tick, timeouts are rounded up to it
+    /// \param startTime - time corresponding to the first tick
+    ///
+    explicit TimerWheel(
+            std::chrono::steady_clock::duration resolution = std::chrono::milliseconds{10},
+            std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now());
+    ~TimerWheel();
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    ///
+    /// \brief arm
+    /// Arms the timer to expire after the timeout counted from the time of the last tick.
+    /// An armed timer is rearmed.
+    /// \param timer
+    /// \param timeout
+    ///
+    void arm(Timer& timer, std::chrono::steady_clock::duration timeout);
+
+    ///
+    /// \brief tick
+    /// Advances the wheel to the specified time and calls the handlers of the expired timers.
+    /// Handlers can arm and cancel any timers, but the wheel must stay alive until this method returns.
+    /// \param now
+    ///
+    void tick(std::chrono::steady_clock::time_point now);
+
+    ///
+    /// \brief now
+    /// \return time of the last tick
+    ///
+    std::chrono::steady_clock::time_point now() const;
+
+    ///
+    /// \brief resolution
+    /// \return duration of a single tick
+    ///
+    std::chrono::steady_clock::duration resolution() const;
+
+    ///
+    /// \brief armedTimersNumber
+    /// \return number of the armed timers
+    ///
+    std::size_t armedTimersNumber() const;
+
+private:
+    static constexpr auto bitsPerLevel = 8;
+    static constexpr auto slotsPerLevel = std::size_t{1} << bitsPerLevel;
+    static constexpr auto levelsNumber = 4;
+
+    void schedule(Timer& timer);
+    void step();
+    static void link(Node& list, Node& node);
+    static void unlink(Node& node);
+    static void splice(Node& source, Node& target);
+
+private:
+    std::chrono::steady_clock::duration resolution_;
+    std::chrono::steady_clock::time_point startTime_;
+    std::uint64_t currentTick_ = 0;
+    std::size_t armedTimersNumber_ = 0;
+    std::array<std::array<Node, slotsPerLevel>, levelsNumber> slots_;
+};
+
+} //namespace fcgi
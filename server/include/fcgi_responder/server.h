@@ -0,0 +1,125 @@
+#pragma once
+#include <fcgi_responder/request.h>
+#include <fcgi_responder/responder.h>
+#include <fcgi_responder/response.h>
+#include <fcgi_responder/respondergroup.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fcgi {
+class ServerImpl;
+
+///
+/// \brief FastCGI application server based on the epoll event loop.
+/// It accepts connections on Unix domain and TCP sockets, and creates a Responder
+/// for each connection, which passes the received requests to the request processor.
+/// By default, all connections are served by the thread calling the run() method,
+/// see setThreadsNumber() for running an event loop per CPU core.
+/// Available on Linux only.
+///
+class Server {
+public:
+    ///
+    /// \brief Constructor
+    /// \param requestProcessor function forming the response data.
+    /// fcgi::Response objects must be used from the thread running the server.
+    ///
+    explicit Server(std::function<void(Request&& request, Response&& response)> requestProcessor);
+    ~Server();
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+    Server(Server&&) noexcept;
+    Server& operator=(Server&&) noexcept;
+
+    ///
+    /// \brief listen
+    /// Starts listening for connections on the Unix domain socket.
+    /// Existing file at the socket path is removed.
+    /// Throws std::system_error on failure.
+    /// \param socketPath
+    ///
+    void listen(const std::string& socketPath);
+
+    ///
+    /// \brief listen
+    /// Starts listening for connections on the TCP socket.
+    /// Throws std::system_error on failure.
+    /// \param address IP address or host name
+    /// \param port
+    ///
+    void listen(const std::string& address, std::uint16_t port);
+
+    ///
+    /// \brief run
+    /// Runs the event loops, until stop() is called.
+    /// The first event loop runs in the calling thread, the others run in the started threads,
+    /// which are joined before returning.
+    /// Throws std::system_error on failure.
+    ///
+    void run();
+
+    ///
+    /// \brief stop
+    /// Stops the event loop. This method can be called from any thread.
+    ///
+    void stop();
+
+    ///
+    /// \brief setThreadsNumber
+    /// Sets the number of event loops, each running in its own thread and serving its own connections.
+    /// Each loop listens on its own TCP socket bound with SO_REUSEPORT option, so the kernel distributes
+    /// the new connections between them. Unix domain sockets are shared by all loops.
+    /// With more than one thread, the request processor and the responder configurator are called concurrently.
+    /// Must not be called while the server is running.
+    /// \param threadsNumber number of event loops, 1 by default
+    ///
+    void setThreadsNumber(int threadsNumber);
+
+    ///
+    /// \brief setCpuAffinity
+    /// Pins the thread of each event loop to a CPU core: the loop with index N runs on cpuIds[N % cpuIds.size()].
+    /// The first event loop runs in the thread calling run(), so that thread is pinned too.
+    /// By default, the threads aren't pinned.
+    /// \param cpuIds
+    ///
+    void setCpuAffinity(std::vector<int> cpuIds);
+
+    ///
+    /// \brief setResponderConfigurator
+    /// Sets a function called for the Responder of each new connection,
+    /// it can be used to change the Responder's settings.
+    /// \param configurator
+    ///
+    void setResponderConfigurator(std::function<void(Responder&)> configurator);
+
+    ///
+    /// \brief setErrorInfoHandler
+    /// Sets a handler receiving the text information about socket, protocol and stream errors.
+    /// \param errorInfoHandler
+    ///
+    void setErrorInfoHandler(std::function<void(const std::string&)> errorInfoHandler);
+
+    ///
+    /// \brief setResponderGroup
+    /// Sets a group joined by the Responders of all connections. New connections exceeding
+    /// the group's maximum connections number are closed right after accepting them.
+    /// Must not be called while the server is running.
+    /// \param responderGroup
+    ///
+    void setResponderGroup(std::shared_ptr<ResponderGroup> responderGroup);
+
+    ///
+    /// \brief connectionsNumber
+    /// This method can be called from any thread.
+    /// \return number of opened connections
+    ///
+    std::size_t connectionsNumber() const;
+
+private:
+    std::unique_ptr<ServerImpl> impl_;
+};
+
+} //namespace fcgi
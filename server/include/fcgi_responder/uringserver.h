@@ -0,0 +1,103 @@
+#pragma once
+#include <fcgi_responder/request.h>
+#include <fcgi_responder/responder.h>
+#include <fcgi_responder/response.h>
+#include <fcgi_responder/respondergroup.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace fcgi {
+class UringServerImpl;
+
+///
+/// \brief FastCGI application server based on io_uring.
+/// It has the same interface as fcgi::Server, but receives the data into the buffers
+/// provided to the kernel and shared by all connections, and sends the output queued
+/// by each connection with a single vectored write. Operations of all connections
+/// are submitted with one system call per event loop iteration.
+/// Available on Linux 5.19 and later, when the library is built with ENABLE_SERVER_IO_URING option.
+///
+class UringServer {
+public:
+    ///
+    /// \brief Constructor
+    /// \param requestProcessor function forming the response data.
+    /// fcgi::Response objects must be used from the thread running the server.
+    /// Throws std::system_error if io_uring or its provided buffer rings aren't supported by the kernel.
+    ///
+    explicit UringServer(std::function<void(Request&& request, Response&& response)> requestProcessor);
+    ~UringServer();
+    UringServer(const UringServer&) = delete;
+    UringServer& operator=(const UringServer&) = delete;
+    UringServer(UringServer&&) noexcept;
+    UringServer& operator=(UringServer&&) noexcept;
+
+    ///
+    /// \brief listen
+    /// Starts listening for connections on the Unix domain socket.
+    /// Existing file at the socket path is removed.
+    /// Throws std::system_error on failure.
+    /// \param socketPath
+    ///
+    void listen(const std::string& socketPath);
+
+    ///
+    /// \brief listen
+    /// Starts listening for connections on the TCP socket.
+    /// Throws std::system_error on failure.
+    /// \param address IP address or host name
+    /// \param port
+    ///
+    void listen(const std::string& address, std::uint16_t port);
+
+    ///
+    /// \brief run
+    /// Runs the event loop, until stop() is called.
+    /// Throws std::system_error on failure.
+    ///
+    void run();
+
+    ///
+    /// \brief stop
+    /// Stops the event loop. This method can be called from any thread.
+    ///
+    void stop();
+
+    ///
+    /// \brief setResponderConfigurator
+    /// Sets a function called for the Responder of each new connection,
+    /// it can be used to change the Responder's settings.
+    /// \param configurator
+    ///
+    void setResponderConfigurator(std::function<void(Responder&)> configurator);
+
+    ///
+    /// \brief setErrorInfoHandler
+    /// Sets a handler receiving the text information about socket, protocol and stream errors.
+    /// \param errorInfoHandler
+    ///
+    void setErrorInfoHandler(std::function<void(const std::string&)> errorInfoHandler);
+
+    ///
+    /// \brief setResponderGroup
+    /// Sets a group joined by the Responders of all connections. New connections exceeding
+    /// the group's maximum connections number are closed right after accepting them.
+    /// Must not be called while the server is running.
+    /// \param responderGroup
+    ///
+    void setResponderGroup(std::shared_ptr<ResponderGroup> responderGroup);
+
+    ///
+    /// \brief connectionsNumber
+    /// This method can be called from any thread.
+    /// \return number of opened connections
+    ///
+    std::size_t connectionsNumber() const;
+
+private:
+    std::unique_ptr<UringServerImpl> impl_;
+};
+
+} //namespace fcgi
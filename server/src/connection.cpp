@@ -0,0 +1,239 @@
+#include "connection.h"
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <unistd.h>
+
+namespace fcgi {
+
+Connection::Connection(
+        int epollFd,
+        const std::function<void(Request&&, Response&&)>& requestProcessor,
+        std::function<void(Connection&)> closeHandler,
+        std::function<void(const std::string&)> errorInfoHandler)
+    : epollFd_{epollFd}
+    , requestProcessor_{requestProcessor}
+    , closeHandler_{std::move(closeHandler)}
+    , errorInfoHandler_{std::move(errorInfoHandler)}
+{
+    if (errorInfoHandler_)
+        setErrorInfoHandler(errorInfoHandler_);
+}
+
+Connection::~Connection()
+{
+    release();
+}
+
+void Connection::open(int socket, std::shared_ptr<ResponderGroup> responderGroup)
+{
+    socket_ = socket;
+    events_ = 0;
+    isReadingPaused_ = false;
+    isWaitingForWritable_ = false;
+    isClosed_ = false;
+    responderGroup_ = std::move(responderGroup);
+    setResponderGroup(responderGroup_);
+}
+
+void Connection::release()
+{
+    if (socket_ < 0)
+        return;
+
+    ::close(socket_);
+    socket_ = -1;
+    isClosed_ = true;
+    unsentData_.clear();
+    if (responderGroup_)
+        responderGroup_->releaseConnection();
+    reset();
+}
+
+int Connection::socket() const
+{
+    return socket_;
+}
+
+bool Connection::isClosed() const
+{
+    return isClosed_;
+}
+
+void Connection::startReading()
+{
+    auto event = epoll_event{};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.fd = socket_;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, socket_, &event) < 0) {
+        onSocketError("epoll_ctl");
+        return;
+    }
+    events_ = event.events;
+}
+
+void Connection::onReadable(char* buffer, std::size_t bufferSize)
+{
+    while (!isClosed_ && !isReadingPaused_) {
+        auto size = ::recv(socket_, buffer, bufferSize, 0);
+        if (size > 0) {
+            receiveData(buffer, static_cast<std::size_t>(size));
+            if (isOutputQueueFull()) {
+                isReadingPaused_ = true;
+                updateEvents();
+            }
+            continue;
+        }
+        if (size == 0) {
+            close();
+            return;
+        }
+        if (errno == EINTR)
+            continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+            onSocketError("recv");
+        return;
+    }
+}
+
+void Connection::onWritable()
+{
+    if (!unsentData_.empty())
+        sendData(std::exchange(unsentData_, {}));
+    Responder::onWritable();
+    if (isClosed_)
+        return;
+    if (unsentData_.empty() && outputQueueSize() == 0)
+        isWaitingForWritable_ = false;
+    if (isReadingPaused_ && !isOutputQueueFull())
+        isReadingPaused_ = false;
+    updateEvents();
+}
+
+void Connection::close()
+{
+    if (isClosed_)
+        return;
+    isClosed_ = true;
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, socket_, nullptr);
+    ::shutdown(socket_, SHUT_RDWR);
+    closeHandler_(*this);
+}
+
+void Connection::sendData(const std::string& data)
+{
+    // Responder calls it only from the default implementations of trySendData and trySendFileData,
+    // still the event loop isn't blocked: the unsent part of the data is kept until the socket becomes writable
+    if (!unsentData_.empty()) {
+        unsentData_ += data;
+        return;
+    }
+    const auto sentSize = trySendData(data);
+    if (sentSize < data.size())
+        unsentData_.append(data, sentSize, std::string::npos);
+}
+
+std::size_t Connection::trySendData(const std::string& data)
+{
+    if (isClosed_)
+        return data.size();
+    if (!unsentData_.empty())
+        return 0;
+
+    while (true) {
+        auto size = ::send(socket_, data.data(), data.size(), MSG_NOSIGNAL);
+        if (size >= 0) {
+            if (static_cast<std::size_t>(size) < data.size() && !isWaitingForWritable_) {
+                isWaitingForWritable_ = true;
+                updateEvents();
+            }
+            return static_cast<std::size_t>(size);
+        }
+        if (errno == EINTR)
+            continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            if (!isWaitingForWritable_) {
+                isWaitingForWritable_ = true;
+                updateEvents();
+            }
+            return 0;
+        }
+        onSocketError("send");
+        return data.size();
+    }
+}
+
+std::size_t Connection::trySendFileData(const FileRegion& fileRegion)
+{
+    if (isClosed_)
+        return fileRegion.size;
+    if (!unsentData_.empty())
+        return 0;
+
+    auto offset = static_cast<off_t>(fileRegion.offset);
+    while (true) {
+        auto size = ::sendfile(socket_, fileRegion.fileDescriptor, &offset, fileRegion.size);
+        if (size >= 0) {
+            if (static_cast<std::size_t>(size) < fileRegion.size && !isWaitingForWritable_) {
+                isWaitingForWritable_ = true;
+                updateEvents();
+            }
+            return static_cast<std::size_t>(size);
+        }
+        if (errno == EINTR)
+            continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            if (!isWaitingForWritable_) {
+                isWaitingForWritable_ = true;
+                updateEvents();
+            }
+            return 0;
+        }
+        onSocketError("sendfile");
+        return fileRegion.size;
+    }
+}
+
+void Connection::disconnect()
+{
+    close();
+}
+
+void Connection::processRequest(Request&& request, Response&& response)
+{
+    requestProcessor_(std::move(request), std::move(response));
+}
+
+void Connection::updateEvents()
+{
+    if (isClosed_)
+        return;
+    auto events = std::uint32_t{};
+    if (!isReadingPaused_)
+        events |= EPOLLIN | EPOLLRDHUP;
+    if (isWaitingForWritable_)
+        events |= EPOLLOUT;
+    if (events == events_)
+        return;
+
+    auto event = epoll_event{};
+    event.events = events;
+    event.data.fd = socket_;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_MOD, socket_, &event) < 0) {
+        onSocketError("epoll_ctl");
+        return;
+    }
+    events_ = events;
+}
+
+void Connection::onSocketError(const std::string& operation)
+{
+    if (errorInfoHandler_)
+        errorInfoHandler_("Connection error on " + operation + ": " + std::strerror(errno));
+    close();
+}
+
+} //namespace fcgi
@@ -0,0 +1,58 @@
+#pragma once
+#include <fcgi_responder/responder.h>
+#include <fcgi_responder/respondergroup.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace fcgi {
+
+class Connection : public Responder {
+public:
+    Connection(
+            int epollFd,
+            const std::function<void(Request&&, Response&&)>& requestProcessor,
+            std::function<void(Connection&)> closeHandler,
+            std::function<void(const std::string&)> errorInfoHandler);
+    ~Connection() override;
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+    Connection(Connection&&) = delete;
+    Connection& operator=(Connection&&) = delete;
+
+    int socket() const;
+    bool isClosed() const;
+    void open(int socket, std::shared_ptr<ResponderGroup> responderGroup);
+    void release();
+    void startReading();
+    void onReadable(char* buffer, std::size_t bufferSize);
+    void onWritable();
+    void close();
+
+private:
+    void sendData(const std::string& data) override;
+    std::size_t trySendData(const std::string& data) override;
+    std::size_t trySendFileData(const FileRegion& fileRegion) override;
+    void disconnect() override;
+    void processRequest(Request&& request, Response&& response) override;
+
+    void updateEvents();
+    void onSocketError(const std::string& operation);
+
+private:
+    int socket_ = -1;
+    int epollFd_;
+    const std::function<void(Request&&, Response&&)>& requestProcessor_;
+    std::function<void(Connection&)> closeHandler_;
+    std::function<void(const std::string&)> errorInfoHandler_;
+    std::shared_ptr<ResponderGroup> responderGroup_;
+    // data passed to sendData that the socket didn't accept, it's sent before the Responder's output queue
+    std::string unsentData_;
+    std::uint32_t events_ = 0;
+    bool isReadingPaused_ = false;
+    bool isWaitingForWritable_ = false;
+    bool isClosed_ = true;
+};
+
+} //namespace fcgi
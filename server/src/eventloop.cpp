@@ -0,0 +1,197 @@
+#include "eventloop.h"
+#include "connection.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <unistd.h>
+
+namespace fcgi {
+
+namespace {
+constexpr auto readBufferSize = 65536;
+constexpr auto maxEventsNumber = 256;
+constexpr auto maxAcceptedConnectionsNumber = 16;
+constexpr auto maxPooledConnectionsNumber = std::size_t{128};
+
+[[noreturn]] void throwSystemError(const std::string& operation)
+{
+    throw std::system_error{errno, std::generic_category(), operation};
+}
+} //namespace
+
+EventLoop::EventLoop(
+        const std::function<void(Request&& request, Response&& response)>& requestProcessor,
+        const std::function<void(Responder&)>& responderConfigurator,
+        const std::function<void(const std::string&)>& errorInfoHandler,
+        const std::shared_ptr<ResponderGroup>& responderGroup)
+    : requestProcessor_{requestProcessor}
+    , responderConfigurator_{responderConfigurator}
+    , errorInfoHandler_{errorInfoHandler}
+    , responderGroup_{responderGroup}
+    , readBuffer_(readBufferSize)
+{
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd_ < 0)
+        throwSystemError("epoll_create1");
+
+    stopEventFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (stopEventFd_ < 0) {
+        ::close(epollFd_);
+        throwSystemError("eventfd");
+    }
+    auto event = epoll_event{};
+    event.events = EPOLLIN;
+    event.data.fd = stopEventFd_;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, stopEventFd_, &event);
+}
+
+EventLoop::~EventLoop()
+{
+    connections_.clear();
+    ::close(stopEventFd_);
+    ::close(epollFd_);
+}
+
+void EventLoop::addListener(int socket)
+{
+    auto event = epoll_event{};
+    // with EPOLLEXCLUSIVE, only one of the loops sharing the listener socket is woken up by a new connection
+    event.events = EPOLLIN | EPOLLEXCLUSIVE;
+    event.data.fd = socket;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, socket, &event) < 0)
+        throwSystemError("epoll_ctl");
+    listenerSockets_.push_back(socket);
+}
+
+void EventLoop::run()
+{
+    auto events = std::array<epoll_event, maxEventsNumber>{};
+    while (true) {
+        auto eventsNumber = epoll_wait(epollFd_, events.data(), maxEventsNumber, -1);
+        if (eventsNumber < 0) {
+            if (errno == EINTR)
+                continue;
+            throwSystemError("epoll_wait");
+        }
+        for (auto i = 0; i < eventsNumber; ++i) {
+            const auto socket = events[i].data.fd;
+            if (socket == stopEventFd_) {
+                auto value = eventfd_t{};
+                eventfd_read(stopEventFd_, &value);
+                removeClosedConnections();
+                return;
+            }
+            if (isListener(socket))
+                acceptConnections(socket);
+            else
+                onConnectionEvent(socket, events[i].events);
+        }
+        removeClosedConnections();
+    }
+}
+
+void EventLoop::stop()
+{
+    eventfd_write(stopEventFd_, 1);
+}
+
+void EventLoop::acceptConnections(int listenerSocket)
+{
+    // the number of accepted connections per event is limited,
+    // so the connections from the listener shared by several loops are distributed between them
+    for (auto i = 0; i < maxAcceptedConnectionsNumber; ++i) {
+        auto socket = accept4(listenerSocket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (socket < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                notifyAboutError(std::string{"Connection accepting error: "} + std::strerror(errno));
+            return;
+        }
+        if (responderGroup_ && !responderGroup_->tryAcquireConnection()) {
+            ::close(socket);
+            continue;
+        }
+
+        auto connection = makeConnection();
+        connection->open(socket, responderGroup_);
+        if (responderConfigurator_)
+            responderConfigurator_(*connection);
+        auto& connectionRef = *connection;
+        connections_.emplace(socket, std::move(connection));
+        ++connectionsNumber_;
+        connectionRef.startReading();
+    }
+}
+
+std::unique_ptr<Connection> EventLoop::makeConnection()
+{
+    if (!connectionPool_.empty()) {
+        auto connection = std::move(connectionPool_.back());
+        connectionPool_.pop_back();
+        return connection;
+    }
+    return std::make_unique<Connection>(
+            epollFd_,
+            requestProcessor_,
+            [this](Connection& connection)
+            {
+                closedConnections_.push_back(connection.socket());
+                --connectionsNumber_;
+            },
+            errorInfoHandler_);
+}
+
+void EventLoop::onConnectionEvent(int socket, std::uint32_t events)
+{
+    auto it = connections_.find(socket);
+    if (it == connections_.end())
+        return;
+
+    auto& connection = *it->second;
+    if (events & EPOLLOUT)
+        connection.onWritable();
+    if (events & (EPOLLIN | EPOLLRDHUP))
+        connection.onReadable(readBuffer_.data(), readBuffer_.size());
+    if (events & (EPOLLERR | EPOLLHUP))
+        connection.close();
+}
+
+void EventLoop::removeClosedConnections()
+{
+    // closed connections are reused for the new ones, so their buffers aren't reallocated
+    for (auto socket : closedConnections_) {
+        auto it = connections_.find(socket);
+        if (it == connections_.end())
+            continue;
+        auto connection = std::move(it->second);
+        connections_.erase(it);
+        connection->release();
+        if (connectionPool_.size() < maxPooledConnectionsNumber)
+            connectionPool_.push_back(std::move(connection));
+    }
+    closedConnections_.clear();
+}
+
+bool EventLoop::isListener(int socket) const
+{
+    return std::find(listenerSockets_.begin(), listenerSockets_.end(), socket) != listenerSockets_.end();
+}
+
+std::size_t EventLoop::connectionsNumber() const
+{
+    return connectionsNumber_;
+}
+
+void EventLoop::notifyAboutError(const std::string& errorMsg)
+{
+    if (errorInfoHandler_)
+        errorInfoHandler_(errorMsg);
+}
+
+} //namespace fcgi
@@ -0,0 +1,61 @@
+#pragma once
+#include <fcgi_responder/request.h>
+#include <fcgi_responder/responder.h>
+#include <fcgi_responder/response.h>
+#include <fcgi_responder/respondergroup.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fcgi {
+class Connection;
+
+///
+/// epoll event loop serving the connections accepted from its listener sockets.
+/// All its connections are used only from the thread calling run().
+///
+class EventLoop {
+public:
+    EventLoop(
+            const std::function<void(Request&& request, Response&& response)>& requestProcessor,
+            const std::function<void(Responder&)>& responderConfigurator,
+            const std::function<void(const std::string&)>& errorInfoHandler,
+            const std::shared_ptr<ResponderGroup>& responderGroup);
+    ~EventLoop();
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /// Listener socket isn't owned by the loop and can be shared with other loops.
+    void addListener(int socket);
+    void run();
+    void stop();
+    std::size_t connectionsNumber() const;
+
+private:
+    void acceptConnections(int listenerSocket);
+    std::unique_ptr<Connection> makeConnection();
+    void onConnectionEvent(int socket, std::uint32_t events);
+    void removeClosedConnections();
+    bool isListener(int socket) const;
+    void notifyAboutError(const std::string& errorMsg);
+
+private:
+    const std::function<void(Request&& request, Response&& response)>& requestProcessor_;
+    const std::function<void(Responder&)>& responderConfigurator_;
+    const std::function<void(const std::string&)>& errorInfoHandler_;
+    const std::shared_ptr<ResponderGroup>& responderGroup_;
+    int epollFd_ = -1;
+    int stopEventFd_ = -1;
+    std::vector<int> listenerSockets_;
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_;
+    std::vector<int> closedConnections_;
+    std::vector<std::unique_ptr<Connection>> connectionPool_;
+    std::atomic<std::size_t> connectionsNumber_ = 0;
+    std::vector<char> readBuffer_;
+};
+
+} //namespace fcgi
@@ -0,0 +1,250 @@
+#include "iouring.h"
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <unistd.h>
+
+namespace fcgi {
+
+namespace {
+[[noreturn]] void throwSystemError(int error, const std::string& operation)
+{
+    throw std::system_error{error, std::generic_category(), operation};
+}
+
+template<typename T>
+T* ringField(void* ring, unsigned offset)
+{
+    return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+
+void* mapRing(int ringFd, std::size_t size, off_t offset)
+{
+    auto memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, offset);
+    if (memory == MAP_FAILED)
+        throwSystemError(errno, "mmap");
+    return memory;
+}
+} //namespace
+
+IoUring::IoUring(unsigned entriesNumber)
+{
+    auto params = io_uring_params{};
+    ringFd_ = static_cast<int>(syscall(__NR_io_uring_setup, entriesNumber, &params));
+    if (ringFd_ < 0)
+        throwSystemError(errno, "io_uring_setup");
+
+    try {
+        sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+            sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+
+        sqRing_ = mapRing(ringFd_, sqRingSize_, IORING_OFF_SQ_RING);
+        cqRing_ = (params.features & IORING_FEAT_SINGLE_MMAP) ? sqRing_
+                                                               : mapRing(ringFd_, cqRingSize_, IORING_OFF_CQ_RING);
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(mapRing(ringFd_, sqesSize_, IORING_OFF_SQES));
+    }
+    catch (...) {
+        release();
+        throw;
+    }
+
+    sqHead_ = ringField<unsigned>(sqRing_, params.sq_off.head);
+    sqTail_ = ringField<unsigned>(sqRing_, params.sq_off.tail);
+    sqMask_ = *ringField<unsigned>(sqRing_, params.sq_off.ring_mask);
+    sqEntriesNumber_ = params.sq_entries;
+    sqArray_ = ringField<unsigned>(sqRing_, params.sq_off.array);
+    sqeTail_ = sqeSubmitted_ = *sqTail_;
+
+    cqHead_ = ringField<unsigned>(cqRing_, params.cq_off.head);
+    cqTail_ = ringField<unsigned>(cqRing_, params.cq_off.tail);
+    cqMask_ = *ringField<unsigned>(cqRing_, params.cq_off.ring_mask);
+    cqes_ = ringField<io_uring_cqe>(cqRing_, params.cq_off.cqes);
+}
+
+IoUring::~IoUring()
+{
+    release();
+}
+
+void IoUring::release()
+{
+    if (sqes_)
+        munmap(sqes_, sqesSize_);
+    if (cqRing_ && cqRing_ != sqRing_)
+        munmap(cqRing_, cqRingSize_);
+    if (sqRing_)
+        munmap(sqRing_, sqRingSize_);
+    ::close(ringFd_);
+}
+
+int IoUring::fileDescriptor() const
+{
+    return ringFd_;
+}
+
+io_uring_sqe& IoUring::nextSqe()
+{
+    // the slot of an entry can't be reused until the kernel consumes the entry
+    auto head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    while (sqeTail_ - head >= sqEntriesNumber_) {
+        const auto error = submit(0);
+        const auto submittedHead = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+        // the kernel doesn't accept new entries while the completions don't fit into the completion queue,
+        // so the queue is emptied before trying again
+        if (submittedHead == head && !reapCompletions())
+            throwSystemError(error ? error : EBUSY, "io_uring_enter");
+        head = submittedHead;
+    }
+
+    const auto index = sqeTail_ & sqMask_;
+    sqArray_[index] = index;
+    ++sqeTail_;
+    auto& sqe = sqes_[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    return sqe;
+}
+
+void IoUring::submitAndWait(unsigned waitNumber)
+{
+    submit(waitNumber);
+}
+
+int IoUring::submit(unsigned waitNumber)
+{
+    __atomic_store_n(sqTail_, sqeTail_, __ATOMIC_RELEASE);
+    while (true) {
+        const auto submitNumber = sqeTail_ - sqeSubmitted_;
+        auto result = syscall(
+                __NR_io_uring_enter,
+                ringFd_,
+                submitNumber,
+                waitNumber,
+                waitNumber ? IORING_ENTER_GETEVENTS : 0u,
+                nullptr,
+                0);
+        if (result >= 0) {
+            sqeSubmitted_ += static_cast<unsigned>(result);
+            return 0;
+        }
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            throwSystemError(errno, "io_uring_enter");
+        if (errno != EINTR)
+            return errno;
+    }
+}
+
+bool IoUring::reapCompletions()
+{
+    auto head = __atomic_load_n(cqHead_, __ATOMIC_RELAXED);
+    const auto tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    if (head == tail)
+        return false;
+    for (; head != tail; ++head)
+        completionBacklog_.push_back(cqes_[head & cqMask_]);
+    __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+    return true;
+}
+
+void IoUring::forEachCompletion(const std::function<void(const io_uring_cqe&)>& completionHandler)
+{
+    while (true) {
+        // the reaped completions precede the ones left in the queue,
+        // the handlers can reap more of them, so the backlog's size is checked on each iteration
+        for (auto i = std::size_t{}; i < completionBacklog_.size(); ++i) {
+            const auto cqe = completionBacklog_[i];
+            completionHandler(cqe);
+        }
+        completionBacklog_.clear();
+
+        const auto head = __atomic_load_n(cqHead_, __ATOMIC_RELAXED);
+        if (head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE))
+            return;
+        const auto cqe = cqes_[head & cqMask_];
+        __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+        completionHandler(cqe);
+    }
+}
+
+BufferRing::BufferRing(IoUring& ring, std::uint16_t groupId, std::uint16_t buffersNumber, std::uint32_t bufferSize)
+    : groupId_{groupId}
+    , buffersNumber_{buffersNumber}
+    , bufferSize_{bufferSize}
+{
+    ringMemorySize_ = buffersNumber_ * sizeof(io_uring_buf);
+    ringMemory_ = mmap(nullptr, ringMemorySize_, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (ringMemory_ == MAP_FAILED)
+        throwSystemError(errno, "mmap");
+
+    bufferMemorySize_ = std::size_t{buffersNumber_} * bufferSize_;
+    auto bufferMemory = mmap(nullptr, bufferMemorySize_, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (bufferMemory == MAP_FAILED) {
+        auto error = errno;
+        munmap(ringMemory_, ringMemorySize_);
+        throwSystemError(error, "mmap");
+    }
+    bufferMemory_ = static_cast<char*>(bufferMemory);
+
+    buffers_ = static_cast<io_uring_buf*>(ringMemory_);
+    // the ring's tail is stored in place of the first buffer's reserved field
+    tail_ = &buffers_[0].resv;
+    *tail_ = 0;
+
+    auto registration = io_uring_buf_reg{};
+    registration.ring_addr = reinterpret_cast<std::uint64_t>(ringMemory_);
+    registration.ring_entries = buffersNumber_;
+    registration.bgid = groupId_;
+    if (syscall(__NR_io_uring_register, ring.fileDescriptor(), IORING_REGISTER_PBUF_RING, &registration, 1) < 0) {
+        auto error = errno;
+        munmap(bufferMemory_, bufferMemorySize_);
+        munmap(ringMemory_, ringMemorySize_);
+        throwSystemError(error, "io_uring_register");
+    }
+
+    for (auto bufferId = std::uint16_t{}; bufferId < buffersNumber_; ++bufferId)
+        addBuffer(bufferId);
+}
+
+BufferRing::~BufferRing()
+{
+    munmap(bufferMemory_, bufferMemorySize_);
+    munmap(ringMemory_, ringMemorySize_);
+}
+
+std::uint16_t BufferRing::groupId() const
+{
+    return groupId_;
+}
+
+const char* BufferRing::buffer(std::uint16_t bufferId) const
+{
+    return bufferMemory_ + std::size_t{bufferId} * bufferSize_;
+}
+
+void BufferRing::recycle(std::uint16_t bufferId)
+{
+    addBuffer(bufferId);
+    ++recycledBuffersNumber_;
+}
+
+std::uint64_t BufferRing::recycledBuffersNumber() const
+{
+    return recycledBuffersNumber_;
+}
+
+void BufferRing::addBuffer(std::uint16_t bufferId)
+{
+    const auto tail = *tail_;
+    auto& buffer = buffers_[tail & (buffersNumber_ - 1)];
+    buffer.addr = reinterpret_cast<std::uint64_t>(bufferMemory_ + std::size_t{bufferId} * bufferSize_);
+    buffer.len = bufferSize_;
+    buffer.bid = bufferId;
+    __atomic_store_n(tail_, static_cast<std::uint16_t>(tail + 1), __ATOMIC_RELEASE);
+}
+
+} //namespace fcgi
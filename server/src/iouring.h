@@ -0,0 +1,93 @@
+#pragma once
+#include <linux/io_uring.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace fcgi {
+
+///
+/// Minimal io_uring wrapper working with the raw system calls,
+/// so the library doesn't depend on liburing.
+///
+class IoUring {
+public:
+    explicit IoUring(unsigned entriesNumber);
+    ~IoUring();
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    int fileDescriptor() const;
+    /// Returns zeroed submission queue entry, submitting the queued entries if the queue is full.
+    /// Throws std::system_error if the kernel doesn't consume any of them.
+    io_uring_sqe& nextSqe();
+    void submitAndWait(unsigned waitNumber);
+    void forEachCompletion(const std::function<void(const io_uring_cqe&)>& completionHandler);
+
+private:
+    /// Returns the error of io_uring_enter when the entries can't be submitted now, or 0.
+    int submit(unsigned waitNumber);
+    bool reapCompletions();
+    void release();
+
+private:
+    int ringFd_ = -1;
+    void* sqRing_ = nullptr;
+    std::size_t sqRingSize_ = 0;
+    void* cqRing_ = nullptr;
+    std::size_t cqRingSize_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    std::size_t sqesSize_ = 0;
+
+    unsigned* sqHead_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned sqEntriesNumber_ = 0;
+    unsigned* sqArray_ = nullptr;
+    unsigned sqeTail_ = 0;
+    unsigned sqeSubmitted_ = 0;
+
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned cqMask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+    // completions removed from the queue by nextSqe(), which are handled by the next forEachCompletion() call
+    std::vector<io_uring_cqe> completionBacklog_;
+};
+
+///
+/// Ring of the provided buffers, which the kernel selects for the receive operations
+/// with IOSQE_BUFFER_SELECT flag. Buffers are shared by all connections of the ring.
+/// The number of buffers must be a power of two.
+///
+class BufferRing {
+public:
+    BufferRing(IoUring& ring, std::uint16_t groupId, std::uint16_t buffersNumber, std::uint32_t bufferSize);
+    ~BufferRing();
+    BufferRing(const BufferRing&) = delete;
+    BufferRing& operator=(const BufferRing&) = delete;
+
+    std::uint16_t groupId() const;
+    const char* buffer(std::uint16_t bufferId) const;
+    void recycle(std::uint16_t bufferId);
+    /// Total number of the recycled buffers, it shows whether any buffers were returned to the ring since a moment.
+    std::uint64_t recycledBuffersNumber() const;
+
+private:
+    void addBuffer(std::uint16_t bufferId);
+
+private:
+    std::uint16_t groupId_;
+    std::uint16_t buffersNumber_;
+    std::uint32_t bufferSize_;
+    void* ringMemory_ = nullptr;
+    std::size_t ringMemorySize_ = 0;
+    io_uring_buf* buffers_ = nullptr;
+    std::uint16_t* tail_ = nullptr;
+    char* bufferMemory_ = nullptr;
+    std::size_t bufferMemorySize_ = 0;
+    std::uint64_t recycledBuffersNumber_ = 0;
+};
+
+} //namespace fcgi
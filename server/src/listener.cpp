@@ -0,0 +1,66 @@
+#include "listener.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <algorithm>
+#include <cerrno>
+#include <memory>
+#include <netdb.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace fcgi {
+
+namespace {
+constexpr auto listenBacklog = SOMAXCONN;
+
+int makeListenerSocket(int domain, const sockaddr* address, socklen_t addressLength, bool reusePort)
+{
+    auto listenerSocket = ::socket(domain, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenerSocket < 0)
+        throw std::system_error{errno, std::generic_category(), "socket"};
+
+    if (domain != AF_UNIX) {
+        auto reuseAddress = 1;
+        setsockopt(listenerSocket, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress));
+    }
+    if (reusePort) {
+        auto reusePortValue = 1;
+        setsockopt(listenerSocket, SOL_SOCKET, SO_REUSEPORT, &reusePortValue, sizeof(reusePortValue));
+    }
+    if (::bind(listenerSocket, address, addressLength) < 0 || ::listen(listenerSocket, listenBacklog) < 0) {
+        auto error = errno;
+        ::close(listenerSocket);
+        throw std::system_error{error, std::generic_category(), "bind"};
+    }
+    return listenerSocket;
+}
+} //namespace
+
+int makeUnixListenerSocket(const std::string& socketPath)
+{
+    auto address = sockaddr_un{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path))
+        throw std::system_error{std::make_error_code(std::errc::filename_too_long), "listen"};
+    std::copy(socketPath.begin(), socketPath.end(), address.sun_path);
+
+    ::unlink(socketPath.c_str());
+    return makeListenerSocket(AF_UNIX, reinterpret_cast<const sockaddr*>(&address), sizeof(address), false);
+}
+
+int makeTcpListenerSocket(const std::string& address, std::uint16_t port, bool reusePort)
+{
+    auto hints = addrinfo{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    auto addressInfo = static_cast<addrinfo*>(nullptr);
+    auto result = getaddrinfo(address.c_str(), std::to_string(port).c_str(), &hints, &addressInfo);
+    if (result != 0)
+        throw std::system_error{std::make_error_code(std::errc::address_not_available), gai_strerror(result)};
+
+    auto addressInfoOwner = std::unique_ptr<addrinfo, decltype(&freeaddrinfo)>{addressInfo, &freeaddrinfo};
+    return makeListenerSocket(addressInfo->ai_family, addressInfo->ai_addr, addressInfo->ai_addrlen, reusePort);
+}
+
+} //namespace fcgi
@@ -0,0 +1,10 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace fcgi {
+
+int makeUnixListenerSocket(const std::string& socketPath);
+int makeTcpListenerSocket(const std::string& address, std::uint16_t port, bool reusePort = false);
+
+} //namespace fcgi
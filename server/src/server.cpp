@@ -0,0 +1,65 @@
+#include "serverimpl.h"
+#include <fcgi_responder/server.h>
+
+namespace fcgi {
+
+Server::Server(std::function<void(Request&& request, Response&& response)> requestProcessor)
+    : impl_{std::make_unique<ServerImpl>(std::move(requestProcessor))}
+{
+}
+
+Server::~Server() = default;
+Server::Server(Server&&) noexcept = default;
+Server& Server::operator=(Server&&) noexcept = default;
+
+void Server::listen(const std::string& socketPath)
+{
+    impl_->listen(socketPath);
+}
+
+void Server::listen(const std::string& address, std::uint16_t port)
+{
+    impl_->listen(address, port);
+}
+
+void Server::run()
+{
+    impl_->run();
+}
+
+void Server::stop()
+{
+    impl_->stop();
+}
+
+void Server::setThreadsNumber(int threadsNumber)
+{
+    impl_->setThreadsNumber(threadsNumber);
+}
+
+void Server::setCpuAffinity(std::vector<int> cpuIds)
+{
+    impl_->setCpuAffinity(std::move(cpuIds));
+}
+
+void Server::setResponderConfigurator(std::function<void(Responder&)> configurator)
+{
+    impl_->setResponderConfigurator(std::move(configurator));
+}
+
+void Server::setErrorInfoHandler(std::function<void(const std::string&)> errorInfoHandler)
+{
+    impl_->setErrorInfoHandler(std::move(errorInfoHandler));
+}
+
+void Server::setResponderGroup(std::shared_ptr<ResponderGroup> responderGroup)
+{
+    impl_->setResponderGroup(std::move(responderGroup));
+}
+
+std::size_t Server::connectionsNumber() const
+{
+    return impl_->connectionsNumber();
+}
+
+} //namespace fcgi
@@ -0,0 +1,178 @@
+#include "serverimpl.h"
+#include "eventloop.h"
+#include "listener.h"
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <unistd.h>
+
+namespace fcgi {
+
+namespace {
+void setCurrentThreadCpu(int cpuId)
+{
+    auto cpuSet = cpu_set_t{};
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpuId, &cpuSet);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+}
+} //namespace
+
+ServerImpl::ServerImpl(std::function<void(Request&& request, Response&& response)> requestProcessor)
+    : requestProcessor_{std::move(requestProcessor)}
+{
+    createEventLoops(1);
+}
+
+ServerImpl::~ServerImpl()
+{
+    loops_.clear();
+    closeListeners();
+}
+
+void ServerImpl::listen(const std::string& socketPath)
+{
+    auto listenerAddress = ListenerAddress{};
+    listenerAddress.socketPath = socketPath;
+    addListener(listenerAddress);
+    listenerAddresses_.push_back(std::move(listenerAddress));
+}
+
+void ServerImpl::listen(const std::string& address, std::uint16_t port)
+{
+    auto listenerAddress = ListenerAddress{};
+    listenerAddress.address = address;
+    listenerAddress.port = port;
+    addListener(listenerAddress);
+    listenerAddresses_.push_back(std::move(listenerAddress));
+}
+
+void ServerImpl::addListener(const ListenerAddress& listenerAddress)
+{
+    // Unix domain socket is shared by all event loops, as SO_REUSEPORT doesn't balance
+    // the connections between Unix domain sockets.
+    // Each loop listens on its own TCP socket, bound to the same port with SO_REUSEPORT option.
+    if (!listenerAddress.socketPath.empty()) {
+        auto socket = makeUnixListenerSocket(listenerAddress.socketPath);
+        listenerSockets_.push_back(socket);
+        for (auto& loop : loops_)
+            loop->addListener(socket);
+        return;
+    }
+
+    const auto reusePort = loops_.size() > 1;
+    for (auto& loop : loops_) {
+        auto socket = makeTcpListenerSocket(listenerAddress.address, listenerAddress.port, reusePort);
+        listenerSockets_.push_back(socket);
+        loop->addListener(socket);
+    }
+}
+
+void ServerImpl::closeListeners()
+{
+    for (auto listenerSocket : listenerSockets_)
+        ::close(listenerSocket);
+    listenerSockets_.clear();
+    for (const auto& listenerAddress : listenerAddresses_)
+        if (!listenerAddress.socketPath.empty())
+            ::unlink(listenerAddress.socketPath.c_str());
+}
+
+void ServerImpl::createEventLoops(int loopsNumber)
+{
+    auto loops = std::vector<std::unique_ptr<EventLoop>>{};
+    for (auto i = 0; i < loopsNumber; ++i)
+        loops.emplace_back(std::make_unique<EventLoop>(
+                requestProcessor_,
+                responderConfigurator_,
+                errorInfoHandler_,
+                responderGroup_));
+
+    auto lock = std::scoped_lock{loopsMutex_};
+    loops_ = std::move(loops);
+}
+
+void ServerImpl::setThreadsNumber(int threadsNumber)
+{
+    threadsNumber = std::max(threadsNumber, 1);
+    if (static_cast<std::size_t>(threadsNumber) == loops_.size())
+        return;
+
+    closeListeners();
+    createEventLoops(threadsNumber);
+    for (const auto& listenerAddress : listenerAddresses_)
+        addListener(listenerAddress);
+}
+
+void ServerImpl::setCpuAffinity(std::vector<int> cpuIds)
+{
+    cpuIds_ = std::move(cpuIds);
+}
+
+void ServerImpl::run()
+{
+    auto threads = std::vector<std::thread>{};
+    auto exceptions = std::vector<std::exception_ptr>(loops_.size());
+    auto runLoop = [&](std::size_t loopIndex)
+    {
+        try {
+            runEventLoop(loopIndex);
+        }
+        catch (...) {
+            exceptions[loopIndex] = std::current_exception();
+            stop();
+        }
+    };
+
+    for (auto i = std::size_t{1}; i < loops_.size(); ++i)
+        threads.emplace_back(runLoop, i);
+    runLoop(0);
+    for (auto& thread : threads)
+        thread.join();
+
+    for (auto& exception : exceptions)
+        if (exception)
+            std::rethrow_exception(exception);
+}
+
+void ServerImpl::runEventLoop(std::size_t loopIndex)
+{
+    if (!cpuIds_.empty())
+        setCurrentThreadCpu(cpuIds_[loopIndex % cpuIds_.size()]);
+    loops_[loopIndex]->run();
+}
+
+void ServerImpl::stop()
+{
+    auto lock = std::scoped_lock{loopsMutex_};
+    for (auto& loop : loops_)
+        loop->stop();
+}
+
+void ServerImpl::setResponderConfigurator(std::function<void(Responder&)> configurator)
+{
+    responderConfigurator_ = std::move(configurator);
+}
+
+void ServerImpl::setErrorInfoHandler(std::function<void(const std::string&)> errorInfoHandler)
+{
+    errorInfoHandler_ = std::move(errorInfoHandler);
+}
+
+void ServerImpl::setResponderGroup(std::shared_ptr<ResponderGroup> responderGroup)
+{
+    responderGroup_ = std::move(responderGroup);
+}
+
+std::size_t ServerImpl::connectionsNumber() const
+{
+    auto lock = std::scoped_lock{loopsMutex_};
+    auto result = std::size_t{};
+    for (const auto& loop : loops_)
+        result += loop->connectionsNumber();
+    return result;
+}
+
+} //namespace fcgi
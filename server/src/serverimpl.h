@@ -0,0 +1,57 @@
+#pragma once
+#include <fcgi_responder/request.h>
+#include <fcgi_responder/responder.h>
+#include <fcgi_responder/response.h>
+#include <fcgi_responder/respondergroup.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace fcgi {
+class EventLoop;
+
+class ServerImpl {
+public:
+    explicit ServerImpl(std::function<void(Request&& request, Response&& response)> requestProcessor);
+    ~ServerImpl();
+    ServerImpl(const ServerImpl&) = delete;
+    ServerImpl& operator=(const ServerImpl&) = delete;
+
+    void listen(const std::string& socketPath);
+    void listen(const std::string& address, std::uint16_t port);
+    void run();
+    void stop();
+    void setThreadsNumber(int threadsNumber);
+    void setCpuAffinity(std::vector<int> cpuIds);
+    void setResponderConfigurator(std::function<void(Responder&)> configurator);
+    void setErrorInfoHandler(std::function<void(const std::string&)> errorInfoHandler);
+    void setResponderGroup(std::shared_ptr<ResponderGroup> responderGroup);
+    std::size_t connectionsNumber() const;
+
+private:
+    struct ListenerAddress {
+        std::string socketPath;
+        std::string address;
+        std::uint16_t port = 0;
+    };
+    void createEventLoops(int loopsNumber);
+    void addListener(const ListenerAddress& listenerAddress);
+    void closeListeners();
+    void runEventLoop(std::size_t loopIndex);
+
+private:
+    std::function<void(Request&& request, Response&& response)> requestProcessor_;
+    std::function<void(Responder&)> responderConfigurator_;
+    std::function<void(const std::string&)> errorInfoHandler_;
+    std::shared_ptr<ResponderGroup> responderGroup_;
+    std::vector<int> cpuIds_;
+    std::vector<ListenerAddress> listenerAddresses_;
+    std::vector<int> listenerSockets_;
+    mutable std::mutex loopsMutex_;
+    std::vector<std::unique_ptr<EventLoop>> loops_;
+};
+
+} //namespace fcgi
@@ -0,0 +1,274 @@
+#include "uringconnection.h"
+#include "iouring.h"
+#include "uringoperation.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+namespace fcgi {
+
+namespace {
+constexpr auto maxSendBuffersNumber = std::size_t{64};
+} //namespace
+
+UringConnection::UringConnection(
+        IoUring& ring,
+        BufferRing& bufferRing,
+        const std::function<void(Request&&, Response&&)>& requestProcessor,
+        std::function<void(UringConnection&)> sendScheduler,
+        std::function<void(UringConnection&)> bufferWaitHandler,
+        std::function<void(UringConnection&)> closeHandler,
+        std::function<void(const std::string&)> errorInfoHandler)
+    : ring_{ring}
+    , bufferRing_{bufferRing}
+    , requestProcessor_{requestProcessor}
+    , sendScheduler_{std::move(sendScheduler)}
+    , bufferWaitHandler_{std::move(bufferWaitHandler)}
+    , closeHandler_{std::move(closeHandler)}
+    , errorInfoHandler_{std::move(errorInfoHandler)}
+{
+    if (errorInfoHandler_)
+        setErrorInfoHandler(errorInfoHandler_);
+}
+
+UringConnection::~UringConnection()
+{
+    release();
+}
+
+void UringConnection::open(std::uint64_t id, int socket, std::shared_ptr<ResponderGroup> responderGroup)
+{
+    id_ = id;
+    socket_ = socket;
+    isReceiving_ = false;
+    isReadingPaused_ = false;
+    isWaitingForBuffers_ = false;
+    isSending_ = false;
+    isSendScheduled_ = false;
+    isCloseRequested_ = false;
+    isClosed_ = false;
+    responderGroup_ = std::move(responderGroup);
+    setResponderGroup(responderGroup_);
+}
+
+void UringConnection::release()
+{
+    if (socket_ < 0)
+        return;
+
+    ::close(socket_);
+    socket_ = -1;
+    isClosed_ = true;
+    output_.clear();
+    outputSize_ = 0;
+    outputOffset_ = 0;
+    if (responderGroup_)
+        responderGroup_->releaseConnection();
+    reset();
+}
+
+std::uint64_t UringConnection::id() const
+{
+    return id_;
+}
+
+bool UringConnection::isClosed() const
+{
+    return isClosed_;
+}
+
+bool UringConnection::hasPendingOperations() const
+{
+    return pendingOperationsNumber_ > 0;
+}
+
+void UringConnection::startReceiving()
+{
+    if (isClosed_ || isReceiving_ || isReadingPaused_ || isWaitingForBuffers_)
+        return;
+
+    auto& sqe = ring_.nextSqe();
+    sqe.opcode = IORING_OP_RECV;
+    sqe.fd = socket_;
+    sqe.flags = IOSQE_BUFFER_SELECT;
+    sqe.buf_group = bufferRing_.groupId();
+    sqe.user_data = uringOperationData(UringOperation::Receive, id_);
+    isReceiving_ = true;
+    ++pendingOperationsNumber_;
+}
+
+void UringConnection::resumeReceiving()
+{
+    isWaitingForBuffers_ = false;
+    startReceiving();
+}
+
+void UringConnection::onReceived(const io_uring_cqe& cqe)
+{
+    isReceiving_ = false;
+    --pendingOperationsNumber_;
+
+    if (cqe.flags & IORING_CQE_F_BUFFER) {
+        const auto bufferId = static_cast<std::uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        if (cqe.res > 0 && !isClosed_)
+            receiveData(bufferRing_.buffer(bufferId), static_cast<std::size_t>(cqe.res));
+        bufferRing_.recycle(bufferId);
+    }
+    if (isClosed_)
+        return;
+
+    if (cqe.res == 0) {
+        close();
+        return;
+    }
+    if (cqe.res == -ENOBUFS) {
+        // all provided buffers are in use, receiving again right away would fail the same way,
+        // so it's resumed when the buffers are returned to the ring
+        isWaitingForBuffers_ = true;
+        bufferWaitHandler_(*this);
+        return;
+    }
+    if (cqe.res < 0 && cqe.res != -EINTR && cqe.res != -EAGAIN) {
+        onSocketError("recv", -cqe.res);
+        return;
+    }
+    if (isOutputQueueFull()) {
+        isReadingPaused_ = true;
+        return;
+    }
+    startReceiving();
+}
+
+void UringConnection::submitSend()
+{
+    isSendScheduled_ = false;
+    if (isClosed_ || isSending_ || output_.empty())
+        return;
+
+    sendBuffers_.clear();
+    auto offset = outputOffset_;
+    for (auto it = output_.begin(); it != output_.end() && sendBuffers_.size() < maxSendBuffersNumber; ++it) {
+        sendBuffers_.push_back({it->data() + offset, it->size() - offset});
+        offset = 0;
+    }
+    sendMessage_ = msghdr{};
+    sendMessage_.msg_iov = sendBuffers_.data();
+    sendMessage_.msg_iovlen = sendBuffers_.size();
+
+    auto& sqe = ring_.nextSqe();
+    sqe.opcode = IORING_OP_SENDMSG;
+    sqe.fd = socket_;
+    sqe.addr = reinterpret_cast<std::uint64_t>(&sendMessage_);
+    sqe.len = 1;
+    sqe.msg_flags = MSG_NOSIGNAL;
+    sqe.user_data = uringOperationData(UringOperation::Send, id_);
+    isSending_ = true;
+    ++pendingOperationsNumber_;
+}
+
+void UringConnection::onSent(const io_uring_cqe& cqe)
+{
+    isSending_ = false;
+    --pendingOperationsNumber_;
+    if (isClosed_)
+        return;
+
+    if (cqe.res < 0 && cqe.res != -EINTR && cqe.res != -EAGAIN) {
+        onSocketError("send", -cqe.res);
+        return;
+    }
+    if (cqe.res > 0)
+        removeSentOutput(static_cast<std::size_t>(cqe.res));
+
+    onWritable();
+    if (isClosed_)
+        return;
+    if (!output_.empty()) {
+        isSendScheduled_ = true;
+        sendScheduler_(*this);
+    }
+    else if (isCloseRequested_) {
+        close();
+        return;
+    }
+
+    if (isReadingPaused_ && !isOutputQueueFull()) {
+        isReadingPaused_ = false;
+        startReceiving();
+    }
+}
+
+void UringConnection::close()
+{
+    if (isClosed_)
+        return;
+    isClosed_ = true;
+    ::shutdown(socket_, SHUT_RDWR);
+    closeHandler_(*this);
+}
+
+void UringConnection::sendData(const std::string& data)
+{
+    enqueueOutput(data);
+}
+
+std::size_t UringConnection::trySendData(const std::string& data)
+{
+    if (isClosed_)
+        return data.size();
+    if (outputSize_ >= outputHighWaterMark())
+        return 0;
+
+    enqueueOutput(data);
+    return data.size();
+}
+
+void UringConnection::enqueueOutput(const std::string& data)
+{
+    if (isClosed_ || data.empty())
+        return;
+
+    output_.emplace_back(data);
+    outputSize_ += data.size();
+    if (!isSending_ && !isSendScheduled_) {
+        isSendScheduled_ = true;
+        sendScheduler_(*this);
+    }
+}
+
+void UringConnection::removeSentOutput(std::size_t sentSize)
+{
+    outputSize_ -= sentSize;
+    while (sentSize) {
+        auto& data = output_.front();
+        const auto size = std::min(sentSize, data.size() - outputOffset_);
+        outputOffset_ += size;
+        sentSize -= size;
+        if (outputOffset_ == data.size()) {
+            output_.pop_front();
+            outputOffset_ = 0;
+        }
+    }
+}
+
+void UringConnection::disconnect()
+{
+    isCloseRequested_ = true;
+    if (output_.empty() && !isSending_)
+        close();
+}
+
+void UringConnection::processRequest(Request&& request, Response&& response)
+{
+    requestProcessor_(std::move(request), std::move(response));
+}
+
+void UringConnection::onSocketError(const std::string& operation, int error)
+{
+    if (errorInfoHandler_)
+        errorInfoHandler_("Connection error on " + operation + ": " + std::strerror(error));
+    close();
+}
+
+} //namespace fcgi
@@ -0,0 +1,84 @@
+#pragma once
+#include <fcgi_responder/responder.h>
+#include <fcgi_responder/respondergroup.h>
+#include <sys/socket.h>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct io_uring_cqe;
+
+namespace fcgi {
+class IoUring;
+class BufferRing;
+
+class UringConnection : public Responder {
+public:
+    UringConnection(
+            IoUring& ring,
+            BufferRing& bufferRing,
+            const std::function<void(Request&&, Response&&)>& requestProcessor,
+            std::function<void(UringConnection&)> sendScheduler,
+            std::function<void(UringConnection&)> bufferWaitHandler,
+            std::function<void(UringConnection&)> closeHandler,
+            std::function<void(const std::string&)> errorInfoHandler);
+    ~UringConnection() override;
+    UringConnection(const UringConnection&) = delete;
+    UringConnection& operator=(const UringConnection&) = delete;
+    UringConnection(UringConnection&&) = delete;
+    UringConnection& operator=(UringConnection&&) = delete;
+
+    std::uint64_t id() const;
+    bool isClosed() const;
+    bool hasPendingOperations() const;
+    void open(std::uint64_t id, int socket, std::shared_ptr<ResponderGroup> responderGroup);
+    void release();
+    void startReceiving();
+    void resumeReceiving();
+    void submitSend();
+    void onReceived(const io_uring_cqe& cqe);
+    void onSent(const io_uring_cqe& cqe);
+    void close();
+
+private:
+    void sendData(const std::string& data) override;
+    std::size_t trySendData(const std::string& data) override;
+    void disconnect() override;
+    void processRequest(Request&& request, Response&& response) override;
+
+    void enqueueOutput(const std::string& data);
+    void removeSentOutput(std::size_t sentSize);
+    void onSocketError(const std::string& operation, int error);
+
+private:
+    std::uint64_t id_ = 0;
+    int socket_ = -1;
+    IoUring& ring_;
+    BufferRing& bufferRing_;
+    const std::function<void(Request&&, Response&&)>& requestProcessor_;
+    std::function<void(UringConnection&)> sendScheduler_;
+    std::function<void(UringConnection&)> bufferWaitHandler_;
+    std::function<void(UringConnection&)> closeHandler_;
+    std::function<void(const std::string&)> errorInfoHandler_;
+    std::shared_ptr<ResponderGroup> responderGroup_;
+
+    std::deque<std::string> output_;
+    std::size_t outputSize_ = 0;
+    std::size_t outputOffset_ = 0;
+    std::vector<iovec> sendBuffers_;
+    msghdr sendMessage_ = {};
+
+    int pendingOperationsNumber_ = 0;
+    bool isReceiving_ = false;
+    bool isReadingPaused_ = false;
+    bool isWaitingForBuffers_ = false;
+    bool isSending_ = false;
+    bool isSendScheduled_ = false;
+    bool isCloseRequested_ = false;
+    bool isClosed_ = true;
+};
+
+} //namespace fcgi
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+
+namespace fcgi {
+
+enum class UringOperation : std::uint8_t {
+    Accept,
+    Receive,
+    Send,
+    Stop
+};
+
+/// Packs the operation type and the id of its connection or listener to the io_uring user data field.
+inline std::uint64_t uringOperationData(UringOperation operation, std::uint64_t id)
+{
+    return (id << 8) | static_cast<std::uint64_t>(operation);
+}
+
+inline UringOperation uringOperation(std::uint64_t userData)
+{
+    return static_cast<UringOperation>(userData & 0xFF);
+}
+
+inline std::uint64_t uringOperationId(std::uint64_t userData)
+{
+    return userData >> 8;
+}
+
+} //namespace fcgi
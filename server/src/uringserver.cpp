@@ -0,0 +1,55 @@
+#include "uringserverimpl.h"
+#include <fcgi_responder/uringserver.h>
+
+namespace fcgi {
+
+UringServer::UringServer(std::function<void(Request&& request, Response&& response)> requestProcessor)
+    : impl_{std::make_unique<UringServerImpl>(std::move(requestProcessor))}
+{
+}
+
+UringServer::~UringServer() = default;
+UringServer::UringServer(UringServer&&) noexcept = default;
+UringServer& UringServer::operator=(UringServer&&) noexcept = default;
+
+void UringServer::listen(const std::string& socketPath)
+{
+    impl_->listen(socketPath);
+}
+
+void UringServer::listen(const std::string& address, std::uint16_t port)
+{
+    impl_->listen(address, port);
+}
+
+void UringServer::run()
+{
+    impl_->run();
+}
+
+void UringServer::stop()
+{
+    impl_->stop();
+}
+
+void UringServer::setResponderConfigurator(std::function<void(Responder&)> configurator)
+{
+    impl_->setResponderConfigurator(std::move(configurator));
+}
+
+void UringServer::setErrorInfoHandler(std::function<void(const std::string&)> errorInfoHandler)
+{
+    impl_->setErrorInfoHandler(std::move(errorInfoHandler));
+}
+
+void UringServer::setResponderGroup(std::shared_ptr<ResponderGroup> responderGroup)
+{
+    impl_->setResponderGroup(std::move(responderGroup));
+}
+
+std::size_t UringServer::connectionsNumber() const
+{
+    return impl_->connectionsNumber();
+}
+
+} //namespace fcgi
@@ -0,0 +1,260 @@
+#include "uringserverimpl.h"
+#include "listener.h"
+#include "uringconnection.h"
+#include "uringoperation.h"
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <unistd.h>
+
+namespace fcgi {
+
+namespace {
+constexpr auto ringEntriesNumber = 4096u;
+constexpr auto bufferGroupId = std::uint16_t{0};
+constexpr auto buffersNumber = std::uint16_t{512};
+constexpr auto bufferSize = std::uint32_t{16384};
+constexpr auto maxPooledConnectionsNumber = std::size_t{128};
+} //namespace
+
+UringServerImpl::UringServerImpl(std::function<void(Request&& request, Response&& response)> requestProcessor)
+    : requestProcessor_{std::move(requestProcessor)}
+    , ring_{ringEntriesNumber}
+{
+    bufferRing_ = std::make_unique<BufferRing>(ring_, bufferGroupId, buffersNumber, bufferSize);
+    stopEventFd_ = eventfd(0, EFD_CLOEXEC);
+    if (stopEventFd_ < 0)
+        throw std::system_error{errno, std::generic_category(), "eventfd"};
+    startWaitingForStop();
+}
+
+UringServerImpl::~UringServerImpl()
+{
+    for (auto listenerSocket : listenerSockets_)
+        ::close(listenerSocket);
+    for (const auto& socketPath : unixSocketPaths_)
+        ::unlink(socketPath.c_str());
+    ::close(stopEventFd_);
+}
+
+void UringServerImpl::listen(const std::string& socketPath)
+{
+    addListener(makeUnixListenerSocket(socketPath));
+    unixSocketPaths_.push_back(socketPath);
+}
+
+void UringServerImpl::listen(const std::string& address, std::uint16_t port)
+{
+    addListener(makeTcpListenerSocket(address, port));
+}
+
+void UringServerImpl::addListener(int socket)
+{
+    listenerSockets_.push_back(socket);
+    startAccepting(listenerSockets_.size() - 1);
+}
+
+void UringServerImpl::startAccepting(std::size_t listenerIndex)
+{
+    auto& sqe = ring_.nextSqe();
+    sqe.opcode = IORING_OP_ACCEPT;
+    sqe.fd = listenerSockets_[listenerIndex];
+    sqe.ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe.accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe.user_data = uringOperationData(UringOperation::Accept, listenerIndex);
+}
+
+void UringServerImpl::startWaitingForStop()
+{
+    auto& sqe = ring_.nextSqe();
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = stopEventFd_;
+    sqe.addr = reinterpret_cast<std::uint64_t>(&stopEventValue_);
+    sqe.len = sizeof(stopEventValue_);
+    sqe.user_data = uringOperationData(UringOperation::Stop, 0);
+}
+
+void UringServerImpl::run()
+{
+    isStopped_ = false;
+    while (!isStopped_) {
+        submitScheduledSends();
+        ring_.submitAndWait(1);
+        ring_.forEachCompletion(
+                [this](const io_uring_cqe& cqe)
+                {
+                    onCompletion(cqe);
+                });
+        resumeReceiving();
+        removeClosedConnections();
+    }
+    startWaitingForStop();
+}
+
+void UringServerImpl::stop()
+{
+    eventfd_write(stopEventFd_, 1);
+}
+
+void UringServerImpl::onCompletion(const io_uring_cqe& cqe)
+{
+    const auto id = uringOperationId(cqe.user_data);
+    switch (uringOperation(cqe.user_data)) {
+    case UringOperation::Accept:
+        onAccepted(static_cast<std::size_t>(id), cqe);
+        return;
+    case UringOperation::Stop:
+        isStopped_ = true;
+        return;
+    default:;
+    }
+
+    auto it = connections_.find(id);
+    if (it == connections_.end())
+        return;
+    auto& connection = *it->second;
+    if (uringOperation(cqe.user_data) == UringOperation::Receive)
+        connection.onReceived(cqe);
+    else
+        connection.onSent(cqe);
+}
+
+void UringServerImpl::onAccepted(std::size_t listenerIndex, const io_uring_cqe& cqe)
+{
+    if (!(cqe.flags & IORING_CQE_F_MORE) && cqe.res != -ECANCELED)
+        startAccepting(listenerIndex);
+
+    if (cqe.res < 0) {
+        if (cqe.res != -EINTR && cqe.res != -EAGAIN && cqe.res != -ECONNABORTED && cqe.res != -ECANCELED)
+            notifyAboutError(std::string{"Connection accepting error: "} + std::strerror(-cqe.res));
+        return;
+    }
+    if (responderGroup_ && !responderGroup_->tryAcquireConnection()) {
+        ::close(cqe.res);
+        return;
+    }
+
+    auto connectionId = ++lastConnectionId_;
+    auto connection = makeConnection();
+    connection->open(connectionId, cqe.res, responderGroup_);
+    if (responderConfigurator_)
+        responderConfigurator_(*connection);
+    auto& connectionRef = *connection;
+    connections_.emplace(connectionId, std::move(connection));
+    ++connectionsNumber_;
+    connectionRef.startReceiving();
+}
+
+std::unique_ptr<UringConnection> UringServerImpl::makeConnection()
+{
+    if (!connectionPool_.empty()) {
+        auto connection = std::move(connectionPool_.back());
+        connectionPool_.pop_back();
+        return connection;
+    }
+    return std::make_unique<UringConnection>(
+            ring_,
+            *bufferRing_,
+            requestProcessor_,
+            [this](UringConnection& connection)
+            {
+                scheduledSends_.push_back(connection.id());
+            },
+            [this](UringConnection& connection)
+            {
+                connectionsWaitingForBuffers_.push_back(connection.id());
+                recycledBuffersNumberOnWaiting_ = bufferRing_->recycledBuffersNumber();
+            },
+            [this](UringConnection& connection)
+            {
+                closedConnections_.push_back(connection.id());
+                --connectionsNumber_;
+            },
+            errorInfoHandler_);
+}
+
+void UringServerImpl::submitScheduledSends()
+{
+    // sends scheduled while processing the completions are submitted together,
+    // so each connection's records of this loop iteration are sent with one vectored write
+    for (auto connectionId : scheduledSends_) {
+        auto it = connections_.find(connectionId);
+        if (it != connections_.end())
+            it->second->submitSend();
+    }
+    scheduledSends_.clear();
+}
+
+void UringServerImpl::resumeReceiving()
+{
+    // receiving is resumed only after a buffer is recycled since the last failure caused by the ring's exhaustion,
+    // otherwise the loop would spin on the failing receive operations
+    if (connectionsWaitingForBuffers_.empty())
+        return;
+    if (bufferRing_->recycledBuffersNumber() == recycledBuffersNumberOnWaiting_)
+        return;
+
+    auto connectionIds = std::move(connectionsWaitingForBuffers_);
+    connectionsWaitingForBuffers_.clear();
+    for (auto connectionId : connectionIds) {
+        auto it = connections_.find(connectionId);
+        if (it != connections_.end())
+            it->second->resumeReceiving();
+    }
+}
+
+void UringServerImpl::removeClosedConnections()
+{
+    // connection is released after the completion of all its operations,
+    // which are cancelled by shutting down its socket,
+    // and then it's reused for the new connections, so its buffers aren't reallocated
+    auto it = std::remove_if(
+            closedConnections_.begin(),
+            closedConnections_.end(),
+            [this](std::uint64_t connectionId)
+            {
+                auto connectionIt = connections_.find(connectionId);
+                if (connectionIt == connections_.end())
+                    return true;
+                if (connectionIt->second->hasPendingOperations())
+                    return false;
+                auto connection = std::move(connectionIt->second);
+                connections_.erase(connectionIt);
+                connection->release();
+                if (connectionPool_.size() < maxPooledConnectionsNumber)
+                    connectionPool_.push_back(std::move(connection));
+                return true;
+            });
+    closedConnections_.erase(it, closedConnections_.end());
+}
+
+void UringServerImpl::setResponderConfigurator(std::function<void(Responder&)> configurator)
+{
+    responderConfigurator_ = std::move(configurator);
+}
+
+void UringServerImpl::setErrorInfoHandler(std::function<void(const std::string&)> errorInfoHandler)
+{
+    errorInfoHandler_ = std::move(errorInfoHandler);
+}
+
+void UringServerImpl::setResponderGroup(std::shared_ptr<ResponderGroup> responderGroup)
+{
+    responderGroup_ = std::move(responderGroup);
+}
+
+std::size_t UringServerImpl::connectionsNumber() const
+{
+    return connectionsNumber_;
+}
+
+void UringServerImpl::notifyAboutError(const std::string& errorMsg)
+{
+    if (errorInfoHandler_)
+        errorInfoHandler_(errorMsg);
+}
+
+} //namespace fcgi
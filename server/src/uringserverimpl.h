@@ -0,0 +1,69 @@
+#pragma once
+#include "iouring.h"
+#include <fcgi_responder/request.h>
+#include <fcgi_responder/responder.h>
+#include <fcgi_responder/response.h>
+#include <fcgi_responder/respondergroup.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fcgi {
+class UringConnection;
+
+class UringServerImpl {
+public:
+    explicit UringServerImpl(std::function<void(Request&& request, Response&& response)> requestProcessor);
+    ~UringServerImpl();
+    UringServerImpl(const UringServerImpl&) = delete;
+    UringServerImpl& operator=(const UringServerImpl&) = delete;
+
+    void listen(const std::string& socketPath);
+    void listen(const std::string& address, std::uint16_t port);
+    void run();
+    void stop();
+    void setResponderConfigurator(std::function<void(Responder&)> configurator);
+    void setErrorInfoHandler(std::function<void(const std::string&)> errorInfoHandler);
+    void setResponderGroup(std::shared_ptr<ResponderGroup> responderGroup);
+    std::size_t connectionsNumber() const;
+
+private:
+    void addListener(int socket);
+    void startAccepting(std::size_t listenerIndex);
+    void startWaitingForStop();
+    void onCompletion(const io_uring_cqe& cqe);
+    void onAccepted(std::size_t listenerIndex, const io_uring_cqe& cqe);
+    std::unique_ptr<UringConnection> makeConnection();
+    void submitScheduledSends();
+    void resumeReceiving();
+    void removeClosedConnections();
+    void notifyAboutError(const std::string& errorMsg);
+
+private:
+    std::function<void(Request&& request, Response&& response)> requestProcessor_;
+    std::function<void(Responder&)> responderConfigurator_;
+    std::function<void(const std::string&)> errorInfoHandler_;
+    std::shared_ptr<ResponderGroup> responderGroup_;
+    int stopEventFd_ = -1;
+    std::uint64_t stopEventValue_ = 0;
+    bool isStopped_ = false;
+    std::vector<int> listenerSockets_;
+    std::vector<std::string> unixSocketPaths_;
+    std::uint64_t lastConnectionId_ = 0;
+    std::unordered_map<std::uint64_t, std::unique_ptr<UringConnection>> connections_;
+    std::vector<std::uint64_t> scheduledSends_;
+    std::vector<std::uint64_t> connectionsWaitingForBuffers_;
+    std::uint64_t recycledBuffersNumberOnWaiting_ = 0;
+    std::vector<std::uint64_t> closedConnections_;
+    std::vector<std::unique_ptr<UringConnection>> connectionPool_;
+    std::atomic<std::size_t> connectionsNumber_ = 0;
+    // the ring is declared last, so it's closed before the memory used by its operations is released
+    std::unique_ptr<BufferRing> bufferRing_;
+    IoUring ring_;
+};
+
+} //namespace fcgi
@@ -0,0 +1,19 @@
+#include "responderimpl.h"
+#include <fcgi_responder/authorizer.h>
+
+namespace fcgi {
+
+Authorizer::Authorizer()
+{
+    impl().setAuthorizeRequestHandler(
+            [this](Request&& request, AuthorizerResponse&& response)
+            {
+                authorizeRequest(std::move(request), std::move(response));
+            });
+}
+
+void Authorizer::processRequest(Request&&, Response&&)
+{
+}
+
+} //namespace fcgi
@@ -0,0 +1,112 @@
+#include "cancellationtoken.h"
+#include <fcgi_responder/authorizerresponse.h>
+
+namespace fcgi {
+
+namespace {
+std::string_view statusLine(int httpStatus)
+{
+    switch (httpStatus) {
+    case 200:
+        return "Status: 200 OK\r\n";
+    case 302:
+        return "Status: 302 Found\r\n";
+    case 400:
+        return "Status: 400 Bad Request\r\n";
+    case 401:
+        return "Status: 401 Unauthorized\r\n";
+    case 403:
+        return "Status: 403 Forbidden\r\n";
+    case 404:
+        return "Status: 404 Not Found\r\n";
+    case 429:
+        return "Status: 429 Too Many Requests\r\n";
+    case 500:
+        return "Status: 500 Internal Server Error\r\n";
+    case 503:
+        return "Status: 503 Service Unavailable\r\n";
+    default:
+        return {};
+    }
+}
+
+void appendHeader(std::string& headers, std::string_view prefix, std::string_view name, std::string_view value)
+{
+    headers.append(prefix).append(name).append(": ").append(value).append("\r\n");
+}
+} //namespace
+
+AuthorizerResponse::AuthorizerResponse(ResponseSender sender, std::shared_ptr<CancellationToken> cancellationToken)
+    : sender_{std::move(sender)}
+    , cancellationToken_{std::move(cancellationToken)}
+{
+}
+
+void AuthorizerResponse::allow()
+{
+    status_ = 200;
+}
+
+void AuthorizerResponse::deny(int httpStatus)
+{
+    status_ = httpStatus;
+}
+
+void AuthorizerResponse::setVariable(std::string_view name, std::string_view value)
+{
+    appendHeader(headers_, "Variable-", name, value);
+}
+
+void AuthorizerResponse::setHeader(std::string_view name, std::string_view value)
+{
+    appendHeader(headers_, {}, name, value);
+}
+
+void AuthorizerResponse::send()
+{
+    if (!sender_)
+        return;
+    if (isCancelled()) {
+        sender_ = ResponseSender{};
+        return;
+    }
+
+    auto status = statusLine(status_);
+    auto data = std::string{};
+    if (status.empty()) {
+        data = "Status: " + std::to_string(status_) + "\r\n";
+        data.reserve(data.size() + headers_.size() + 2);
+    }
+    else {
+        data.reserve(status.size() + headers_.size() + 2);
+        data.append(status);
+    }
+    data.append(headers_).append("\r\n");
+    sender_(std::move(data));
+
+    //set empty sender, so response can be sent only once
+    sender_ = ResponseSender{};
+    headers_.clear();
+}
+
+bool AuthorizerResponse::isValid() const
+{
+    return sender_ && !isCancelled();
+}
+
+bool AuthorizerResponse::isCancelled() const
+{
+    return fcgi::isCancelled(cancellationToken_);
+}
+
+void AuthorizerResponse::setCancellationHandler(std::function<void()> handler)
+{
+    fcgi::setCancellationHandler(cancellationToken_, std::move(handler));
+}
+
+AuthorizerResponse::operator bool() const
+{
+    return isValid();
+}
+
+} //namespace fcgi
@@ -0,0 +1,46 @@
+#include "cancellationtoken.h"
+#include <utility>
+
+namespace fcgi {
+
+bool CancellationToken::isCancelled() const
+{
+    return isCancelled_.load(std::memory_order_acquire);
+}
+
+void CancellationToken::setCancellationHandler(std::function<void()> handler)
+{
+    auto lock = std::unique_lock{mutex_};
+    if (!isCancelled()) {
+        cancellationHandler_ = std::move(handler);
+        return;
+    }
+    lock.unlock();
+    if (handler)
+        handler();
+}
+
+void CancellationToken::cancel()
+{
+    auto lock = std::unique_lock{mutex_};
+    if (isCancelled())
+        return;
+    isCancelled_.store(true, std::memory_order_release);
+    auto handler = std::exchange(cancellationHandler_, nullptr);
+    lock.unlock();
+    if (handler)
+        handler();
+}
+
+bool isCancelled(const std::shared_ptr<CancellationToken>& token)
+{
+    return token && token->isCancelled();
+}
+
+void setCancellationHandler(const std::shared_ptr<CancellationToken>& token, std::function<void()> handler)
+{
+    if (token)
+        token->setCancellationHandler(std::move(handler));
+}
+
+} //namespace fcgi
@@ -0,0 +1,30 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace fcgi {
+
+///
+/// State of a request shared by the Responder and the response object passed to the application.
+/// The request is cancelled by the Responder's thread, the state can be checked and the handler
+/// can be set from any thread.
+///
+class CancellationToken {
+public:
+    bool isCancelled() const;
+    void setCancellationHandler(std::function<void()> handler);
+    void cancel();
+
+private:
+    std::atomic<bool> isCancelled_{false};
+    std::mutex mutex_;
+    std::function<void()> cancellationHandler_;
+};
+
+// Forwarding used by the response objects, which don't have a token when they're created without a request
+bool isCancelled(const std::shared_ptr<CancellationToken>& token);
+void setCancellationHandler(const std::shared_ptr<CancellationToken>& token, std::function<void()> handler);
+
+} //namespace fcgi
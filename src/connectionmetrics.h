@@ -0,0 +1,149 @@
+#pragma once
+#include "types.h"
+#include <fcgi_responder/errorevent.h>
+#include <fcgi_responder/metrics.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace fcgi {
+
+class ConnectionMetricsCounters {
+public:
+    void addTo(MetricsSnapshot& snapshot, bool withGauges) const;
+
+    std::array<std::atomic<std::uint64_t>, MetricsSnapshot::recordTypesNumber> receivedRecords{};
+    std::array<std::atomic<std::uint64_t>, MetricsSnapshot::recordTypesNumber> sentRecords{};
+    std::atomic<std::uint64_t> receivedBytes{0};
+    std::atomic<std::uint64_t> sentBytes{0};
+    std::atomic<std::uint64_t> startedRequests{0};
+    std::atomic<std::uint64_t> abortedRequests{0};
+    std::array<std::atomic<std::uint64_t>, MetricsSnapshot::protocolStatusesNumber> endedRequests{};
+    std::array<std::atomic<std::uint64_t>, MetricsSnapshot::decodeErrorsNumber> decodeErrors{};
+    std::atomic<std::uint64_t> activeRequests{0};
+    std::atomic<std::uint64_t> bufferedBytes{0};
+};
+
+///
+/// Counters of a single connection, updated only by the thread of its Responder or Requester.
+/// All methods do nothing when the Metrics object isn't set.
+///
+class ConnectionMetrics {
+public:
+    ConnectionMetrics() = default;
+    ~ConnectionMetrics();
+    ConnectionMetrics(const ConnectionMetrics&) = delete;
+    ConnectionMetrics& operator=(const ConnectionMetrics&) = delete;
+
+    void setMetrics(std::shared_ptr<Metrics> metrics);
+    bool isEnabled() const
+    {
+        return counters_ != nullptr;
+    }
+
+    // a closed connection isn't counted by the Metrics object until its Responder serves a new one
+    void detach();
+    void attach()
+    {
+        if (metrics_ && !counters_)
+            attachCounters();
+    }
+
+    void onDataReceived(std::size_t size)
+    {
+        if (counters_)
+            increase(counters_->receivedBytes, size);
+    }
+
+    void onDataSent(std::size_t size)
+    {
+        if (counters_)
+            increase(counters_->sentBytes, size);
+    }
+
+    void onRecordReceived(RecordType type)
+    {
+        if (counters_)
+            increase(counters_->receivedRecords[static_cast<std::size_t>(type)]);
+    }
+
+    void onRecordSent(RecordType type)
+    {
+        if (counters_)
+            increase(counters_->sentRecords[static_cast<std::size_t>(type)]);
+    }
+
+    void onRequestStarted()
+    {
+        if (counters_)
+            increase(counters_->startedRequests);
+    }
+
+    void onRequestAborted()
+    {
+        if (counters_)
+            increase(counters_->abortedRequests);
+    }
+
+    void onRequestEnded(ProtocolStatus status)
+    {
+        if (counters_)
+            increase(counters_->endedRequests[static_cast<std::size_t>(status)]);
+    }
+
+    void onError(const ErrorEvent& event)
+    {
+        if (!counters_)
+            return;
+        switch (event.code) {
+        case ErrorCode::UnexpectedRecord:
+            increase(decodeErrors(MetricsSnapshot::DecodeError::UnexpectedRecord));
+            break;
+        case ErrorCode::InvalidRecordType:
+            increase(decodeErrors(MetricsSnapshot::DecodeError::InvalidRecordType));
+            break;
+        case ErrorCode::UnsupportedVersion:
+            increase(decodeErrors(MetricsSnapshot::DecodeError::UnsupportedVersion));
+            break;
+        case ErrorCode::MalformedRecord:
+            increase(decodeErrors(MetricsSnapshot::DecodeError::MalformedRecord));
+            break;
+        case ErrorCode::InvalidRecord:
+            increase(decodeErrors(MetricsSnapshot::DecodeError::Other));
+            break;
+        default:;
+        }
+    }
+
+    void setActiveRequestsNumber(std::size_t value)
+    {
+        if (counters_)
+            counters_->activeRequests.store(value, std::memory_order_relaxed);
+    }
+
+    void setBufferedBytes(std::size_t value)
+    {
+        if (counters_)
+            counters_->bufferedBytes.store(value, std::memory_order_relaxed);
+    }
+
+private:
+    void attachCounters();
+    std::atomic<std::uint64_t>& decodeErrors(MetricsSnapshot::DecodeError error)
+    {
+        return counters_->decodeErrors[static_cast<std::size_t>(error)];
+    }
+
+    // the counters have a single writer, so the increment doesn't need an atomic read-modify-write operation
+    static void increase(std::atomic<std::uint64_t>& counter, std::uint64_t value = 1)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+private:
+    std::shared_ptr<Metrics> metrics_;
+    std::unique_ptr<ConnectionMetricsCounters> counters_;
+};
+
+} //namespace fcgi
@@ -2,11 +2,18 @@
 
 namespace fcgi {
 
-DataWriterBuffer::DataWriterBuffer(std::size_t bufferMaxSize)
+namespace {
+struct ThreadLocalStream {
+    DataWriterStream stream;
+    bool isInUse = false;
+};
+
+ThreadLocalStream& threadLocalStream()
 {
-    buffer_.resize(bufferMaxSize);
-    setp(buffer_.data(), buffer_.data() + buffer_.size());
+    thread_local ThreadLocalStream threadLocalStream;
+    return threadLocalStream;
 }
+} //namespace
 
 const std::string& DataWriterBuffer::data() const
 {
@@ -19,9 +26,8 @@ void DataWriterBuffer::reset(std::size_t size)
     setp(buffer_.data(), buffer_.data() + buffer_.size());
 }
 
-DataWriterStream::DataWriterStream(std::size_t bufferMaxSize)
-    : DataWriterBuffer{bufferMaxSize}
-    , std::ostream{this}
+DataWriterStream::DataWriterStream()
+    : std::ostream{this}
 {
 }
 
@@ -33,6 +39,26 @@ const std::string& DataWriterStream::buffer() const
 void DataWriterStream::resetBuffer(std::size_t size)
 {
     DataWriterBuffer::reset(size);
+    clear();
+}
+
+ScratchDataWriterStream::ScratchDataWriterStream(DataWriterStream& ownStream, bool isThreadLocalStreamEnabled)
+    : stream_{isThreadLocalStreamEnabled && !threadLocalStream().isInUse ? threadLocalStream().stream : ownStream}
+    , isThreadLocalStreamUsed_{&stream_ == &threadLocalStream().stream}
+{
+    if (isThreadLocalStreamUsed_)
+        threadLocalStream().isInUse = true;
+}
+
+ScratchDataWriterStream::~ScratchDataWriterStream()
+{
+    if (isThreadLocalStreamUsed_)
+        threadLocalStream().isInUse = false;
+}
+
+DataWriterStream& ScratchDataWriterStream::get()
+{
+    return stream_;
 }
 
 } //namespace fcgi
@@ -6,7 +6,7 @@ namespace fcgi {
 
 class DataWriterBuffer : public std::streambuf {
 public:
-    explicit DataWriterBuffer(std::size_t bufferMaxSize);
+    DataWriterBuffer() = default;
     const std::string& data() const;
     void reset(std::size_t size);
 
@@ -17,9 +17,27 @@ private:
 class DataWriterStream : private DataWriterBuffer,
                          public std::ostream {
 public:
-    explicit DataWriterStream(std::size_t bufferMaxSize);
+    DataWriterStream();
     const std::string& buffer() const;
     void resetBuffer(std::size_t size);
 };
 
+///
+/// Lends the DataWriterStream shared by all connections of the current thread for writing a single record.
+/// Sending of the written data can lead to writing another record on the same thread (e.g. when Requester and
+/// Responder are connected directly), in that case the connection's own stream is used instead.
+///
+class ScratchDataWriterStream {
+public:
+    ScratchDataWriterStream(DataWriterStream& ownStream, bool isThreadLocalStreamEnabled);
+    ~ScratchDataWriterStream();
+    ScratchDataWriterStream(const ScratchDataWriterStream&) = delete;
+    ScratchDataWriterStream& operator=(const ScratchDataWriterStream&) = delete;
+    DataWriterStream& get();
+
+private:
+    DataWriterStream& stream_;
+    bool isThreadLocalStreamUsed_ = false;
+};
+
 } //namespace fcgi
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include <fcgi_responder/errorevent.h>
+#include <utility>
+
+namespace fcgi {
+
+std::string toString(const ErrorEvent& event)
+{
+    switch (event.code) {
+    case ErrorCode::UnexpectedRecord:
+        return "Received unexpected record, RecordType = " + std::to_string(event.recordType) +
+                ", requestId = " + std::to_string(event.requestId);
+    case ErrorCode::InvalidRecordType:
+        return "Record type \"" + std::to_string(event.detail) + "\" is invalid.";
+    case ErrorCode::UnsupportedVersion:
+        return "Protocol version \"" + std::to_string(event.detail) + "\" isn't supported.";
+    case ErrorCode::MalformedRecord:
+    case ErrorCode::InvalidRecord:
+    case ErrorCode::RecordSerializationError:
+        return std::string{event.description};
+    case ErrorCode::RequestDataSizeExceeded:
+        return "Request data size limit exceeded, requestId = " + std::to_string(event.requestId);
+    case ErrorCode::FileReadError:
+        return "Can't read response data from file descriptor " + std::to_string(static_cast<int>(event.detail)) +
+                ", closing the connection";
+    case ErrorCode::ConnectionInitializationCancelled:
+        return "Connection initialization cancelled";
+    case ErrorCode::MaximumRequestsNumberReached:
+        return "Maximum requests number reached";
+    case ErrorCode::InvalidMaxReqsValue:
+        return "Invalid value for MaxReqs: " + std::string{event.description};
+    case ErrorCode::InvalidMpxsConnsValue:
+        return "Invalid value for MpxsConns: " + std::string{event.description};
+    case ErrorCode::UnknownTypeReceived:
+        return "Received unknown record type: " + std::to_string(event.detail);
+    case ErrorCode::RequestTimeout:
+        return "Request timeout, requestId = " + std::to_string(event.requestId);
+    }
+    return {};
+}
+
+ErrorEventAggregator::ErrorEventAggregator(
+        std::function<void(const ErrorEvent&, std::uint64_t)> handler,
+        std::chrono::steady_clock::duration interval)
+    : handler_{std::move(handler)}
+    , interval_{interval}
+{
+}
+
+void ErrorEventAggregator::operator()(const ErrorEvent& event)
+{
+    auto& state = codeStates_.at(static_cast<std::size_t>(event.code));
+    const auto now = std::chrono::steady_clock::now();
+    if (state.isReported && now - state.lastReportTime < interval_) {
+        ++state.suppressedEventsNumber;
+        state.lastSuppressedEvent = event;
+        state.lastSuppressedEvent.description = {};
+        return;
+    }
+    state.isReported = true;
+    state.lastReportTime = now;
+    handler_(event, std::exchange(state.suppressedEventsNumber, 0));
+}
+
+void ErrorEventAggregator::flush()
+{
+    for (auto& state : codeStates_)
+        if (state.suppressedEventsNumber)
+            handler_(state.lastSuppressedEvent, std::exchange(state.suppressedEventsNumber, 0));
+}
+
+} //namespace fcgi
@@ -3,24 +3,21 @@
 
 namespace fcgi {
 
-ProtocolError::ProtocolError(const std::string& msg)
-    : std::runtime_error{msg}
-{
-}
-
-UnsupportedVersion::UnsupportedVersion(std::uint8_t protocolVersion)
-    : ProtocolError{"Protocol version \"" + std::to_string(protocolVersion) + "\" isn't supported."}
-    , protocolVersion_{protocolVersion}
-{
-}
+namespace {
 
-std::uint8_t UnsupportedVersion::protocolVersion() const
+template<typename TMakeMessage>
+const char* lazyMessage(std::string& msg, TMakeMessage makeMessage) noexcept
 {
-    return protocolVersion_;
+    try {
+        if (msg.empty())
+            msg = makeMessage();
+    }
+    catch (...) {
+        return "Protocol error";
+    }
+    return msg.c_str();
 }
 
-namespace {
-
 std::string invalidValueTypeToString(InvalidValueType type)
 {
     switch (type) {
@@ -38,11 +35,36 @@ std::string invalidValueTypeToString(InvalidValueType type)
 
 } //namespace
 
+ProtocolError::ProtocolError(const std::string& msg)
+    : std::runtime_error{msg}
+{
+}
+
+UnsupportedVersion::UnsupportedVersion(std::uint8_t protocolVersion)
+    : ProtocolError{""}
+    , protocolVersion_{protocolVersion}
+{
+}
+
+std::uint8_t UnsupportedVersion::protocolVersion() const
+{
+    return protocolVersion_;
+}
+
+const char* UnsupportedVersion::what() const noexcept
+{
+    return lazyMessage(
+            msg_,
+            [this]
+            {
+                return "Protocol version \"" + std::to_string(protocolVersion_) + "\" isn't supported.";
+            });
+}
+
 InvalidValue::InvalidValue(InvalidValueType type, std::uint32_t value)
     : ProtocolError{""}
     , type_{type}
     , value_{value}
-    , msg_{invalidValueTypeToString(type_) + " value \"" + asString() + "\" is invalid."}
 {
 }
 
@@ -50,7 +72,6 @@ InvalidValue::InvalidValue(InvalidValueType type, const std::string& value)
     : ProtocolError{""}
     , type_{type}
     , value_{value}
-    , msg_{invalidValueTypeToString(type_) + " value \"" + asString() + "\" is invalid."}
 {
 }
 
@@ -74,7 +95,12 @@ std::string InvalidValue::asString() const
 
 const char* InvalidValue::what() const noexcept
 {
-    return msg_.c_str();
+    return lazyMessage(
+            msg_,
+            [this]
+            {
+                return invalidValueTypeToString(type_) + " value \"" + asString() + "\" is invalid.";
+            });
 }
 
 RecordMessageReadError::RecordMessageReadError(const std::string& msg, std::size_t recordSize)
@@ -89,7 +115,7 @@ std::size_t RecordMessageReadError::recordSize() const
 }
 
 InvalidRecordType::InvalidRecordType(std::uint8_t typeValue)
-    : ProtocolError{"Record type \"" + std::to_string(typeValue) + "\" is invalid."}
+    : ProtocolError{""}
     , typeValue_{typeValue}
 {
 }
@@ -99,4 +125,14 @@ std::uint8_t InvalidRecordType::recordType() const
     return typeValue_;
 }
 
+const char* InvalidRecordType::what() const noexcept
+{
+    return lazyMessage(
+            msg_,
+            [this]
+            {
+                return "Record type \"" + std::to_string(typeValue_) + "\" is invalid.";
+            });
+}
+
 } //namespace fcgi
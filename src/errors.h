@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
 #include <stdexcept>
+#include <string>
 #include <variant>
 
 namespace fcgi {
@@ -15,8 +16,11 @@ public:
     explicit UnsupportedVersion(std::uint8_t protocolVersion);
     std::uint8_t protocolVersion() const;
 
+    const char* what() const noexcept override;
+
 private:
     std::uint8_t protocolVersion_;
+    mutable std::string msg_;
 };
 
 enum class InvalidValueType {
@@ -39,7 +43,8 @@ public:
 private:
     InvalidValueType type_;
     std::variant<std::uint32_t, std::string> value_;
-    std::string msg_;
+    // the message is created on demand, as the exception is often handled without it
+    mutable std::string msg_;
 };
 
 class RecordMessageReadError : public ProtocolError {
@@ -56,8 +61,11 @@ public:
     explicit InvalidRecordType(std::uint8_t recordType);
     std::uint8_t recordType() const;
 
+    const char* what() const noexcept override;
+
 private:
     std::uint8_t typeValue_;
+    mutable std::string msg_;
 };
 
 } //namespace fcgi
@@ -0,0 +1,43 @@
+#include "filereader.h"
+#include <fcgi_responder/response.h>
+#ifdef _WIN32
+#include <cstdio>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fcgi {
+
+namespace {
+long long readFileChunk(int fileDescriptor, char* buffer, std::size_t size, std::size_t offset)
+{
+#ifdef _WIN32
+    if (_lseeki64(fileDescriptor, static_cast<long long>(offset), SEEK_SET) < 0)
+        return -1;
+    return _read(fileDescriptor, buffer, static_cast<unsigned int>(size));
+#else
+    return pread(fileDescriptor, buffer, size, static_cast<off_t>(offset));
+#endif
+}
+} //namespace
+
+std::optional<std::string> readFileRegion(const FileRegion& fileRegion)
+{
+    auto result = std::string{};
+    result.resize(fileRegion.size);
+    auto readBytes = std::size_t{};
+    while (readBytes < fileRegion.size) {
+        auto chunkSize = readFileChunk(
+                fileRegion.fileDescriptor,
+                &result[readBytes],
+                fileRegion.size - readBytes,
+                fileRegion.offset + readBytes);
+        if (chunkSize <= 0)
+            return std::nullopt;
+        readBytes += static_cast<std::size_t>(chunkSize);
+    }
+    return result;
+}
+
+} //namespace fcgi
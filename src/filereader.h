@@ -0,0 +1,10 @@
+#pragma once
+#include <optional>
+#include <string>
+
+namespace fcgi {
+struct FileRegion;
+
+std::optional<std::string> readFileRegion(const FileRegion& fileRegion);
+
+} //namespace fcgi
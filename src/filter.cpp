@@ -0,0 +1,19 @@
+#include "responderimpl.h"
+#include <fcgi_responder/filter.h>
+
+namespace fcgi {
+
+Filter::Filter()
+{
+    impl().setFilterRequestHandler(
+            [this](Request&& request, FilterOutput&& output)
+            {
+                return processFilterRequest(std::move(request), std::move(output));
+            });
+}
+
+void Filter::processRequest(Request&&, Response&&)
+{
+}
+
+} //namespace fcgi
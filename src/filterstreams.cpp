@@ -0,0 +1,57 @@
+#include "cancellationtoken.h"
+#include <fcgi_responder/filterstreams.h>
+#include <utility>
+
+namespace fcgi {
+
+FilterOutput::FilterOutput(OutputSender sender, std::shared_ptr<CancellationToken> cancellationToken)
+    : sender_{std::move(sender)}
+    , cancellationToken_{std::move(cancellationToken)}
+{
+}
+
+void FilterOutput::write(std::string_view data)
+{
+    if (!isValid() || data.empty())
+        return;
+    sender_(data, {}, false);
+}
+
+void FilterOutput::writeError(std::string_view errorData)
+{
+    if (!isValid() || errorData.empty())
+        return;
+    sender_({}, errorData, false);
+}
+
+void FilterOutput::end()
+{
+    if (!isValid())
+        return;
+    //set empty sender, so output can be ended only once,
+    //ending the request can destroy this object if it's owned by the request's input handlers
+    auto sender = std::exchange(sender_, OutputSender{});
+    sender({}, {}, true);
+}
+
+bool FilterOutput::isValid() const
+{
+    return sender_ && !isCancelled();
+}
+
+bool FilterOutput::isCancelled() const
+{
+    return fcgi::isCancelled(cancellationToken_);
+}
+
+void FilterOutput::setCancellationHandler(std::function<void()> handler)
+{
+    fcgi::setCancellationHandler(cancellationToken_, std::move(handler));
+}
+
+FilterOutput::operator bool() const
+{
+    return isValid();
+}
+
+} //namespace fcgi
@@ -0,0 +1,248 @@
+#include "connectionmetrics.h"
+#include <fcgi_responder/metrics.h>
+
+namespace fcgi {
+
+namespace {
+template<typename TCounters>
+void addCounters(std::uint64_t& value, const TCounters& counters)
+{
+    value += counters.load(std::memory_order_relaxed);
+}
+
+template<typename TCounters, std::size_t size>
+void addCounters(std::array<std::uint64_t, size>& values, const std::array<TCounters, size>& counters)
+{
+    for (auto i = std::size_t{}; i < size; ++i)
+        values[i] += counters[i].load(std::memory_order_relaxed);
+}
+
+const char* recordTypeName(std::size_t type)
+{
+    switch (static_cast<RecordType>(type)) {
+    case RecordType::BeginRequest:
+        return "BEGIN_REQUEST";
+    case RecordType::AbortRequest:
+        return "ABORT_REQUEST";
+    case RecordType::EndRequest:
+        return "END_REQUEST";
+    case RecordType::Params:
+        return "PARAMS";
+    case RecordType::StdIn:
+        return "STDIN";
+    case RecordType::StdOut:
+        return "STDOUT";
+    case RecordType::StdErr:
+        return "STDERR";
+    case RecordType::Data:
+        return "DATA";
+    case RecordType::GetValues:
+        return "GET_VALUES";
+    case RecordType::GetValuesResult:
+        return "GET_VALUES_RESULT";
+    case RecordType::UnknownType:
+        return "UNKNOWN_TYPE";
+    }
+    return "";
+}
+
+const char* protocolStatusName(std::size_t status)
+{
+    switch (static_cast<ProtocolStatus>(status)) {
+    case ProtocolStatus::RequestComplete:
+        return "REQUEST_COMPLETE";
+    case ProtocolStatus::CantMpxConn:
+        return "CANT_MPX_CONN";
+    case ProtocolStatus::Overloaded:
+        return "OVERLOADED";
+    case ProtocolStatus::UnknownRole:
+        return "UNKNOWN_ROLE";
+    }
+    return "";
+}
+
+const char* decodeErrorName(std::size_t error)
+{
+    switch (static_cast<MetricsSnapshot::DecodeError>(error)) {
+    case MetricsSnapshot::DecodeError::UnsupportedVersion:
+        return "unsupported_version";
+    case MetricsSnapshot::DecodeError::InvalidRecordType:
+        return "invalid_record_type";
+    case MetricsSnapshot::DecodeError::MalformedRecord:
+        return "malformed_record";
+    case MetricsSnapshot::DecodeError::UnexpectedRecord:
+        return "unexpected_record";
+    case MetricsSnapshot::DecodeError::Other:
+        return "other";
+    }
+    return "";
+}
+
+void writeMetricHeader(std::string& text, const std::string& name, const char* type, const char* help)
+{
+    text += "# HELP " + name + " " + help + "\n";
+    text += "# TYPE " + name + " " + type + "\n";
+}
+
+void writeMetric(std::string& text, const std::string& name, std::uint64_t value, const char* type, const char* help)
+{
+    writeMetricHeader(text, name, type, help);
+    text += name + " " + std::to_string(value) + "\n";
+}
+
+template<std::size_t size>
+void writeLabeledMetric(
+        std::string& text,
+        const std::string& name,
+        const std::array<std::uint64_t, size>& values,
+        std::size_t firstIndex,
+        const char* label,
+        const char* (*labelValue)(std::size_t),
+        const char* help)
+{
+    writeMetricHeader(text, name, "counter", help);
+    for (auto i = firstIndex; i < size; ++i)
+        text += name + "{" + label + "=\"" + labelValue(i) + "\"} " + std::to_string(values[i]) + "\n";
+}
+
+} //namespace
+
+void ConnectionMetricsCounters::addTo(MetricsSnapshot& snapshot, bool withGauges) const
+{
+    addCounters(snapshot.receivedRecords, receivedRecords);
+    addCounters(snapshot.sentRecords, sentRecords);
+    addCounters(snapshot.receivedBytes, receivedBytes);
+    addCounters(snapshot.sentBytes, sentBytes);
+    addCounters(snapshot.startedRequests, startedRequests);
+    addCounters(snapshot.abortedRequests, abortedRequests);
+    addCounters(snapshot.endedRequests, endedRequests);
+    addCounters(snapshot.decodeErrors, decodeErrors);
+    if (!withGauges)
+        return;
+    addCounters(snapshot.activeRequests, activeRequests);
+    addCounters(snapshot.bufferedBytes, bufferedBytes);
+}
+
+ConnectionMetrics::~ConnectionMetrics()
+{
+    setMetrics(nullptr);
+}
+
+void ConnectionMetrics::setMetrics(std::shared_ptr<Metrics> metrics)
+{
+    detach();
+    metrics_ = std::move(metrics);
+    attach();
+}
+
+void ConnectionMetrics::detach()
+{
+    if (!counters_)
+        return;
+    metrics_->detachConnection(counters_.get());
+    counters_.reset();
+}
+
+void ConnectionMetrics::attachCounters()
+{
+    counters_ = std::make_unique<ConnectionMetricsCounters>();
+    metrics_->attachConnection(counters_.get());
+}
+
+Metrics::Metrics() = default;
+Metrics::~Metrics() = default;
+
+MetricsSnapshot Metrics::snapshot() const
+{
+    auto lock = std::lock_guard{mutex_};
+    auto result = detachedConnectionsTotals_;
+    for (auto counters : connections_)
+        counters->addTo(result, true);
+    result.connections = connections_.size();
+    return result;
+}
+
+void Metrics::attachConnection(const ConnectionMetricsCounters* counters)
+{
+    auto lock = std::lock_guard{mutex_};
+    connections_.insert(counters);
+}
+
+void Metrics::detachConnection(const ConnectionMetricsCounters* counters)
+{
+    auto lock = std::lock_guard{mutex_};
+    counters->addTo(detachedConnectionsTotals_, false);
+    connections_.erase(counters);
+}
+
+std::string toPrometheusText(const MetricsSnapshot& snapshot, const std::string& prefix)
+{
+    auto text = std::string{};
+    writeLabeledMetric(
+            text,
+            prefix + "_records_received_total",
+            snapshot.receivedRecords,
+            1,
+            "type",
+            recordTypeName,
+            "Number of the received FastCGI records.");
+    writeLabeledMetric(
+            text,
+            prefix + "_records_sent_total",
+            snapshot.sentRecords,
+            1,
+            "type",
+            recordTypeName,
+            "Number of the sent FastCGI records.");
+    writeMetric(
+            text,
+            prefix + "_received_bytes_total",
+            snapshot.receivedBytes,
+            "counter",
+            "Size of the received data.");
+    writeMetric(text, prefix + "_sent_bytes_total", snapshot.sentBytes, "counter", "Size of the sent data.");
+    writeMetric(
+            text,
+            prefix + "_requests_started_total",
+            snapshot.startedRequests,
+            "counter",
+            "Number of the started requests.");
+    writeMetric(
+            text,
+            prefix + "_requests_aborted_total",
+            snapshot.abortedRequests,
+            "counter",
+            "Number of the aborted requests.");
+    writeLabeledMetric(
+            text,
+            prefix + "_requests_ended_total",
+            snapshot.endedRequests,
+            0,
+            "status",
+            protocolStatusName,
+            "Number of the requests ended with the FCGI_END_REQUEST record.");
+    writeLabeledMetric(
+            text,
+            prefix + "_decode_errors_total",
+            snapshot.decodeErrors,
+            0,
+            "kind",
+            decodeErrorName,
+            "Number of the received records that couldn't be processed.");
+    writeMetric(text, prefix + "_connections", snapshot.connections, "gauge", "Number of the connections.");
+    writeMetric(
+            text,
+            prefix + "_active_requests",
+            snapshot.activeRequests,
+            "gauge",
+            "Number of the requests in progress.");
+    writeMetric(
+            text,
+            prefix + "_buffered_bytes",
+            snapshot.bufferedBytes,
+            "gauge",
+            "Size of the buffered request, response and output data.");
+    return text;
+}
+
+} //namespace fcgi
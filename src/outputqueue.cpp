@@ -0,0 +1,102 @@
+#include "outputqueue.h"
+#include <algorithm>
+
+namespace fcgi {
+
+namespace {
+std::size_t dataSize(const std::variant<std::string, FileRegion>& data)
+{
+    if (std::holds_alternative<FileRegion>(data))
+        return std::get<FileRegion>(data).size;
+    return std::get<std::string>(data).size();
+}
+
+void removeSentData(std::variant<std::string, FileRegion>& data, std::size_t sentSize)
+{
+    if (std::holds_alternative<FileRegion>(data)) {
+        auto& fileRegion = std::get<FileRegion>(data);
+        fileRegion.offset += sentSize;
+        fileRegion.size -= sentSize;
+    }
+    else
+        std::get<std::string>(data).erase(0, sentSize);
+}
+} //namespace
+
+OutputQueue::OutputQueue(
+        std::function<std::size_t(const std::string&)> trySendData,
+        std::function<std::size_t(const FileRegion&)> trySendFileData)
+    : trySendData_{std::move(trySendData)}
+    , trySendFileData_{std::move(trySendFileData)}
+{
+}
+
+void OutputQueue::write(const std::string& data)
+{
+    if (data.empty())
+        return;
+    if (!queue_.empty()) {
+        queue_.emplace_back(data);
+        size_ += data.size();
+        return;
+    }
+    const auto sentSize = std::min(trySendData_(data), data.size());
+    if (sentSize < data.size()) {
+        queue_.emplace_back(data.substr(sentSize));
+        size_ += data.size() - sentSize;
+    }
+}
+
+void OutputQueue::write(const FileRegion& fileRegion)
+{
+    if (!fileRegion.size)
+        return;
+    queue_.emplace_back(fileRegion);
+    size_ += fileRegion.size;
+    if (queue_.size() == 1)
+        flush();
+}
+
+void OutputQueue::flush()
+{
+    while (!queue_.empty()) {
+        auto& data = queue_.front();
+        const auto clearsNumber = clearsNumber_;
+        const auto sentSize = std::min(trySend(data), dataSize(data));
+        // the send function can clear the queue, e.g. when the file data can't be read
+        if (clearsNumber != clearsNumber_)
+            return;
+        size_ -= sentSize;
+        if (sentSize < dataSize(data)) {
+            removeSentData(data, sentSize);
+            return;
+        }
+        queue_.pop_front();
+    }
+}
+
+std::size_t OutputQueue::trySend(std::variant<std::string, FileRegion>& data)
+{
+    if (std::holds_alternative<FileRegion>(data))
+        return trySendFileData_(std::get<FileRegion>(data));
+    return trySendData_(std::get<std::string>(data));
+}
+
+void OutputQueue::clear()
+{
+    queue_.clear();
+    size_ = 0;
+    ++clearsNumber_;
+}
+
+bool OutputQueue::empty() const
+{
+    return queue_.empty();
+}
+
+std::size_t OutputQueue::size() const
+{
+    return size_;
+}
+
+} //namespace fcgi
@@ -0,0 +1,33 @@
+#pragma once
+#include <fcgi_responder/response.h>
+#include <deque>
+#include <functional>
+#include <string>
+#include <variant>
+
+namespace fcgi {
+
+class OutputQueue {
+public:
+    OutputQueue(
+            std::function<std::size_t(const std::string&)> trySendData,
+            std::function<std::size_t(const FileRegion&)> trySendFileData = {});
+    void write(const std::string& data);
+    void write(const FileRegion& fileRegion);
+    void flush();
+    void clear();
+    bool empty() const;
+    std::size_t size() const;
+
+private:
+    std::size_t trySend(std::variant<std::string, FileRegion>& data);
+
+private:
+    std::function<std::size_t(const std::string&)> trySendData_;
+    std::function<std::size_t(const FileRegion&)> trySendFileData_;
+    std::deque<std::variant<std::string, FileRegion>> queue_;
+    std::size_t size_ = 0;
+    std::size_t clearsNumber_ = 0;
+};
+
+} //namespace fcgi
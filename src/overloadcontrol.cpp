@@ -0,0 +1,100 @@
+#include <fcgi_responder/overloadcontrol.h>
+#include <algorithm>
+
+namespace fcgi {
+
+OverloadControl::OverloadControl(std::chrono::microseconds latencyTarget, int minRequestsLimit, int maxRequestsLimit)
+    : latencyTarget_{latencyTarget}
+    , minRequestsLimit_{static_cast<double>(std::max(minRequestsLimit, 1))}
+    , maxRequestsLimit_{static_cast<double>(std::max(maxRequestsLimit, minRequestsLimit))}
+    , requestsLimit_{maxRequestsLimit_}
+{
+}
+
+void OverloadControl::setDecreaseFactor(double factor)
+{
+    auto lock = std::lock_guard{mutex_};
+    decreaseFactor_ = std::clamp(factor, 0.01, 0.99);
+}
+
+void OverloadControl::setMaximumOutputQueueSize(std::size_t size)
+{
+    maxOutputQueueSize_ = size;
+}
+
+int OverloadControl::requestsLimit() const
+{
+    auto lock = std::lock_guard{mutex_};
+    return static_cast<int>(requestsLimit_);
+}
+
+int OverloadControl::activeRequestsNumber() const
+{
+    auto lock = std::lock_guard{mutex_};
+    return activeRequestsNumber_;
+}
+
+std::size_t OverloadControl::outputQueueSize() const
+{
+    return outputQueueSize_;
+}
+
+std::chrono::microseconds OverloadControl::lastLatency() const
+{
+    auto lock = std::lock_guard{mutex_};
+    return lastLatency_;
+}
+
+bool OverloadControl::tryAcquireRequest()
+{
+    if (outputQueueSize_ >= maxOutputQueueSize_)
+        return false;
+
+    auto lock = std::lock_guard{mutex_};
+    if (activeRequestsNumber_ >= static_cast<int>(requestsLimit_))
+        return false;
+    ++activeRequestsNumber_;
+    return true;
+}
+
+void OverloadControl::acquireRequest()
+{
+    auto lock = std::lock_guard{mutex_};
+    ++activeRequestsNumber_;
+}
+
+void OverloadControl::releaseRequest()
+{
+    auto lock = std::lock_guard{mutex_};
+    if (activeRequestsNumber_ > 0)
+        --activeRequestsNumber_;
+}
+
+void OverloadControl::addLatencySample(std::chrono::microseconds latency)
+{
+    auto lock = std::lock_guard{mutex_};
+    lastLatency_ = latency;
+    if (samplesUntilNextDecrease_ > 0)
+        --samplesUntilNextDecrease_;
+
+    if (latency <= latencyTarget_) {
+        requestsLimit_ = std::min(requestsLimit_ + 1.0 / requestsLimit_, maxRequestsLimit_);
+        return;
+    }
+    // the limit is decreased once per the current limit number of requests,
+    // so the latencies of requests started before the previous decrease don't affect it again
+    if (samplesUntilNextDecrease_ > 0)
+        return;
+    requestsLimit_ = std::max(requestsLimit_ * decreaseFactor_, minRequestsLimit_);
+    samplesUntilNextDecrease_ = static_cast<int>(requestsLimit_);
+}
+
+void OverloadControl::updateOutputQueueSize(std::size_t previousSize, std::size_t size)
+{
+    if (size >= previousSize)
+        outputQueueSize_ += size - previousSize;
+    else
+        outputQueueSize_ -= previousSize - size;
+}
+
+} //namespace fcgi
@@ -48,12 +48,10 @@ void Record::write(std::ostream& output) const
 {
     auto contentLength = static_cast<std::uint16_t>(messageSize());
     auto paddingLength = calcPaddingLength();
-    auto reservedByte = std::uint8_t{};
 
-    auto encoder = Encoder(output);
-    encoder << hardcoded::protocolVersion << static_cast<std::uint8_t>(type_) << requestId_ << contentLength << paddingLength
-            << reservedByte;
+    writeRecordHeader(output, type_, requestId_, contentLength, paddingLength);
     writeMessage(output);
+    auto encoder = Encoder(output);
     encoder.addPadding(paddingLength);
 }
 
@@ -212,4 +210,17 @@ bool operator==(const Record& lhs, const Record& rhs)
     return lhs.type_ == rhs.type_ && lhs.requestId_ == rhs.requestId_ && compareMessages(lhs, rhs);
 }
 
+void writeRecordHeader(
+        std::ostream& output,
+        RecordType type,
+        std::uint16_t requestId,
+        std::uint16_t contentLength,
+        std::uint8_t paddingLength)
+{
+    auto reservedByte = std::uint8_t{};
+    auto encoder = Encoder(output);
+    encoder << hardcoded::protocolVersion << static_cast<std::uint8_t>(type) << requestId << contentLength << paddingLength
+            << reservedByte;
+}
+
 } //namespace fcgi
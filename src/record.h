@@ -76,4 +76,11 @@ const MsgT& Record::getMessage() const
 }
 bool operator==(const Record& lhs, const Record& rhs);
 
+void writeRecordHeader(
+        std::ostream& output,
+        RecordType type,
+        std::uint16_t requestId,
+        std::uint16_t contentLength,
+        std::uint8_t paddingLength);
+
 } //namespace fcgi
@@ -20,9 +20,9 @@ void RecordReader::read(const char* data, std::size_t size)
         ;
 }
 
-void RecordReader::setErrorInfoHandler(const std::function<void(const std::string&)>& errorInfoHandler)
+void RecordReader::setErrorHandler(std::function<void(const ErrorEvent&)> errorHandler)
 {
-    errorInfoHandler_ = errorInfoHandler;
+    errorHandler_ = std::move(errorHandler);
 }
 
 void RecordReader::findRecords(const char* data, std::size_t size)
@@ -60,16 +60,20 @@ RecordReader::ReadResultAction RecordReader::doRead(const char* data, std::size_
     }
     catch (const InvalidRecordType& e) {
         invalidRecordTypeHandler_(e.recordType());
-        notifyAboutError(e.what());
+        notifyAboutError(ErrorEvent{ErrorCode::InvalidRecordType, 0, e.recordType(), e.recordType()});
         clear();
     }
     catch (const RecordMessageReadError& e) {
-        notifyAboutError(e.what());
+        notifyAboutError(ErrorEvent{ErrorCode::MalformedRecord, 0, 0, 0, e.what()});
         skipBrokenRecord(e.recordSize());
         return ReadResultAction::ContinueReading;
     }
+    catch (const UnsupportedVersion& e) {
+        notifyAboutError(ErrorEvent{ErrorCode::UnsupportedVersion, 0, 0, e.protocolVersion()});
+        clear();
+    }
     catch (const std::exception& e) {
-        notifyAboutError(e.what());
+        notifyAboutError(ErrorEvent{ErrorCode::InvalidRecord, 0, 0, 0, e.what()});
         clear();
     }
     return ReadResultAction::StopReading;
@@ -81,10 +85,10 @@ void RecordReader::clear()
     leftover_.clear();
 }
 
-void RecordReader::notifyAboutError(const std::string& errorInfo)
+void RecordReader::notifyAboutError(const ErrorEvent& event)
 {
-    if (errorInfoHandler_)
-        errorInfoHandler_(errorInfo);
+    if (errorHandler_)
+        errorHandler_(event);
 }
 
 } //namespace fcgi
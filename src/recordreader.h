@@ -1,6 +1,7 @@
 #pragma once
 #include "constants.h"
 #include "datareaderstream.h"
+#include <fcgi_responder/errorevent.h>
 #include <functional>
 #include <memory>
 #include <sstream>
@@ -21,19 +22,19 @@ public:
             std::function<void(Record&)> recordReadHandler,
             std::function<void(std::uint8_t)> invalidRecordTypeHandler = {});
     void read(const char* data, std::size_t size);
-    void setErrorInfoHandler(const std::function<void(const std::string&)>& errorInfoHandler);
+    void setErrorHandler(std::function<void(const ErrorEvent&)> errorHandler);
+    void clear();
 
 private:
     ReadResultAction doRead(const char* data, std::size_t size);
     void findRecords(const char* data, std::size_t size);
-    void notifyAboutError(const std::string& errorInfo);
-    void clear();
+    void notifyAboutError(const ErrorEvent& event);
     void skipBrokenRecord(std::size_t recordSize);
 
 private:
     std::function<void(Record&)> recordReadHandler_;
     std::function<void(std::uint8_t)> invalidRecordTypeHandler_;
-    std::function<void(const std::string&)> errorInfoHandler_;
+    std::function<void(const ErrorEvent&)> errorHandler_;
     DataReaderStream dataStream_;
     std::string leftover_;
     std::size_t readRecordsSize_ = 0;
@@ -1,4 +1,5 @@
 #include "requestdata.h"
+#include "cancellationtoken.h"
 #include "msgparams.h"
 #include <fcgi_responder/request.h>
 
@@ -13,6 +14,7 @@ void RequestData::addMessage(const MsgParams& msg)
 {
     for (const auto& paramName : msg.paramList())
         params_.emplace_back(paramName, msg.paramValue(paramName));
+    paramsSize_ += msg.size();
 }
 
 void RequestData::addMessage(const MsgStdIn& msg)
@@ -25,8 +27,16 @@ std::optional<Request> RequestData::makeRequest()
     if (usedInRequest_)
         return std::nullopt;
     usedInRequest_ = true;
+    paramsSize_ = 0;
 
-    return Request{std::move(params_), std::move(stdIn_)};
+    auto stdIn = std::move(stdIn_);
+    stdIn_.clear();
+    return Request{std::move(params_), std::move(stdIn)};
+}
+
+bool RequestData::isProcessingStarted() const
+{
+    return usedInRequest_;
 }
 
 bool RequestData::keepConnection() const
@@ -34,4 +44,69 @@ bool RequestData::keepConnection() const
     return keepConnection_;
 }
 
+std::size_t RequestData::paramsSize() const
+{
+    return paramsSize_;
+}
+
+std::size_t RequestData::stdInSize() const
+{
+    return stdIn_.size();
+}
+
+void RequestData::setProcessingStartTime(std::chrono::steady_clock::time_point time)
+{
+    processingStartTime_ = time;
+}
+
+std::optional<std::chrono::steady_clock::time_point> RequestData::processingStartTime() const
+{
+    return processingStartTime_;
+}
+
+const std::shared_ptr<CancellationToken>& RequestData::cancellationToken()
+{
+    if (!cancellationToken_)
+        cancellationToken_ = std::make_shared<CancellationToken>();
+    return cancellationToken_;
+}
+
+void RequestData::cancel()
+{
+    if (cancellationToken_)
+        cancellationToken_->cancel();
+}
+
+void RequestData::setFilterInput(FilterInput input)
+{
+    filterInput_ = std::make_shared<FilterInput>(std::move(input));
+}
+
+std::shared_ptr<FilterInput> RequestData::filterInput() const
+{
+    return filterInput_;
+}
+
+void RequestData::setDataStreamEnded()
+{
+    isDataStreamEnded_ = true;
+}
+
+bool RequestData::isDataStreamEnded() const
+{
+    return isDataStreamEnded_;
+}
+
+TimerWheel::Timer& RequestData::timeoutTimer()
+{
+    return timeoutTimer_;
+}
+
+#ifdef FCGI_RESPONDER_REQUEST_TIMING
+RequestTiming& RequestData::timing()
+{
+    return timing_;
+}
+#endif
+
 } //namespace fcgi
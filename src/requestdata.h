@@ -1,5 +1,10 @@
 #pragma once
 #include "streamdatamessage.h"
+#include <fcgi_responder/filterstreams.h>
+#include <fcgi_responder/requesttiming.h>
+#include <fcgi_responder/timerwheel.h>
+#include <chrono>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
@@ -7,6 +12,7 @@
 namespace fcgi {
 class MsgParams;
 class Request;
+class CancellationToken;
 
 class RequestData {
 public:
@@ -14,14 +20,38 @@ public:
     void addMessage(const MsgParams& msg);
     void addMessage(const MsgStdIn& msg);
     std::optional<Request> makeRequest();
+    bool isProcessingStarted() const;
 
     bool keepConnection() const;
+    std::size_t paramsSize() const;
+    std::size_t stdInSize() const;
+    void setProcessingStartTime(std::chrono::steady_clock::time_point time);
+    std::optional<std::chrono::steady_clock::time_point> processingStartTime() const;
+    const std::shared_ptr<CancellationToken>& cancellationToken();
+    void cancel();
+    void setFilterInput(FilterInput input);
+    std::shared_ptr<FilterInput> filterInput() const;
+    void setDataStreamEnded();
+    bool isDataStreamEnded() const;
+    TimerWheel::Timer& timeoutTimer();
+#ifdef FCGI_RESPONDER_REQUEST_TIMING
+    RequestTiming& timing();
+#endif
 
 private:
     std::string stdIn_;
     std::vector<std::pair<std::string, std::string>> params_;
+    std::size_t paramsSize_ = 0;
     bool keepConnection_ = true;
     bool usedInRequest_ = false;
+    std::optional<std::chrono::steady_clock::time_point> processingStartTime_;
+    std::shared_ptr<CancellationToken> cancellationToken_;
+    std::shared_ptr<FilterInput> filterInput_;
+    bool isDataStreamEnded_ = false;
+    TimerWheel::Timer timeoutTimer_;
+#ifdef FCGI_RESPONDER_REQUEST_TIMING
+    RequestTiming timing_;
+#endif
 };
 
 } //namespace fcgi
@@ -0,0 +1,73 @@
+#include "requestdatastream.h"
+#include "requesterimpl.h"
+#include <utility>
+
+namespace fcgi {
+
+RequestDataStream::RequestDataStream(RequesterImpl& requester)
+    : requester_{requester}
+{
+}
+
+void RequestDataStream::write(std::string_view data)
+{
+    if (isClosed() || data.empty())
+        return;
+    if (!requestId_) {
+        pendingData_ += data;
+        return;
+    }
+    requester_.sendRequestData(*requestId_, data, false);
+}
+
+void RequestDataStream::end()
+{
+    if (isClosed())
+        return;
+    isEnded_ = true;
+    writableHandler_ = nullptr;
+    if (requestId_)
+        requester_.sendRequestData(*requestId_, {}, true);
+}
+
+bool RequestDataStream::isWritable() const
+{
+    return requestId_ && !isClosed() && requester_.isWritable();
+}
+
+bool RequestDataStream::isClosed() const
+{
+    return isEnded_ || isClosed_;
+}
+
+void RequestDataStream::setWritableHandler(std::function<void()> handler)
+{
+    if (!isClosed())
+        writableHandler_ = std::move(handler);
+}
+
+void RequestDataStream::start(std::uint16_t requestId)
+{
+    requestId_ = requestId;
+    if (!pendingData_.empty())
+        requester_.sendRequestData(requestId, std::exchange(pendingData_, {}), isEnded_);
+    else if (isEnded_)
+        requester_.sendRequestData(requestId, {}, true);
+}
+
+void RequestDataStream::notifyWritable()
+{
+    if (isClosed() || !writableHandler_)
+        return;
+    // the handler can end the stream, which resets it
+    auto writableHandler = writableHandler_;
+    writableHandler();
+}
+
+void RequestDataStream::close()
+{
+    isClosed_ = true;
+    writableHandler_ = nullptr;
+}
+
+} //namespace fcgi
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace fcgi {
+class RequesterImpl;
+
+///
+/// State of a request data stream shared by the Requester and the RequestDataWriter passed to the application.
+/// Data written before the request is sent is buffered until start() is called.
+///
+class RequestDataStream {
+public:
+    explicit RequestDataStream(RequesterImpl& requester);
+
+    void write(std::string_view data);
+    void end();
+    bool isWritable() const;
+    bool isClosed() const;
+    void setWritableHandler(std::function<void()> handler);
+
+    void start(std::uint16_t requestId);
+    void notifyWritable();
+    void close();
+
+private:
+    RequesterImpl& requester_;
+    std::optional<std::uint16_t> requestId_;
+    std::string pendingData_;
+    bool isEnded_ = false;
+    bool isClosed_ = false;
+    std::function<void()> writableHandler_;
+};
+
+} //namespace fcgi
@@ -1,3 +1,4 @@
+#include "requestdatastream.h"
 #include "requesterimpl.h"
 #include <fcgi_responder/requester.h>
 
@@ -14,6 +15,52 @@ void RequestHandle::cancelRequest()
         (*cancelRequestHandler)();
 }
 
+RequestDataWriter::RequestDataWriter(std::weak_ptr<RequestDataStream> stream, RequestHandle requestHandle)
+    : stream_{std::move(stream)}
+    , requestHandle_{std::move(requestHandle)}
+{
+}
+
+void RequestDataWriter::write(std::string_view data)
+{
+    if (auto stream = stream_.lock())
+        stream->write(data);
+}
+
+void RequestDataWriter::end()
+{
+    if (auto stream = stream_.lock())
+        stream->end();
+}
+
+bool RequestDataWriter::isWritable() const
+{
+    auto stream = stream_.lock();
+    return stream && stream->isWritable();
+}
+
+void RequestDataWriter::setWritableHandler(std::function<void()> handler)
+{
+    if (auto stream = stream_.lock())
+        stream->setWritableHandler(std::move(handler));
+}
+
+void RequestDataWriter::cancelRequest()
+{
+    requestHandle_.cancelRequest();
+}
+
+bool RequestDataWriter::isValid() const
+{
+    auto stream = stream_.lock();
+    return stream && !stream->isClosed();
+}
+
+RequestDataWriter::operator bool() const
+{
+    return isValid();
+}
+
 Requester::Requester()
     : impl_{std::make_unique<RequesterImpl>(
               [this](const std::string& data)
@@ -23,6 +70,10 @@ Requester::Requester()
               [this]()
               {
                   disconnect();
+              },
+              [this]()
+              {
+                  return isWritable();
               })}
 {
 }
@@ -45,7 +96,65 @@ std::optional<RequestHandle> Requester::sendRequest(
         const std::function<void(std::optional<ResponseData>)>& responseHandler,
         bool keepConnection)
 {
-    return impl().sendRequest(std::move(params), std::move(data), responseHandler, keepConnection);
+    return impl().sendRequest(
+            RequestParams{params.begin(), params.end()},
+            std::move(data),
+            {responseHandler, nullptr},
+            keepConnection);
+}
+
+std::optional<RequestHandle> Requester::sendRequest(
+        std::map<std::string, std::string> params,
+        std::string data,
+        ResponseStreamHandler responseStreamHandler,
+        bool keepConnection)
+{
+    return impl().sendRequest(
+            RequestParams{params.begin(), params.end()},
+            std::move(data),
+            {nullptr, std::make_shared<ResponseStreamHandler>(std::move(responseStreamHandler))},
+            keepConnection);
+}
+
+std::optional<RequestHandle> Requester::sendPreparedRequest(
+        const RequestParams& params,
+        std::string data,
+        const std::function<void(std::optional<ResponseData>)>& responseHandler,
+        bool keepConnection)
+{
+    return impl().sendRequest(params, std::move(data), {responseHandler, nullptr}, keepConnection);
+}
+
+std::optional<RequestHandle> Requester::sendPreparedRequest(
+        const RequestParams& params,
+        std::string data,
+        ResponseStreamHandler responseStreamHandler,
+        bool keepConnection)
+{
+    return impl().sendRequest(
+            params,
+            std::move(data),
+            {nullptr, std::make_shared<ResponseStreamHandler>(std::move(responseStreamHandler))},
+            keepConnection);
+}
+
+std::optional<RequestDataWriter> Requester::startRequest(
+        std::map<std::string, std::string> params,
+        const std::function<void(std::optional<ResponseData>)>& responseHandler,
+        bool keepConnection)
+{
+    return impl().startRequest(RequestParams{params.begin(), params.end()}, {responseHandler, nullptr}, keepConnection);
+}
+
+std::optional<RequestDataWriter> Requester::startRequest(
+        std::map<std::string, std::string> params,
+        ResponseStreamHandler responseStreamHandler,
+        bool keepConnection)
+{
+    return impl().startRequest(
+            RequestParams{params.begin(), params.end()},
+            {nullptr, std::make_shared<ResponseStreamHandler>(std::move(responseStreamHandler))},
+            keepConnection);
 }
 
 int Requester::availableRequestsNumber() const
@@ -58,11 +167,56 @@ void Requester::receiveData(const char* data, std::size_t size)
     impl().receiveData(data, size);
 }
 
+void Requester::onWritable()
+{
+    impl().onWritable();
+}
+
+bool Requester::isWritable() const
+{
+    return true;
+}
+
 void Requester::setErrorInfoHandler(const std::function<void(const std::string&)>& handler)
 {
     impl().setErrorInfoHandler(handler);
 }
 
+void Requester::setErrorEventHandler(const std::function<void(const ErrorEvent&)>& handler)
+{
+    impl().setErrorEventHandler(handler);
+}
+
+void Requester::setThreadLocalSerializationBufferEnabled(bool state)
+{
+    impl().setThreadLocalSerializationBufferEnabled(state);
+}
+
+bool Requester::isThreadLocalSerializationBufferEnabled() const
+{
+    return impl().isThreadLocalSerializationBufferEnabled();
+}
+
+void Requester::setMetrics(std::shared_ptr<Metrics> metrics)
+{
+    impl().setMetrics(std::move(metrics));
+}
+
+void Requester::setTimerWheel(std::shared_ptr<TimerWheel> timerWheel)
+{
+    impl().setTimerWheel(std::move(timerWheel));
+}
+
+void Requester::setResponseTimeout(std::chrono::milliseconds timeout)
+{
+    impl().setResponseTimeout(timeout);
+}
+
+std::chrono::milliseconds Requester::responseTimeout() const
+{
+    return impl().responseTimeout();
+}
+
 int Requester::maximumConnectionsNumber() const
 {
     return impl().maximumConnectionsNumber();
@@ -1,10 +1,14 @@
 #include "requesterimpl.h"
+#include "constants.h"
+#include "encoder.h"
 #include "record.h"
 #include "recordreader.h"
+#include "requestdatastream.h"
 #include "streammaker.h"
 #include <algorithm>
 #include <cstdint>
 #include <exception>
+#include <utility>
 
 namespace fcgi {
 
@@ -21,42 +25,129 @@ std::set<std::uint16_t> generateRequestIds(int maxRequestsNumber)
 {
     std::terminate();
 }
+
+// the data is encoded by RequestParams, so it always starts with a complete name-value pair
+std::size_t nameValueSize(std::string_view data)
+{
+    auto offset = std::size_t{};
+    auto readLength = [&]
+    {
+        const auto lengthB3 = static_cast<unsigned char>(data[offset]);
+        if ((lengthB3 >> 7) == 0) {
+            offset += 1;
+            return std::size_t{lengthB3};
+        }
+        const auto lengthB2 = static_cast<unsigned char>(data[offset + 1]);
+        const auto lengthB1 = static_cast<unsigned char>(data[offset + 2]);
+        const auto lengthB0 = static_cast<unsigned char>(data[offset + 3]);
+        offset += 4;
+        return (std::size_t{lengthB3 & 0x7fu} << 24) + (std::size_t{lengthB2} << 16) + (std::size_t{lengthB1} << 8) +
+                lengthB0;
+    };
+    const auto nameLength = readLength();
+    const auto valueLength = readLength();
+    return offset + nameLength + valueLength;
+}
 } //namespace
 
-RequesterImpl::RequesterImpl(std::function<void(const std::string&)> sendData, std::function<void()> disconnect)
+void ResponseHandlers::endResponse(std::optional<ResponseData> response) const
+{
+    if (responseHandler)
+        responseHandler(std::move(response));
+    else if (responseStreamHandler && responseStreamHandler->onEnd)
+        responseStreamHandler->onEnd(response.has_value());
+}
+
+RequesterImpl::RequesterImpl(
+        std::function<void(const std::string&)> sendData,
+        std::function<void()> disconnect,
+        std::function<bool()> isWritable)
     : recordReader_{[this](const Record& record)
                     {
                         onRecordRead(record);
                     }}
-    , recordStream_{hardcoded::maxRecordSize}
     , sendData_{std::move(sendData)}
     , disconnect_{std::move(disconnect)}
+    , isWritable_{std::move(isWritable)}
 {
+    recordReader_.setErrorHandler(
+            [this](const ErrorEvent& event)
+            {
+                notifyAboutError(event);
+            });
+    connectionTimer_.setHandler(
+            [this]
+            {
+                onConnectionTimeout();
+            });
 }
 
 std::optional<RequestHandle> RequesterImpl::sendRequest(
-        std::map<std::string, std::string> params,
+        const RequestParams& params,
         std::string data,
-        const std::function<void(std::optional<ResponseData>)>& responseHandler,
-        bool keepConnection)
+        const ResponseHandlers& responseHandlers,
+        bool keepConnection,
+        const std::shared_ptr<RequestDataStream>& requestDataStream)
 {
     if (connectionState_ == ConnectionState::NotConnected) {
-        initConnection(std::move(params), std::move(data), responseHandler, keepConnection);
+        initConnection(params, std::move(data), responseHandlers, keepConnection, requestDataStream);
         connectionOpeningRequestCancelHandler_ = std::make_shared<std::function<void()>>(
                 [=]
                 {
-                    notifyAboutError("Connection initialization cancelled");
+                    connectionTimer_.cancel();
+                    notifyAboutError(ErrorEvent{ErrorCode::ConnectionInitializationCancelled});
                     connectionState_ = ConnectionState::NotConnected;
-                    responseHandler(std::nullopt);
+                    if (requestDataStream)
+                        requestDataStream->close();
+                    responseHandlers.endResponse(std::nullopt);
                 });
         return connectionOpeningRequestCancelHandler_;
     }
     else if (connectionState_ == ConnectionState::Connected)
-        return doSendRequest(params, data, responseHandler, keepConnection);
+        return doSendRequest(params, data, responseHandlers, keepConnection, requestDataStream);
 
     return std::nullopt;
 }
 
+std::optional<RequestDataWriter> RequesterImpl::startRequest(
+        const RequestParams& params,
+        const ResponseHandlers& responseHandlers,
+        bool keepConnection)
+{
+    auto requestDataStream = std::make_shared<RequestDataStream>(*this);
+    auto requestHandle = sendRequest(params, {}, responseHandlers, keepConnection, requestDataStream);
+    if (!requestHandle)
+        return std::nullopt;
+    return RequestDataWriter{requestDataStream, *requestHandle};
+}
+
+void RequesterImpl::sendRequestData(std::uint16_t requestId, std::string_view data, bool isEnd)
+{
+    while (!data.empty()) {
+        const auto size = std::min<std::size_t>(data.size(), hardcoded::maxDataMessageSize);
+        sendMessage(requestId, MsgStdIn{data.substr(0, size)});
+        data.remove_prefix(size);
+    }
+    if (isEnd)
+        sendMessage(requestId, MsgStdIn{});
+}
+
+bool RequesterImpl::isWritable() const
+{
+    return isWritable_();
+}
+
+void RequesterImpl::onWritable()
+{
+    // handlers can end or send requests, so the streams are collected first
+    auto requestDataStreams = std::vector<std::shared_ptr<RequestDataStream>>{};
+    for (const auto& [requestId, responseContext] : responseMap_)
+        if (responseContext.requestDataStream && !responseContext.requestDataStream->isClosed())
+            requestDataStreams.push_back(responseContext.requestDataStream);
+    for (const auto& requestDataStream : requestDataStreams)
+        requestDataStream->notifyWritable();
+}
+
 int RequesterImpl::availableRequestsNumber() const
 {
     switch (connectionState_) {
@@ -71,71 +162,92 @@ int RequesterImpl::availableRequestsNumber() const
 }
 
 void RequesterImpl::initConnection(
-        std::map<std::string, std::string> params,
+        RequestParams params,
         std::string data,
-        std::function<void(std::optional<ResponseData>)> responseHandler,
-        bool keepConnection)
+        ResponseHandlers responseHandlers,
+        bool keepConnection,
+        std::shared_ptr<RequestDataStream> requestDataStream)
 {
     connectionState_ = ConnectionState::ConnectionInProgress;
     onConnectionFail_ = [=]()
     {
         connectionState_ = ConnectionState::NotConnected;
-        responseHandler(std::nullopt);
+        if (requestDataStream)
+            requestDataStream->close();
+        responseHandlers.endResponse(std::nullopt);
     };
     onConnectionSuccess_ = [this,
                             params = std::move(params),
                             data = std::move(data),
-                            responseHandler = std::move(responseHandler),
-                            keepConnection]() mutable
+                            responseHandlers = std::move(responseHandlers),
+                            keepConnection,
+                            requestDataStream = std::move(requestDataStream)]() mutable
     {
         connectionState_ = ConnectionState::Connected;
         requestIdPool_ = cfg_.multiplexingEnabled ? generateRequestIds(cfg_.maxRequestsNumber) : std::set<std::uint16_t>{1};
-        doSendRequest(params, data, responseHandler, keepConnection);
-        *connectionOpeningRequestCancelHandler_ = *responseMap_.begin()->second.cancelRequestHandler;
+        doSendRequest(params, data, responseHandlers, keepConnection, requestDataStream);
+        if (connectionOpeningRequestCancelHandler_)
+            *connectionOpeningRequestCancelHandler_ = *responseMap_.begin()->second.cancelRequestHandler;
+        // the writable handler is called after the request handle is updated, so it can cancel the request
+        if (requestDataStream)
+            requestDataStream->notifyWritable();
     };
     auto getValuesMsg = MsgGetValues{};
     getValuesMsg.requestValue(ValueRequest::MaxReqs);
     getValuesMsg.requestValue(ValueRequest::MpxsConns);
+    armTimer(connectionTimer_);
     sendMessage(0, getValuesMsg);
 }
 
 std::optional<RequestHandle> RequesterImpl::doSendRequest(
-        const std::map<std::string, std::string>& params,
+        const RequestParams& params,
         const std::string& data,
-        std::function<void(std::optional<ResponseData>)> responseHandler,
-        bool keepConnection)
+        ResponseHandlers responseHandlers,
+        bool keepConnection,
+        std::shared_ptr<RequestDataStream> requestDataStream)
 {
     if (requestIdPool_.empty()) {
-        notifyAboutError("Maximum requests number reached");
-        responseHandler(std::nullopt);
+        notifyAboutError(ErrorEvent{ErrorCode::MaximumRequestsNumberReached});
+        if (requestDataStream)
+            requestDataStream->close();
+        responseHandlers.endResponse(std::nullopt);
         return std::nullopt;
     }
 
     auto requestId = *requestIdPool_.begin();
     requestIdPool_.erase(requestId);
+    metrics_.onRequestStarted();
     responseMap_.emplace(
             requestId,
             ResponseContext{
-                    std::move(responseHandler),
+                    std::move(responseHandlers),
                     ResponseData{},
                     keepConnection,
                     std::make_shared<std::function<void()>>(
                             [=]
                             {
                                 doEndRequest(requestId, ResponseStatus::Cancelled);
-                            })});
+                            }),
+                    TimerWheel::Timer{[this, requestId]
+                                      {
+                                          onResponseTimeout(requestId);
+                                      }},
+                    requestDataStream,
+                    false});
+    armTimer(responseMap_.at(requestId).responseTimer);
 
     sendMessage(
             requestId,
             MsgBeginRequest{
                     Role::Responder,
                     keepConnection ? ResultConnectionState::KeepOpen : ResultConnectionState::Close});
-    auto paramsMsg = MsgParams{};
-    for (const auto& [paramName, paramValue] : params)
-        paramsMsg.setParam(paramName, paramValue);
-    sendMessage(requestId, std::move(paramsMsg));
-    if (!params.empty())
-        sendMessage(requestId, MsgParams{});
+    sendParams(requestId, params.data());
+
+    updateMetricsGauges();
+    if (requestDataStream) {
+        requestDataStream->start(requestId);
+        return responseMap_.at(requestId).cancelRequestHandler;
+    }
 
     auto dataStream = makeStream<MsgStdIn>(requestId, data);
     std::for_each(
@@ -145,23 +257,64 @@ std::optional<RequestHandle> RequesterImpl::doSendRequest(
             {
                 sendRecord(record);
             });
-
     return responseMap_.at(requestId).cancelRequestHandler;
 }
 
 void RequesterImpl::doEndRequest(std::uint16_t requestId, ResponseStatus responseStatus)
 {
     auto& responseContext = responseMap_.at(requestId);
-    if (responseStatus == ResponseStatus::Successful)
-        responseContext.responseHandler(std::move(responseContext.responseData));
-    else
-        responseContext.responseHandler(std::nullopt);
+    if (responseContext.isTimedOut && responseStatus == ResponseStatus::Cancelled)
+        return;
+    if (responseStatus == ResponseStatus::Cancelled)
+        metrics_.onRequestAborted();
+    if (responseContext.requestDataStream)
+        responseContext.requestDataStream->close();
+    if (!responseContext.isTimedOut) {
+        if (responseStatus == ResponseStatus::Successful)
+            responseContext.responseHandlers.endResponse(std::move(responseContext.responseData));
+        else
+            responseContext.responseHandlers.endResponse(std::nullopt);
+    }
 
     if (responseStatus != ResponseStatus::Cancelled && !responseContext.keepConnection)
         disconnect_();
 
     responseMap_.erase(requestId);
     requestIdPool_.insert(requestId);
+    updateMetricsGauges();
+}
+
+void RequesterImpl::armTimer(TimerWheel::Timer& timer)
+{
+    if (timerWheel_ && cfg_.responseTimeout.count() > 0)
+        timerWheel_->arm(timer, cfg_.responseTimeout);
+}
+
+void RequesterImpl::onConnectionTimeout()
+{
+    notifyAboutError(ErrorEvent{ErrorCode::RequestTimeout});
+    // the request handle can't be used after the response handler is called
+    connectionOpeningRequestCancelHandler_.reset();
+    onConnectionFail_();
+    disconnect_();
+}
+
+void RequesterImpl::onResponseTimeout(std::uint16_t requestId)
+{
+    notifyAboutError(ErrorEvent{ErrorCode::RequestTimeout, requestId});
+    metrics_.onRequestAborted();
+    auto& responseContext = responseMap_.at(requestId);
+    if (!responseContext.keepConnection) {
+        doEndRequest(requestId, ResponseStatus::Failed);
+        return;
+    }
+    // the request id stays reserved until the application ends the aborted request,
+    // so its late response records aren't mixed up with the ones of a new request
+    sendMessage(requestId, MsgAbortRequest{});
+    responseContext.isTimedOut = true;
+    if (responseContext.requestDataStream)
+        responseContext.requestDataStream->close();
+    responseContext.responseHandlers.endResponse(std::nullopt);
 }
 
 template<typename TMsg>
@@ -173,25 +326,81 @@ void RequesterImpl::sendMessage(std::uint16_t requestId, TMsg&& msg)
 template void RequesterImpl::sendMessage<MsgGetValues>(std::uint16_t requestId, MsgGetValues&& msg);
 template void RequesterImpl::sendMessage<MsgBeginRequest>(std::uint16_t requestId, MsgBeginRequest&& msg);
 template void RequesterImpl::sendMessage<MsgAbortRequest>(std::uint16_t requestId, MsgAbortRequest&& msg);
-template void RequesterImpl::sendMessage<MsgParams>(std::uint16_t requestId, MsgParams&& msg);
 template void RequesterImpl::sendMessage<MsgStdIn>(std::uint16_t requestId, MsgStdIn&& msg);
 
 void RequesterImpl::sendRecord(const Record& record)
 {
-    recordStream_.resetBuffer(record.size());
+    auto scratchStream = ScratchDataWriterStream{recordStream_, threadLocalSerializationBufferEnabled_};
+    auto& recordStream = scratchStream.get();
+    recordStream.resetBuffer(record.size());
     try {
-        record.toStream(recordStream_);
+        record.toStream(recordStream);
     }
     catch (std::exception& e) {
-        notifyAboutError(e.what());
+        notifyAboutError(ErrorEvent{
+                ErrorCode::RecordSerializationError,
+                record.requestId(),
+                static_cast<std::uint8_t>(record.type()),
+                0,
+                e.what()});
         return;
     }
-    sendData_(recordStream_.buffer());
+    metrics_.onRecordSent(record.type());
+    metrics_.onDataSent(recordStream.buffer().size());
+    sendData_(recordStream.buffer());
+}
+
+void RequesterImpl::sendParams(std::uint16_t requestId, std::string_view params)
+{
+    // the records are split on the name-value pair boundaries, as some applications, including fcgi::Responder,
+    // decode each PARAMS record separately; only a pair exceeding the record size is split across records
+    while (!params.empty()) {
+        auto size = nameValueSize(params);
+        if (size > hardcoded::maxDataMessageSize) {
+            for (auto nameValue = params.substr(0, size); !nameValue.empty();) {
+                const auto chunkSize = std::min<std::size_t>(nameValue.size(), hardcoded::maxDataMessageSize);
+                sendParamsRecord(requestId, nameValue.substr(0, chunkSize));
+                nameValue.remove_prefix(chunkSize);
+            }
+            params.remove_prefix(size);
+            continue;
+        }
+        while (size < params.size()) {
+            const auto nextSize = nameValueSize(params.substr(size));
+            if (size + nextSize > hardcoded::maxDataMessageSize)
+                break;
+            size += nextSize;
+        }
+        sendParamsRecord(requestId, params.substr(0, size));
+        params.remove_prefix(size);
+    }
+    sendParamsRecord(requestId, {});
+}
+
+void RequesterImpl::sendParamsRecord(std::uint16_t requestId, std::string_view data)
+{
+    auto scratchStream = ScratchDataWriterStream{recordStream_, threadLocalSerializationBufferEnabled_};
+    auto& recordStream = scratchStream.get();
+    const auto paddingLength = static_cast<std::uint8_t>((8u - data.size() % 8u) % 8u);
+    recordStream.resetBuffer(hardcoded::headerSize + data.size() + paddingLength);
+    writeRecordHeader(
+            recordStream,
+            RecordType::Params,
+            requestId,
+            static_cast<std::uint16_t>(data.size()),
+            paddingLength);
+    recordStream.write(data.data(), static_cast<std::streamsize>(data.size()));
+    Encoder{recordStream}.addPadding(paddingLength);
+    metrics_.onRecordSent(RecordType::Params);
+    metrics_.onDataSent(recordStream.buffer().size());
+    sendData_(recordStream.buffer());
 }
 
 void RequesterImpl::receiveData(const char* data, std::size_t size)
 {
+    metrics_.onDataReceived(size);
     recordReader_.read(data, size);
+    updateMetricsGauges();
 }
 
 bool RequesterImpl::isRecordExpected(const Record& record)
@@ -207,10 +416,12 @@ bool RequesterImpl::isRecordExpected(const Record& record)
 
 void RequesterImpl::onRecordRead(const Record& record)
 {
+    metrics_.onRecordReceived(record.type());
     if (!isRecordExpected(record)) {
-        notifyAboutError(
-                "Received unexpected record, RecordType = " + std::to_string(static_cast<int>(record.type())) +
-                ", requestId = " + std::to_string(record.requestId()));
+        notifyAboutError(ErrorEvent{
+                ErrorCode::UnexpectedRecord,
+                record.requestId(),
+                static_cast<std::uint8_t>(record.type())});
         return;
     }
 
@@ -225,10 +436,18 @@ void RequesterImpl::onRecordRead(const Record& record)
         onEndRequest(record.requestId(), record.getMessage<MsgEndRequest>());
         break;
     case RecordType::StdOut:
-        onStdOut(record.requestId(), record.getMessage<MsgStdOut>());
+        onResponseStream(
+                record.requestId(),
+                record.getMessage<MsgStdOut>().data(),
+                &ResponseData::data,
+                &ResponseStreamHandler::onData);
         break;
     case RecordType::StdErr:
-        onStdErr(record.requestId(), record.getMessage<MsgStdErr>());
+        onResponseStream(
+                record.requestId(),
+                record.getMessage<MsgStdErr>().data(),
+                &ResponseData::errorMsg,
+                &ResponseStreamHandler::onErrorMsg);
         break;
     default:;
     }
@@ -236,6 +455,7 @@ void RequesterImpl::onRecordRead(const Record& record)
 
 void RequesterImpl::onGetValuesResult(const MsgGetValuesResult& msg)
 {
+    connectionTimer_.cancel();
     for (auto request : msg.requestList()) {
         switch (request) {
         case ValueRequest::MaxReqs:
@@ -243,7 +463,7 @@ void RequesterImpl::onGetValuesResult(const MsgGetValuesResult& msg)
                 cfg_.maxRequestsNumber = std::stoi(msg.requestValue(request));
             }
             catch (std::exception&) {
-                notifyAboutError("Invalid value for MaxReqs: " + msg.requestValue(request));
+                notifyAboutError(ErrorEvent{ErrorCode::InvalidMaxReqsValue, 0, 0, 0, msg.requestValue(request)});
                 onConnectionFail_();
                 return;
             }
@@ -253,7 +473,7 @@ void RequesterImpl::onGetValuesResult(const MsgGetValuesResult& msg)
                 cfg_.multiplexingEnabled = std::stoi(msg.requestValue(request)) != 0;
             }
             catch (std::exception&) {
-                notifyAboutError("Invalid value for MpxsConns: " + msg.requestValue(request));
+                notifyAboutError(ErrorEvent{ErrorCode::InvalidMpxsConnsValue, 0, 0, 0, msg.requestValue(request)});
                 onConnectionFail_();
                 return;
             }
@@ -266,38 +486,96 @@ void RequesterImpl::onGetValuesResult(const MsgGetValuesResult& msg)
 
 void RequesterImpl::onUnknownType(std::uint16_t requestId, const MsgUnknownType& msg)
 {
-    notifyAboutError("Received unknown record type: " + std::to_string(msg.unknownTypeValue()));
+    notifyAboutError(ErrorEvent{ErrorCode::UnknownTypeReceived, requestId, 0, msg.unknownTypeValue()});
     sendMessage(requestId, MsgAbortRequest{});
 }
 
 void RequesterImpl::onEndRequest(std::uint16_t requestId, const MsgEndRequest& msg)
 {
+    metrics_.onRequestEnded(msg.protocolStatus());
     doEndRequest(
             requestId,
             msg.protocolStatus() == ProtocolStatus::RequestComplete ? ResponseStatus::Successful
                                                                     : ResponseStatus::Failed);
 }
 
-void RequesterImpl::onStdOut(std::uint16_t requestId, const MsgStdOut& msg)
+void RequesterImpl::onResponseStream(
+        std::uint16_t requestId,
+        std::string_view data,
+        std::string ResponseData::*buffer,
+        std::function<void(std::string_view)> ResponseStreamHandler::*streamHandler)
 {
-    responseMap_.at(requestId).responseData.data += msg.data();
+    auto& responseContext = responseMap_.at(requestId);
+    if (responseContext.isTimedOut)
+        return;
+    // the handler can cancel the request, so it's kept alive until the call returns
+    if (auto responseStreamHandler = responseContext.responseHandlers.responseStreamHandler) {
+        if (!data.empty() && (*responseStreamHandler).*streamHandler)
+            ((*responseStreamHandler).*streamHandler)(data);
+        return;
+    }
+    responseContext.responseData.*buffer += data;
 }
 
-void RequesterImpl::onStdErr(std::uint16_t requestId, const MsgStdErr& msg)
+void RequesterImpl::setErrorInfoHandler(const std::function<void(const std::string&)>& handler)
 {
-    responseMap_.at(requestId).responseData.errorMsg += msg.data();
+    errorInfoHandler_ = handler;
 }
 
-void RequesterImpl::setErrorInfoHandler(const std::function<void(const std::string&)>& handler)
+void RequesterImpl::setErrorEventHandler(const std::function<void(const ErrorEvent&)>& handler)
 {
-    errorInfoHandler_ = handler;
-    recordReader_.setErrorInfoHandler(errorInfoHandler_);
+    errorEventHandler_ = handler;
+}
+
+void RequesterImpl::setThreadLocalSerializationBufferEnabled(bool state)
+{
+    threadLocalSerializationBufferEnabled_ = state;
+}
+
+bool RequesterImpl::isThreadLocalSerializationBufferEnabled() const
+{
+    return threadLocalSerializationBufferEnabled_;
+}
+
+void RequesterImpl::setMetrics(std::shared_ptr<Metrics> metrics)
+{
+    metrics_.setMetrics(std::move(metrics));
+    updateMetricsGauges();
+}
+
+void RequesterImpl::setTimerWheel(std::shared_ptr<TimerWheel> timerWheel)
+{
+    timerWheel_ = std::move(timerWheel);
+}
+
+void RequesterImpl::setResponseTimeout(std::chrono::milliseconds timeout)
+{
+    cfg_.responseTimeout = timeout;
+}
+
+std::chrono::milliseconds RequesterImpl::responseTimeout() const
+{
+    return cfg_.responseTimeout;
+}
+
+void RequesterImpl::updateMetricsGauges()
+{
+    if (!metrics_.isEnabled())
+        return;
+    auto bufferedBytes = std::size_t{};
+    for (const auto& [requestId, responseContext] : responseMap_)
+        bufferedBytes += responseContext.responseData.data.size() + responseContext.responseData.errorMsg.size();
+    metrics_.setActiveRequestsNumber(responseMap_.size());
+    metrics_.setBufferedBytes(bufferedBytes);
 }
 
-void RequesterImpl::notifyAboutError(const std::string& errorMsg)
+void RequesterImpl::notifyAboutError(const ErrorEvent& event)
 {
+    metrics_.onError(event);
+    if (errorEventHandler_)
+        errorEventHandler_(event);
     if (errorInfoHandler_)
-        errorInfoHandler_(errorMsg);
+        errorInfoHandler_(toString(event));
 }
 
 int RequesterImpl::maximumConnectionsNumber() const
@@ -1,8 +1,12 @@
 #pragma once
+#include "connectionmetrics.h"
 #include "datawriterstream.h"
 #include "recordreader.h"
 #include "streamdatamessage.h"
 #include <fcgi_responder/requester.h>
+#include <fcgi_responder/requestparams.h>
+#include <fcgi_responder/timerwheel.h>
+#include <chrono>
 #include <functional>
 #include <map>
 #include <memory>
@@ -10,6 +14,7 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
 
 namespace fcgi {
 class RecordReader;
@@ -20,6 +25,15 @@ class MsgGetValuesResult;
 class MsgUnknownType;
 class MsgEndRequest;
 
+// a request has either the handler of the whole response, or the handlers of the response stream
+struct ResponseHandlers {
+    std::function<void(std::optional<ResponseData>)> responseHandler;
+    // shared, so the handlers can cancel the request while they are called
+    std::shared_ptr<ResponseStreamHandler> responseStreamHandler;
+
+    void endResponse(std::optional<ResponseData> response) const;
+};
+
 class RequesterImpl {
     enum class ConnectionState {
         NotConnected,
@@ -34,14 +48,32 @@ class RequesterImpl {
     };
 
 public:
-    RequesterImpl(std::function<void(const std::string&)> sendData, std::function<void()> disconnect);
+    RequesterImpl(
+            std::function<void(const std::string&)> sendData,
+            std::function<void()> disconnect,
+            std::function<bool()> isWritable);
     void receiveData(const char* data, std::size_t size);
+    void onWritable();
     std::optional<RequestHandle> sendRequest(
-            std::map<std::string, std::string> params,
+            const RequestParams& params,
             std::string data,
-            const std::function<void(std::optional<ResponseData>)>& responseHandler,
+            const ResponseHandlers& responseHandlers,
+            bool keepConnection = false,
+            const std::shared_ptr<RequestDataStream>& requestDataStream = nullptr);
+    std::optional<RequestDataWriter> startRequest(
+            const RequestParams& params,
+            const ResponseHandlers& responseHandlers,
             bool keepConnection = false);
+    void sendRequestData(std::uint16_t requestId, std::string_view data, bool isEnd);
+    bool isWritable() const;
     void setErrorInfoHandler(const std::function<void(const std::string&)>& handler);
+    void setErrorEventHandler(const std::function<void(const ErrorEvent&)>& handler);
+    void setThreadLocalSerializationBufferEnabled(bool state);
+    bool isThreadLocalSerializationBufferEnabled() const;
+    void setMetrics(std::shared_ptr<Metrics> metrics);
+    void setTimerWheel(std::shared_ptr<TimerWheel> timerWheel);
+    void setResponseTimeout(std::chrono::milliseconds timeout);
+    std::chrono::milliseconds responseTimeout() const;
 
     int availableRequestsNumber() const;
     int maximumConnectionsNumber() const;
@@ -50,45 +82,63 @@ public:
 
 private:
     void initConnection(
-            std::map<std::string, std::string> params,
+            RequestParams params,
             std::string data,
-            std::function<void(std::optional<ResponseData>)> responseHandler,
-            bool keepConnection);
+            ResponseHandlers responseHandlers,
+            bool keepConnection,
+            std::shared_ptr<RequestDataStream> requestDataStream);
     std::optional<RequestHandle> doSendRequest(
-            const std::map<std::string, std::string>& params,
+            const RequestParams& params,
             const std::string& data,
-            std::function<void(std::optional<ResponseData>)> responseHandler,
-            bool keepConnection);
+            ResponseHandlers responseHandlers,
+            bool keepConnection,
+            std::shared_ptr<RequestDataStream> requestDataStream);
     void doEndRequest(std::uint16_t requestId, ResponseStatus responseStatus);
+    void armTimer(TimerWheel::Timer& timer);
+    void onConnectionTimeout();
+    void onResponseTimeout(std::uint16_t requestId);
     void onRecordRead(const Record& record);
     template<typename TMsg>
     void sendMessage(std::uint16_t requestId, TMsg&& msg);
-    void notifyAboutError(const std::string& errorMsg);
+    void notifyAboutError(const ErrorEvent& event);
     void sendRecord(const Record& record);
+    void sendParams(std::uint16_t requestId, std::string_view params);
+    void sendParamsRecord(std::uint16_t requestId, std::string_view data);
     bool isRecordExpected(const Record& record);
     void onGetValuesResult(const MsgGetValuesResult& msg);
     void onUnknownType(std::uint16_t requestId, const MsgUnknownType& msg);
     void onEndRequest(std::uint16_t requestId, const MsgEndRequest& msg);
-    void onStdOut(std::uint16_t requestId, const MsgStdOut& msg);
-    void onStdErr(std::uint16_t requestId, const MsgStdErr& msg);
+    void onResponseStream(
+            std::uint16_t requestId,
+            std::string_view data,
+            std::string ResponseData::*buffer,
+            std::function<void(std::string_view)> ResponseStreamHandler::*streamHandler);
+    void updateMetricsGauges();
 
 private:
     struct Config {
         int maxConnectionsNumber = 1;
         int maxRequestsNumber = 10;
         bool multiplexingEnabled = true;
+        std::chrono::milliseconds responseTimeout{};
     } cfg_;
 
     struct ResponseContext {
-        std::function<void(std::optional<ResponseData>)> responseHandler;
+        ResponseHandlers responseHandlers;
         ResponseData responseData;
         bool keepConnection = false;
         std::shared_ptr<std::function<void()>> cancelRequestHandler;
+        TimerWheel::Timer responseTimer;
+        // set if the request data is streamed with RequestDataWriter
+        std::shared_ptr<RequestDataStream> requestDataStream;
+        // the request is aborted after the timeout, and its handler is already called
+        bool isTimedOut = false;
     };
 
     RecordReader recordReader_;
     DataWriterStream recordStream_;
     std::function<void(const std::string&)> errorInfoHandler_;
+    std::function<void(const ErrorEvent&)> errorEventHandler_;
     std::function<void()> onConnectionFail_;
     std::function<void()> onConnectionSuccess_;
     std::shared_ptr<std::function<void()>> connectionOpeningRequestCancelHandler_;
@@ -97,6 +147,12 @@ private:
     std::map<std::uint16_t, ResponseContext> responseMap_;
     std::function<void(const std::string&)> sendData_;
     std::function<void()> disconnect_;
+    std::function<bool()> isWritable_;
+    bool threadLocalSerializationBufferEnabled_ = false;
+    ConnectionMetrics metrics_;
+    std::shared_ptr<TimerWheel> timerWheel_;
+    // limits the waiting for the FCGI_GET_VALUES_RESULT record when the connection is initialized
+    TimerWheel::Timer connectionTimer_;
 };
 
 } //namespace fcgi
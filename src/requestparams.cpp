@@ -0,0 +1,52 @@
+#include <fcgi_responder/requestparams.h>
+#include <cstdint>
+
+namespace fcgi {
+
+namespace {
+
+void appendLength(std::string& output, std::size_t size)
+{
+    if (size <= 127) {
+        output.push_back(static_cast<char>(size));
+        return;
+    }
+    const auto length = static_cast<std::uint32_t>(size) | 0x80000000;
+    output.push_back(static_cast<char>((length >> 24) & 0xff));
+    output.push_back(static_cast<char>((length >> 16) & 0xff));
+    output.push_back(static_cast<char>((length >> 8) & 0xff));
+    output.push_back(static_cast<char>(length & 0xff));
+}
+
+} //namespace
+
+RequestParams::RequestParams(std::initializer_list<std::pair<std::string_view, std::string_view>> params)
+{
+    for (const auto& [name, value] : params)
+        add(name, value);
+}
+
+void RequestParams::add(std::string_view name, std::string_view value)
+{
+    appendLength(data_, name.size());
+    appendLength(data_, value.size());
+    data_ += name;
+    data_ += value;
+}
+
+void RequestParams::clear()
+{
+    data_.clear();
+}
+
+bool RequestParams::isEmpty() const
+{
+    return data_.empty();
+}
+
+std::string_view RequestParams::data() const
+{
+    return data_;
+}
+
+} //namespace fcgi
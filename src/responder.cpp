@@ -10,6 +10,14 @@ Responder::Responder()
               {
                   sendData(data);
               },
+              [this](const std::string& data)
+              {
+                  return trySendData(data);
+              },
+              [this](const FileRegion& fileRegion)
+              {
+                  return trySendFileData(fileRegion);
+              },
               [this]()
               {
                   disconnect();
@@ -38,6 +46,33 @@ void Responder::receiveData(const char* data, std::size_t size)
     impl().receiveData(data, size);
 }
 
+void Responder::onWritable()
+{
+    impl().onWritable();
+}
+
+void Responder::reset()
+{
+    impl().reset();
+}
+
+void Responder::sendFileData(const FileRegion& fileRegion)
+{
+    impl().readAndSendFileData(fileRegion);
+}
+
+std::size_t Responder::trySendData(const std::string& data)
+{
+    sendData(data);
+    return data.size();
+}
+
+std::size_t Responder::trySendFileData(const FileRegion& fileRegion)
+{
+    sendFileData(fileRegion);
+    return fileRegion.size;
+}
+
 void Responder::setMaximumConnectionsNumber(int value)
 {
     impl().setMaximumConnectionsNumber(value);
@@ -53,11 +88,83 @@ void Responder::setMultiplexingEnabled(bool state)
     impl().setMultiplexingEnabled(state);
 }
 
+void Responder::setOutputHighWaterMark(std::size_t size)
+{
+    impl().setOutputHighWaterMark(size);
+}
+
+void Responder::setMaximumRequestParamsSize(std::size_t size)
+{
+    impl().setMaximumRequestParamsSize(size);
+}
+
+void Responder::setMaximumRequestDataSize(std::size_t size)
+{
+    impl().setMaximumRequestDataSize(size);
+}
+
+void Responder::setMaximumConnectionBufferSize(std::size_t size)
+{
+    impl().setMaximumConnectionBufferSize(size);
+}
+
+void Responder::setThreadLocalSerializationBufferEnabled(bool state)
+{
+    impl().setThreadLocalSerializationBufferEnabled(state);
+}
+
+void Responder::setOverloadControl(std::shared_ptr<OverloadControl> overloadControl)
+{
+    impl().setOverloadControl(std::move(overloadControl));
+}
+
+void Responder::setResponderGroup(std::shared_ptr<ResponderGroup> responderGroup)
+{
+    impl().setResponderGroup(std::move(responderGroup));
+}
+
+void Responder::setErrorEventHandler(std::function<void(const ErrorEvent&)> handler)
+{
+    impl().setErrorEventHandler(std::move(handler));
+}
+
+void Responder::setMetrics(std::shared_ptr<Metrics> metrics)
+{
+    impl().setMetrics(std::move(metrics));
+}
+
+void Responder::setTimerWheel(std::shared_ptr<TimerWheel> timerWheel)
+{
+    impl().setTimerWheel(std::move(timerWheel));
+}
+
+void Responder::setRequestReceiveTimeout(std::chrono::milliseconds timeout)
+{
+    impl().setRequestReceiveTimeout(timeout);
+}
+
+void Responder::setRequestProcessingTimeout(std::chrono::milliseconds timeout)
+{
+    impl().setRequestProcessingTimeout(timeout);
+}
+
+void Responder::setIdleConnectionTimeout(std::chrono::milliseconds timeout)
+{
+    impl().setIdleConnectionTimeout(timeout);
+}
+
 void Responder::setErrorInfoHandler(std::function<void(const std::string&)> handler)
 {
     impl().setErrorInfoHandler(std::move(handler));
 }
 
+#ifdef FCGI_RESPONDER_REQUEST_TIMING
+void Responder::setRequestTimingHandler(std::function<void(const RequestTiming&)> handler)
+{
+    impl().setRequestTimingHandler(std::move(handler));
+}
+#endif
+
 int Responder::maximumConnectionsNumber() const
 {
     return impl().maximumConnectionsNumber();
@@ -73,4 +180,59 @@ bool Responder::isMultiplexingEnabled() const
     return impl().isMultiplexingEnabled();
 }
 
+std::size_t Responder::outputHighWaterMark() const
+{
+    return impl().outputHighWaterMark();
+}
+
+std::size_t Responder::outputQueueSize() const
+{
+    return impl().outputQueueSize();
+}
+
+bool Responder::isOutputQueueFull() const
+{
+    return impl().isOutputQueueFull();
+}
+
+std::size_t Responder::maximumRequestParamsSize() const
+{
+    return impl().maximumRequestParamsSize();
+}
+
+std::size_t Responder::maximumRequestDataSize() const
+{
+    return impl().maximumRequestDataSize();
+}
+
+std::size_t Responder::maximumConnectionBufferSize() const
+{
+    return impl().maximumConnectionBufferSize();
+}
+
+bool Responder::isThreadLocalSerializationBufferEnabled() const
+{
+    return impl().isThreadLocalSerializationBufferEnabled();
+}
+
+std::chrono::milliseconds Responder::requestReceiveTimeout() const
+{
+    return impl().requestReceiveTimeout();
+}
+
+std::chrono::milliseconds Responder::requestProcessingTimeout() const
+{
+    return impl().requestProcessingTimeout();
+}
+
+std::chrono::milliseconds Responder::idleConnectionTimeout() const
+{
+    return impl().idleConnectionTimeout();
+}
+
+std::size_t Responder::bufferedRequestDataSize() const
+{
+    return impl().bufferedRequestDataSize();
+}
+
 } //namespace fcgi
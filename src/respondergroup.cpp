@@ -0,0 +1,166 @@
+#include <fcgi_responder/respondergroup.h>
+
+namespace fcgi {
+
+ResponderGroup::ResponderGroup(int maxConnectionsNumber)
+    : maxConnectionsNumber_{maxConnectionsNumber}
+{
+}
+
+bool ResponderGroup::tryAcquireConnection()
+{
+    auto connectionsNumber = connectionsNumber_.load();
+    do {
+        if (connectionsNumber >= maxConnectionsNumber_) {
+            ++rejectedConnectionsNumber_;
+            return false;
+        }
+    } while (!connectionsNumber_.compare_exchange_weak(connectionsNumber, connectionsNumber + 1));
+    return true;
+}
+
+void ResponderGroup::releaseConnection()
+{
+    --connectionsNumber_;
+}
+
+void ResponderGroup::setMaximumConnectionsNumber(int value)
+{
+    maxConnectionsNumber_ = value;
+}
+
+void ResponderGroup::setMaximumRequestsNumber(int value)
+{
+    maxRequestsNumber_ = value;
+}
+
+void ResponderGroup::setMultiplexingEnabled(bool state)
+{
+    multiplexingEnabled_ = state;
+}
+
+void ResponderGroup::setOutputHighWaterMark(std::size_t size)
+{
+    outputHighWaterMark_ = size;
+}
+
+void ResponderGroup::setMaximumRequestParamsSize(std::size_t size)
+{
+    maxRequestParamsSize_ = size;
+}
+
+void ResponderGroup::setMaximumRequestDataSize(std::size_t size)
+{
+    maxRequestDataSize_ = size;
+}
+
+void ResponderGroup::setMaximumConnectionBufferSize(std::size_t size)
+{
+    maxConnectionBufferSize_ = size;
+}
+
+void ResponderGroup::setThreadLocalSerializationBufferEnabled(bool state)
+{
+    threadLocalSerializationBufferEnabled_ = state;
+}
+
+void ResponderGroup::setOverloadControl(std::shared_ptr<OverloadControl> overloadControl)
+{
+    auto lock = std::lock_guard{overloadControlMutex_};
+    overloadControl_ = std::move(overloadControl);
+}
+
+void ResponderGroup::setMetrics(std::shared_ptr<Metrics> metrics)
+{
+    auto lock = std::lock_guard{metricsMutex_};
+    metrics_ = std::move(metrics);
+}
+
+int ResponderGroup::maximumConnectionsNumber() const
+{
+    return maxConnectionsNumber_;
+}
+
+int ResponderGroup::maximumRequestsNumber() const
+{
+    return maxRequestsNumber_;
+}
+
+bool ResponderGroup::isMultiplexingEnabled() const
+{
+    return multiplexingEnabled_;
+}
+
+std::size_t ResponderGroup::outputHighWaterMark() const
+{
+    return outputHighWaterMark_;
+}
+
+std::size_t ResponderGroup::maximumRequestParamsSize() const
+{
+    return maxRequestParamsSize_;
+}
+
+std::size_t ResponderGroup::maximumRequestDataSize() const
+{
+    return maxRequestDataSize_;
+}
+
+std::size_t ResponderGroup::maximumConnectionBufferSize() const
+{
+    return maxConnectionBufferSize_;
+}
+
+bool ResponderGroup::isThreadLocalSerializationBufferEnabled() const
+{
+    return threadLocalSerializationBufferEnabled_;
+}
+
+std::shared_ptr<OverloadControl> ResponderGroup::overloadControl() const
+{
+    auto lock = std::lock_guard{overloadControlMutex_};
+    return overloadControl_;
+}
+
+std::shared_ptr<Metrics> ResponderGroup::metrics() const
+{
+    auto lock = std::lock_guard{metricsMutex_};
+    return metrics_;
+}
+
+int ResponderGroup::connectionsNumber() const
+{
+    return connectionsNumber_;
+}
+
+std::uint64_t ResponderGroup::rejectedConnectionsNumber() const
+{
+    return rejectedConnectionsNumber_;
+}
+
+int ResponderGroup::activeRequestsNumber() const
+{
+    return activeRequestsNumber_;
+}
+
+std::uint64_t ResponderGroup::processedRequestsNumber() const
+{
+    return processedRequestsNumber_;
+}
+
+void ResponderGroup::onRequestStarted()
+{
+    ++activeRequestsNumber_;
+}
+
+void ResponderGroup::onRequestFinished()
+{
+    --activeRequestsNumber_;
+}
+
+void ResponderGroup::onRequestCompleted()
+{
+    ++processedRequestsNumber_;
+}
+
+} //namespace fcgi
@@ -1,5 +1,7 @@
 #include "responderimpl.h"
+#include "cancellationtoken.h"
 #include "constants.h"
+#include "filereader.h"
 #include "msgbeginrequest.h"
 #include "msgendrequest.h"
 #include "msggetvalues.h"
@@ -10,14 +12,27 @@
 #include "streamdatamessage.h"
 #include "streammaker.h"
 #include "types.h"
+#include <fcgi_responder/authorizerresponse.h>
+#include <fcgi_responder/filterstreams.h>
+#include <fcgi_responder/overloadcontrol.h>
+#include <fcgi_responder/respondergroup.h>
 #include <fcgi_responder/request.h>
 #include <fcgi_responder/response.h>
 #include <algorithm>
 
 namespace fcgi {
 
+namespace {
+bool isSizeLimitExceeded(std::size_t size, std::size_t incomingSize, std::size_t sizeLimit)
+{
+    return size > sizeLimit || incomingSize > sizeLimit - size;
+}
+} //namespace
+
 ResponderImpl::ResponderImpl(
         std::function<void(const std::string&)> sendData,
+        std::function<std::size_t(const std::string&)> trySendData,
+        std::function<std::size_t(const FileRegion&)> trySendFileData,
         std::function<void()> disconnect,
         std::function<void(Request&& request, Response&& response)> processRequest)
     : recordReader_{
@@ -29,16 +44,75 @@ ResponderImpl::ResponderImpl(
               {
                   sendMessage(0, MsgUnknownType{recordType});
               }}
-    , recordStream_(hardcoded::maxRecordSize)
     , sendData_{std::move(sendData)}
+    , outputQueue_{std::move(trySendData), std::move(trySendFileData)}
     , disconnect_{std::move(disconnect)}
     , processRequest_{std::move(processRequest)}
     , responseSender_{std::make_shared<ResponseSender>(
-              [this](std::uint16_t id, std::string&& data, std::string&& errorMsg)
+              [this](std::uint64_t connectionGeneration,
+                     std::uint16_t id,
+                     std::string_view data,
+                     std::string&& errorMsg)
+              {
+                  if (connectionGeneration == connectionGeneration_)
+                      sendResponse(id, data, std::move(errorMsg));
+              })}
+    , fileResponseSender_{std::make_shared<FileResponseSender>(
+              [this](std::uint64_t connectionGeneration,
+                     std::uint16_t id,
+                     const FileRegion& fileRegion,
+                     std::string&& errorMsg)
               {
-                  sendResponse(id, std::move(data), std::move(errorMsg));
+                  if (connectionGeneration == connectionGeneration_)
+                      sendFileResponse(id, fileRegion, std::move(errorMsg));
               })}
 {
+    recordReader_.setErrorHandler(
+            [this](const ErrorEvent& event)
+            {
+                notifyAboutError(event);
+            });
+    idleConnectionTimer_.setHandler(
+            [this]
+            {
+                closeConnection();
+            });
+}
+
+ResponderImpl::~ResponderImpl()
+{
+    releaseRequests();
+    if (overloadControl_)
+        overloadControl_->updateOutputQueueSize(reportedOutputQueueSize_, 0);
+}
+
+void ResponderImpl::reset()
+{
+    releaseRequests();
+    discardedRequestIds_.clear();
+    recordReader_.clear();
+    outputQueue_.clear();
+    clearPendingRequestTimings();
+    updateOverloadControlOutputQueueSize();
+    metrics_.detach();
+    isDisconnectRequested_ = false;
+    isConnectionClosing_ = false;
+    ++connectionGeneration_;
+    updateIdleConnectionTimer();
+}
+
+void ResponderImpl::releaseRequests()
+{
+    for (auto& [requestId, requestData] : requestRegistry_)
+        requestData.cancel();
+    for (auto i = std::size_t{}; i < requestRegistry_.size(); ++i) {
+        if (overloadControl_)
+            overloadControl_->releaseRequest();
+        if (responderGroup_)
+            responderGroup_->onRequestFinished();
+    }
+    requestRegistry_.clear();
+    metrics_.setActiveRequestsNumber(0);
 }
 
 template<typename TMsg>
@@ -50,18 +124,51 @@ void ResponderImpl::sendMessage(std::uint16_t requestId, TMsg&& msg)
 template void ResponderImpl::sendMessage<MsgUnknownType>(std::uint16_t requestId, MsgUnknownType&& msg);
 template void ResponderImpl::sendMessage<MsgEndRequest>(std::uint16_t requestId, MsgEndRequest&& msg);
 template void ResponderImpl::sendMessage<MsgGetValuesResult>(std::uint16_t requestId, MsgGetValuesResult&& msg);
+template void ResponderImpl::sendMessage<MsgStdOut>(std::uint16_t requestId, MsgStdOut&& msg);
+template void ResponderImpl::sendMessage<MsgStdErr>(std::uint16_t requestId, MsgStdErr&& msg);
+
+template<typename TMsg>
+void ResponderImpl::sendStreamData(std::uint16_t requestId, std::string_view data)
+{
+    // unlike makeStream, the stream isn't terminated with an empty record
+    while (!data.empty()) {
+        const auto size = std::min<std::size_t>(data.size(), hardcoded::maxDataMessageSize);
+        sendMessage(requestId, TMsg{data.substr(0, size)});
+        data.remove_prefix(size);
+    }
+}
 
 void ResponderImpl::receiveData(const char* data, std::size_t size)
 {
+    metrics_.attach();
+    metrics_.onDataReceived(size);
     recordReader_.read(data, size);
+    updateMetricsGauges();
+}
+
+void ResponderImpl::onWritable()
+{
+    outputQueue_.flush();
+    reportWrittenRequestTimings();
+    updateOverloadControlOutputQueueSize();
+    updateMetricsGauges();
+    if (outputQueue_.empty() && isDisconnectRequested_) {
+        isDisconnectRequested_ = false;
+        disconnect_();
+    }
 }
 
 void ResponderImpl::onRecordRead(const Record& record)
 {
+    metrics_.onRecordReceived(record.type());
+    if (isRecordDiscarded(record))
+        return;
+
     if (!isRecordExpected(record)) {
-        notifyAboutError(
-                "Received unexpected record, RecordType = " + std::to_string(static_cast<int>(record.type())) +
-                ", requestId = " + std::to_string(record.requestId()));
+        notifyAboutError(ErrorEvent{
+                ErrorCode::UnexpectedRecord,
+                record.requestId(),
+                static_cast<std::uint8_t>(record.type())});
         return;
     }
 
@@ -70,6 +177,8 @@ void ResponderImpl::onRecordRead(const Record& record)
         onBeginRequest(record.requestId(), record.getMessage<MsgBeginRequest>());
         break;
     case RecordType::AbortRequest:
+        metrics_.onRequestAborted();
+        requestRegistry_.at(record.requestId()).cancel();
         endRequest(record.requestId());
         break;
     case RecordType::GetValues:
@@ -79,7 +188,14 @@ void ResponderImpl::onRecordRead(const Record& record)
         onParams(record.requestId(), record.getMessage<MsgParams>());
         break;
     case RecordType::StdIn:
-        onStdIn(record.requestId(), record.getMessage<MsgStdIn>());
+        if (role_ == Role::Responder)
+            onStdIn(record.requestId(), record.getMessage<MsgStdIn>());
+        else if (role_ == Role::Filter)
+            onFilterStream(record.requestId(), record.getMessage<MsgStdIn>().data(), &FilterInput::onStdIn);
+        break;
+    case RecordType::Data:
+        if (role_ == Role::Filter)
+            onFilterStream(record.requestId(), record.getMessage<MsgData>().data(), &FilterInput::onData);
         break;
     default:;
     }
@@ -87,22 +203,28 @@ void ResponderImpl::onRecordRead(const Record& record)
 
 void ResponderImpl::onBeginRequest(std::uint16_t requestId, const MsgBeginRequest& msg)
 {
-    if (msg.role() != Role::Responder) {
+    if (msg.role() != role_) {
         sendMessage(requestId, MsgEndRequest{0, ProtocolStatus::UnknownRole});
+        metrics_.onRequestEnded(ProtocolStatus::UnknownRole);
         if (msg.resultConnectionState() == ResultConnectionState::Close)
-            disconnect_();
+            closeConnection();
         return;
     }
     if (!cfg_.multiplexingEnabled && !requestRegistry_.empty() && !requestRegistry_.count(requestId)) {
         sendMessage(requestId, MsgEndRequest{0, ProtocolStatus::CantMpxConn});
+        metrics_.onRequestEnded(ProtocolStatus::CantMpxConn);
         if (msg.resultConnectionState() == ResultConnectionState::Close)
-            disconnect_();
+            closeConnection();
         return;
     }
-    if (static_cast<int>(requestRegistry_.size()) == cfg_.maxRequestsNumber && !requestRegistry_.count(requestId)) {
+    const auto isOverloaded =
+            static_cast<int>(requestRegistry_.size()) == cfg_.maxRequestsNumber || isOutputQueueFull() ||
+            (overloadControl_ && !overloadControl_->tryAcquireRequest());
+    if (isOverloaded && !requestRegistry_.count(requestId)) {
         sendMessage(requestId, MsgEndRequest{0, ProtocolStatus::Overloaded});
+        metrics_.onRequestEnded(ProtocolStatus::Overloaded);
         if (msg.resultConnectionState() == ResultConnectionState::Close)
-            disconnect_();
+            closeConnection();
         return;
     }
 
@@ -112,20 +234,130 @@ void ResponderImpl::onBeginRequest(std::uint16_t requestId, const MsgBeginReques
 void ResponderImpl::endRequest(std::uint16_t requestId)
 {
     sendMessage(requestId, MsgEndRequest{0, ProtocolStatus::RequestComplete});
+    completeRequest(requestId);
+}
+
+void ResponderImpl::completeRequest(std::uint16_t requestId)
+{
+    metrics_.onRequestEnded(ProtocolStatus::RequestComplete);
+    reportRequestTiming(requestId);
+    if (responderGroup_)
+        responderGroup_->onRequestCompleted();
     if (!requestRegistry_.at(requestId).keepConnection())
-        disconnect_();
+        closeConnection();
+
+    deleteRequest(requestId);
+}
+
+void ResponderImpl::closeConnection()
+{
+    isConnectionClosing_ = true;
+    idleConnectionTimer_.cancel();
+    if (!outputQueue_.empty()) {
+        isDisconnectRequested_ = true;
+        return;
+    }
+    disconnect_();
+}
+
+void ResponderImpl::rejectRequest(std::uint16_t requestId)
+{
+    notifyAboutError(ErrorEvent{ErrorCode::RequestDataSizeExceeded, requestId});
+    sendMessage(requestId, MsgEndRequest{0, ProtocolStatus::Overloaded});
+    metrics_.onRequestEnded(ProtocolStatus::Overloaded);
+    if (!requestRegistry_.at(requestId).keepConnection())
+        closeConnection();
 
     deleteRequest(requestId);
+    discardedRequestIds_.insert(requestId);
+}
+
+bool ResponderImpl::isRecordDiscarded(const Record& record)
+{
+    if (discardedRequestIds_.empty() || !discardedRequestIds_.count(record.requestId()))
+        return false;
+
+    switch (record.type()) {
+    case RecordType::Params:
+        return true;
+    case RecordType::StdIn:
+        // filters receive the data stream after the request data
+        if (record.getMessage<MsgStdIn>().data().empty() && role_ != Role::Filter)
+            discardedRequestIds_.erase(record.requestId());
+        return true;
+    case RecordType::Data:
+        if (record.getMessage<MsgData>().data().empty())
+            discardedRequestIds_.erase(record.requestId());
+        return true;
+    default:
+        discardedRequestIds_.erase(record.requestId());
+        return false;
+    }
+}
+
+bool ResponderImpl::isBufferSizeExceeded(
+        std::size_t requestDataSize,
+        std::size_t requestDataSizeLimit,
+        std::size_t incomingSize) const
+{
+    return isSizeLimitExceeded(requestDataSize, incomingSize, requestDataSizeLimit) ||
+            isSizeLimitExceeded(bufferedRequestDataSize(), incomingSize, cfg_.maxConnectionBufferSize);
 }
 
 void ResponderImpl::createRequest(std::uint16_t requestId, bool keepConnection)
 {
-    requestRegistry_.emplace(requestId, RequestData{keepConnection});
+    auto& requestData = requestRegistry_.emplace(requestId, RequestData{keepConnection}).first->second;
+    markRequestTime(requestData, &RequestTiming::beginRequestReceived);
+    requestData.timeoutTimer().setHandler(
+            [this, requestId]
+            {
+                onRequestTimeout(requestId);
+            });
+    armRequestTimer(requestData, cfg_.requestReceiveTimeout);
+    idleConnectionTimer_.cancel();
+    metrics_.onRequestStarted();
+    metrics_.setActiveRequestsNumber(requestRegistry_.size());
+    if (responderGroup_)
+        responderGroup_->onRequestStarted();
 }
 
 void ResponderImpl::deleteRequest(std::uint16_t requestId)
 {
     requestRegistry_.erase(requestId);
+    metrics_.setActiveRequestsNumber(requestRegistry_.size());
+    if (overloadControl_)
+        overloadControl_->releaseRequest();
+    if (responderGroup_)
+        responderGroup_->onRequestFinished();
+    updateIdleConnectionTimer();
+}
+
+void ResponderImpl::armRequestTimer(RequestData& requestData, std::chrono::milliseconds timeout)
+{
+    if (timerWheel_ && timeout.count() > 0)
+        timerWheel_->arm(requestData.timeoutTimer(), timeout);
+    else
+        requestData.timeoutTimer().cancel();
+}
+
+void ResponderImpl::onRequestTimeout(std::uint16_t requestId)
+{
+    auto& requestData = requestRegistry_.at(requestId);
+    notifyAboutError(ErrorEvent{ErrorCode::RequestTimeout, requestId});
+    requestData.cancel();
+    // the rest of the request data that can still be sent by the web server is ignored
+    if (!requestData.isProcessingStarted() || (role_ == Role::Filter && !requestData.isDataStreamEnded()))
+        discardedRequestIds_.insert(requestId);
+    endRequest(requestId);
+    updateMetricsGauges();
+}
+
+void ResponderImpl::updateIdleConnectionTimer()
+{
+    if (timerWheel_ && cfg_.idleConnectionTimeout.count() > 0 && requestRegistry_.empty() && !isConnectionClosing_)
+        timerWheel_->arm(idleConnectionTimer_, cfg_.idleConnectionTimeout);
+    else
+        idleConnectionTimer_.cancel();
 }
 
 void ResponderImpl::onGetValues(const MsgGetValues& msg)
@@ -134,10 +366,14 @@ void ResponderImpl::onGetValues(const MsgGetValues& msg)
     for (auto request : msg.requestList()) {
         switch (request) {
         case ValueRequest::MaxConns:
-            result.setRequestValue(request, std::to_string(cfg_.maxConnectionsNumber));
+            result.setRequestValue(request, std::to_string(maximumConnectionsNumber()));
             break;
         case ValueRequest::MaxReqs:
-            result.setRequestValue(request, std::to_string(cfg_.maxRequestsNumber));
+            result.setRequestValue(
+                    request,
+                    std::to_string(
+                            overloadControl_ ? std::min(cfg_.maxRequestsNumber, overloadControl_->requestsLimit())
+                                             : cfg_.maxRequestsNumber));
             break;
         case ValueRequest::MpxsConns:
             result.setRequestValue(request, cfg_.multiplexingEnabled ? "1" : "0");
@@ -149,27 +385,231 @@ void ResponderImpl::onGetValues(const MsgGetValues& msg)
 
 void ResponderImpl::onParams(std::uint16_t requestId, const MsgParams& msg)
 {
-    requestRegistry_.at(requestId).addMessage(msg);
+    auto& requestData = requestRegistry_.at(requestId);
+    if (isBufferSizeExceeded(requestData.paramsSize(), cfg_.maxRequestParamsSize, msg.size())) {
+        rejectRequest(requestId);
+        return;
+    }
+    requestData.addMessage(msg);
+    if (msg.paramList().empty()) {
+        markRequestTime(requestData, &RequestTiming::paramsReceived);
+        // authorizers don't receive the request data, and filters receive it as a stream
+        if (role_ != Role::Responder)
+            onRequestReceived(requestId);
+    }
 }
 
 void ResponderImpl::onStdIn(std::uint16_t requestId, const MsgStdIn& msg)
 {
-    requestRegistry_.at(requestId).addMessage(msg);
-    if (msg.data().empty())
+    auto& requestData = requestRegistry_.at(requestId);
+    if (isBufferSizeExceeded(requestData.stdInSize(), cfg_.maxRequestDataSize, msg.size())) {
+        rejectRequest(requestId);
+        return;
+    }
+    requestData.addMessage(msg);
+    if (msg.data().empty()) {
+        markRequestTime(requestData, &RequestTiming::stdInReceived);
         onRequestReceived(requestId);
+    }
+}
+
+void ResponderImpl::onFilterStream(
+        std::uint16_t requestId,
+        std::string_view data,
+        std::function<void(std::string_view)> FilterInput::*streamHandler)
+{
+    auto& requestData = requestRegistry_.at(requestId);
+    if (data.empty()) {
+        if (streamHandler == &FilterInput::onStdIn)
+            markRequestTime(requestData, &RequestTiming::stdInReceived);
+        else
+            requestData.setDataStreamEnded();
+    }
+    // the handler can end the request, so its input is kept alive until the call returns
+    auto input = requestData.filterInput();
+    if (input && (*input).*streamHandler)
+        ((*input).*streamHandler)(data);
 }
 
 void ResponderImpl::sendRecord(const Record& record)
 {
-    recordStream_.resetBuffer(record.size());
+    auto scratchStream = ScratchDataWriterStream{recordStream_, cfg_.threadLocalSerializationBufferEnabled};
+    auto& recordStream = scratchStream.get();
+    recordStream.resetBuffer(record.size());
     try {
-        record.toStream(recordStream_);
+        record.toStream(recordStream);
     }
     catch (std::exception& e) {
-        notifyAboutError(e.what());
+        notifyAboutError(ErrorEvent{
+                ErrorCode::RecordSerializationError,
+                record.requestId(),
+                static_cast<std::uint8_t>(record.type()),
+                0,
+                e.what()});
+        return;
+    }
+    metrics_.onRecordSent(record.type());
+    writeOutput(recordStream.buffer());
+}
+
+void ResponderImpl::sendRecords(const std::vector<Record>& records)
+{
+    auto scratchStream = ScratchDataWriterStream{recordStream_, cfg_.threadLocalSerializationBufferEnabled};
+    auto& recordStream = scratchStream.get();
+    auto size = std::size_t{};
+    for (const auto& record : records)
+        size += record.size();
+    recordStream.resetBuffer(size);
+    for (const auto& record : records) {
+        try {
+            record.toStream(recordStream);
+        }
+        catch (std::exception& e) {
+            notifyAboutError(ErrorEvent{
+                    ErrorCode::RecordSerializationError,
+                    record.requestId(),
+                    static_cast<std::uint8_t>(record.type()),
+                    0,
+                    e.what()});
+            return;
+        }
+    }
+    for (const auto& record : records)
+        metrics_.onRecordSent(record.type());
+    writeOutput(recordStream.buffer());
+}
+
+void ResponderImpl::sendRecordHeader(RecordType type, std::uint16_t requestId, std::uint16_t contentLength)
+{
+    auto scratchStream = ScratchDataWriterStream{recordStream_, cfg_.threadLocalSerializationBufferEnabled};
+    auto& recordStream = scratchStream.get();
+    recordStream.resetBuffer(hardcoded::headerSize);
+    writeRecordHeader(recordStream, type, requestId, contentLength, 0);
+    metrics_.onRecordSent(type);
+    writeOutput(recordStream.buffer());
+}
+
+void ResponderImpl::writeOutput(const std::string& data)
+{
+    metrics_.onDataSent(data.size());
+    addWrittenOutputSize(data.size());
+    outputQueue_.write(data);
+    updateOverloadControlOutputQueueSize();
+}
+
+void ResponderImpl::writeOutput(const FileRegion& fileRegion)
+{
+    metrics_.onDataSent(fileRegion.size);
+    addWrittenOutputSize(fileRegion.size);
+    outputQueue_.write(fileRegion);
+    updateOverloadControlOutputQueueSize();
+}
+
+void ResponderImpl::updateOverloadControlOutputQueueSize()
+{
+    if (!overloadControl_ || reportedOutputQueueSize_ == outputQueue_.size())
+        return;
+    overloadControl_->updateOutputQueueSize(reportedOutputQueueSize_, outputQueue_.size());
+    reportedOutputQueueSize_ = outputQueue_.size();
+}
+
+void ResponderImpl::updateMetricsGauges()
+{
+    if (!metrics_.isEnabled())
+        return;
+    metrics_.setActiveRequestsNumber(requestRegistry_.size());
+    metrics_.setBufferedBytes(bufferedRequestDataSize() + outputQueue_.size());
+}
+
+void ResponderImpl::reportProcessingLatency(std::uint16_t requestId)
+{
+    if (!overloadControl_)
+        return;
+    auto processingStartTime = requestRegistry_.at(requestId).processingStartTime();
+    if (!processingStartTime)
+        return;
+    overloadControl_->addLatencySample(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - *processingStartTime));
+}
+
+void ResponderImpl::markRequestTime(
+        [[maybe_unused]] RequestData& requestData,
+        [[maybe_unused]] RequestTiming::TimePoint RequestTiming::*timePoint)
+{
+#ifdef FCGI_RESPONDER_REQUEST_TIMING
+    if (requestTimingHandler_)
+        requestData.timing().*timePoint = std::chrono::steady_clock::now();
+#endif
+}
+
+void ResponderImpl::addWrittenOutputSize([[maybe_unused]] std::size_t size)
+{
+#ifdef FCGI_RESPONDER_REQUEST_TIMING
+    writtenOutputSize_ += size;
+#endif
+}
+
+void ResponderImpl::reportRequestTiming([[maybe_unused]] std::uint16_t requestId)
+{
+#ifdef FCGI_RESPONDER_REQUEST_TIMING
+    if (!requestTimingHandler_)
         return;
+    auto& timing = requestRegistry_.at(requestId).timing();
+    // aborted requests don't have a response
+    if (timing.responseSent == RequestTiming::TimePoint{})
+        return;
+    timing.requestId = requestId;
+    if (!outputQueue_.empty()) {
+        pendingRequestTimings_.emplace_back(writtenOutputSize_, timing);
+        return;
+    }
+    timing.outputWritten = std::chrono::steady_clock::now();
+    requestTimingHandler_(timing);
+#endif
+}
+
+void ResponderImpl::reportWrittenRequestTimings()
+{
+#ifdef FCGI_RESPONDER_REQUEST_TIMING
+    const auto sentOutputSize = writtenOutputSize_ - outputQueue_.size();
+    while (!pendingRequestTimings_.empty() && pendingRequestTimings_.front().first <= sentOutputSize) {
+        auto& timing = pendingRequestTimings_.front().second;
+        timing.outputWritten = std::chrono::steady_clock::now();
+        if (requestTimingHandler_)
+            requestTimingHandler_(timing);
+        pendingRequestTimings_.pop_front();
     }
-    sendData_(recordStream_.buffer());
+#endif
+}
+
+void ResponderImpl::clearPendingRequestTimings()
+{
+#ifdef FCGI_RESPONDER_REQUEST_TIMING
+    writtenOutputSize_ = 0;
+    pendingRequestTimings_.clear();
+#endif
+}
+
+void ResponderImpl::readAndSendFileData(const FileRegion& fileRegion)
+{
+    auto data = readFileRegion(fileRegion);
+    if (!data) {
+        notifyAboutError(ErrorEvent{
+                ErrorCode::FileReadError,
+                0,
+                0,
+                static_cast<std::uint64_t>(fileRegion.fileDescriptor)});
+        outputQueue_.clear();
+        clearPendingRequestTimings();
+        updateOverloadControlOutputQueueSize();
+        isConnectionClosing_ = true;
+        idleConnectionTimer_.cancel();
+        // like after reset(), the responses of the torn down connection aren't sent
+        ++connectionGeneration_;
+        disconnect_();
+        return;
+    }
+    sendData_(*data);
 }
 
 bool ResponderImpl::isRecordExpected(const Record& record)
@@ -177,6 +617,9 @@ bool ResponderImpl::isRecordExpected(const Record& record)
     const auto requestRegistered = requestRegistry_.count(record.requestId()) != 0;
     if (record.type() == RecordType::GetValues)
         return true;
+    // authorizers ignore the request data stream, which can be sent by the web server after the response
+    if (record.type() == RecordType::StdIn && role_ == Role::Authorizer)
+        return true;
     if (record.type() == RecordType::BeginRequest && !requestRegistered)
         return true;
     if (record.type() != RecordType::BeginRequest && requestRegistered)
@@ -186,25 +629,89 @@ bool ResponderImpl::isRecordExpected(const Record& record)
 
 void ResponderImpl::onRequestReceived(std::uint16_t requestId)
 {
-    auto request = requestRegistry_.at(requestId).makeRequest();
+    auto& requestData = requestRegistry_.at(requestId);
+    auto request = requestData.makeRequest();
     if (!request)
         return;
+    if (overloadControl_)
+        requestData.setProcessingStartTime(std::chrono::steady_clock::now());
+    markRequestTime(requestData, &RequestTiming::processingStarted);
+    armRequestTimer(requestData, cfg_.requestProcessingTimeout);
+
+    if (role_ == Role::Authorizer) {
+        authorizeRequest_(
+                std::move(*request),
+                AuthorizerResponse{
+                        [requestId,
+                         connectionGeneration = connectionGeneration_,
+                         responseSenderObserver = std::weak_ptr{authorizerResponseSender_}](std::string&& headers)
+                        {
+                            if (auto responseSender = responseSenderObserver.lock())
+                                (*responseSender)(connectionGeneration, requestId, headers);
+                        },
+                        requestData.cancellationToken()});
+        return;
+    }
+
+    if (role_ == Role::Filter) {
+        auto input = filterRequest_(
+                std::move(*request),
+                FilterOutput{
+                        [requestId,
+                         connectionGeneration = connectionGeneration_,
+                         outputSenderObserver = std::weak_ptr{filterOutputSender_}](
+                                std::string_view data,
+                                std::string_view errorData,
+                                bool isEnd)
+                        {
+                            if (auto outputSender = outputSenderObserver.lock())
+                                (*outputSender)(connectionGeneration, requestId, data, errorData, isEnd);
+                        },
+                        requestData.cancellationToken()});
+        // the output can be already ended by the handler
+        auto requestIt = requestRegistry_.find(requestId);
+        if (requestIt != requestRegistry_.end())
+            requestIt->second.setFilterInput(std::move(input));
+        return;
+    }
 
     processRequest_(
             std::move(*request),
-            Response{[requestId, responseSenderObserver = std::weak_ptr{responseSender_}](
-                             std::string&& data,
-                             std::string&& errorMsg)
-                     {
-                         if (auto responseSender = responseSenderObserver.lock())
-                             (*responseSender)(requestId, std::move(data), std::move(errorMsg));
-                     }});
+            Response{
+                    [requestId,
+                     connectionGeneration = connectionGeneration_,
+                     responseSenderObserver = std::weak_ptr{responseSender_}](
+                            std::string&& data,
+                            std::string&& errorMsg)
+                    {
+                        if (auto responseSender = responseSenderObserver.lock())
+                            (*responseSender)(connectionGeneration, requestId, data, std::move(errorMsg));
+                    },
+                    [requestId,
+                     connectionGeneration = connectionGeneration_,
+                     fileResponseSenderObserver = std::weak_ptr{fileResponseSender_}](
+                            const FileRegion& fileRegion,
+                            std::string&& errorMsg)
+                    {
+                        if (auto fileResponseSender = fileResponseSenderObserver.lock())
+                            (*fileResponseSender)(connectionGeneration, requestId, fileRegion, std::move(errorMsg));
+                    },
+                    [requestId,
+                     connectionGeneration = connectionGeneration_,
+                     responseSenderObserver = std::weak_ptr{responseSender_}](
+                            const std::shared_ptr<const std::string>& data,
+                            std::string&& errorMsg)
+                    {
+                        if (auto responseSender = responseSenderObserver.lock())
+                            (*responseSender)(connectionGeneration, requestId, *data, std::move(errorMsg));
+                    },
+                    requestData.cancellationToken()});
 }
 
-void ResponderImpl::sendResponse(std::uint16_t id, std::string&& data, std::string&& errorMsg)
+void ResponderImpl::sendResponse(std::uint16_t id, std::string_view data, std::string&& errorMsg)
 {
+    markRequestTime(requestRegistry_.at(id), &RequestTiming::responseSent);
     auto dataStream = makeStream<MsgStdOut>(id, data);
-    auto errorStream = makeStream<MsgStdErr>(id, errorMsg);
     std::for_each(
             dataStream.begin(),
             dataStream.end(),
@@ -212,6 +719,81 @@ void ResponderImpl::sendResponse(std::uint16_t id, std::string&& data, std::stri
             {
                 sendRecord(record);
             });
+    sendErrorStream(id, errorMsg);
+    reportProcessingLatency(id);
+    endRequest(id);
+    updateMetricsGauges();
+}
+
+void ResponderImpl::sendFileResponse(std::uint16_t id, const FileRegion& fileRegion, std::string&& errorMsg)
+{
+    markRequestTime(requestRegistry_.at(id), &RequestTiming::responseSent);
+    auto chunk = FileRegion{fileRegion.fileDescriptor, fileRegion.offset, 0};
+    const auto fileRegionEnd = fileRegion.offset + fileRegion.size;
+    const auto connectionGeneration = connectionGeneration_;
+    while (chunk.offset < fileRegionEnd) {
+        chunk.size = std::min<std::size_t>(fileRegionEnd - chunk.offset, hardcoded::maxDataMessageSize);
+        sendRecordHeader(RecordType::StdOut, id, static_cast<std::uint16_t>(chunk.size));
+        writeOutput(chunk);
+        // the connection is closed if the file data can't be read, so the request is abandoned
+        if (connectionGeneration != connectionGeneration_) {
+            deleteRequest(id);
+            updateMetricsGauges();
+            return;
+        }
+        chunk.offset += chunk.size;
+    }
+    sendMessage(id, MsgStdOut{});
+    sendErrorStream(id, errorMsg);
+    reportProcessingLatency(id);
+    endRequest(id);
+    updateMetricsGauges();
+}
+
+void ResponderImpl::sendAuthorizerResponse(std::uint16_t id, const std::string& headers)
+{
+    if (!requestRegistry_.count(id))
+        return;
+    markRequestTime(requestRegistry_.at(id), &RequestTiming::responseSent);
+    // the response is small, so its records are written to the output at once
+    auto records = makeStream<MsgStdOut>(id, headers);
+    records.emplace_back(MsgStdErr{}, id);
+    records.emplace_back(MsgEndRequest{0, ProtocolStatus::RequestComplete}, id);
+    sendRecords(records);
+    reportProcessingLatency(id);
+    completeRequest(id);
+    updateMetricsGauges();
+}
+
+void ResponderImpl::sendFilterOutput(
+        std::uint16_t id,
+        std::string_view data,
+        std::string_view errorData,
+        bool isEnd)
+{
+    auto requestIt = requestRegistry_.find(id);
+    if (requestIt == requestRegistry_.end())
+        return;
+    sendStreamData<MsgStdOut>(id, data);
+    sendStreamData<MsgStdErr>(id, errorData);
+    if (!isEnd) {
+        updateMetricsGauges();
+        return;
+    }
+
+    markRequestTime(requestIt->second, &RequestTiming::responseSent);
+    if (!requestIt->second.isDataStreamEnded())
+        discardedRequestIds_.insert(id);
+    sendMessage(id, MsgStdOut{});
+    sendMessage(id, MsgStdErr{});
+    reportProcessingLatency(id);
+    endRequest(id);
+    updateMetricsGauges();
+}
+
+void ResponderImpl::sendErrorStream(std::uint16_t id, const std::string& errorMsg)
+{
+    auto errorStream = makeStream<MsgStdErr>(id, errorMsg);
     std::for_each(
             errorStream.begin(),
             errorStream.end(),
@@ -219,7 +801,6 @@ void ResponderImpl::sendResponse(std::uint16_t id, std::string&& data, std::stri
             {
                 sendRecord(record);
             });
-    endRequest(id);
 }
 
 void ResponderImpl::setMaximumConnectionsNumber(int value)
@@ -237,14 +818,153 @@ void ResponderImpl::setMultiplexingEnabled(bool state)
     cfg_.multiplexingEnabled = state;
 }
 
+void ResponderImpl::setOutputHighWaterMark(std::size_t size)
+{
+    cfg_.outputHighWaterMark = size;
+}
+
+void ResponderImpl::setMaximumRequestParamsSize(std::size_t size)
+{
+    cfg_.maxRequestParamsSize = size;
+}
+
+void ResponderImpl::setMaximumRequestDataSize(std::size_t size)
+{
+    cfg_.maxRequestDataSize = size;
+}
+
+void ResponderImpl::setMaximumConnectionBufferSize(std::size_t size)
+{
+    cfg_.maxConnectionBufferSize = size;
+}
+
+void ResponderImpl::setThreadLocalSerializationBufferEnabled(bool state)
+{
+    cfg_.threadLocalSerializationBufferEnabled = state;
+}
+
+void ResponderImpl::setOverloadControl(std::shared_ptr<OverloadControl> overloadControl)
+{
+    // the slots of the active requests are moved along with the output queue size,
+    // so they're released later by the control that holds them
+    for (auto i = std::size_t{}; i < requestRegistry_.size(); ++i) {
+        if (overloadControl_)
+            overloadControl_->releaseRequest();
+        if (overloadControl)
+            overloadControl->acquireRequest();
+    }
+    if (overloadControl_)
+        overloadControl_->updateOutputQueueSize(reportedOutputQueueSize_, 0);
+    reportedOutputQueueSize_ = 0;
+    overloadControl_ = std::move(overloadControl);
+    updateOverloadControlOutputQueueSize();
+}
+
+void ResponderImpl::setResponderGroup(std::shared_ptr<ResponderGroup> responderGroup)
+{
+    for (auto i = std::size_t{}; i < requestRegistry_.size(); ++i) {
+        if (responderGroup_)
+            responderGroup_->onRequestFinished();
+        if (responderGroup)
+            responderGroup->onRequestStarted();
+    }
+    responderGroup_ = std::move(responderGroup);
+    if (!responderGroup_)
+        return;
+
+    cfg_.maxConnectionsNumber = responderGroup_->maximumConnectionsNumber();
+    cfg_.maxRequestsNumber = responderGroup_->maximumRequestsNumber();
+    cfg_.multiplexingEnabled = responderGroup_->isMultiplexingEnabled();
+    cfg_.outputHighWaterMark = responderGroup_->outputHighWaterMark();
+    cfg_.maxRequestParamsSize = responderGroup_->maximumRequestParamsSize();
+    cfg_.maxRequestDataSize = responderGroup_->maximumRequestDataSize();
+    cfg_.maxConnectionBufferSize = responderGroup_->maximumConnectionBufferSize();
+    cfg_.threadLocalSerializationBufferEnabled = responderGroup_->isThreadLocalSerializationBufferEnabled();
+    if (auto overloadControl = responderGroup_->overloadControl())
+        setOverloadControl(std::move(overloadControl));
+    if (auto metrics = responderGroup_->metrics())
+        setMetrics(std::move(metrics));
+}
+
+void ResponderImpl::setMetrics(std::shared_ptr<Metrics> metrics)
+{
+    metrics_.setMetrics(std::move(metrics));
+    updateMetricsGauges();
+}
+
+void ResponderImpl::setTimerWheel(std::shared_ptr<TimerWheel> timerWheel)
+{
+    timerWheel_ = std::move(timerWheel);
+    updateIdleConnectionTimer();
+}
+
+void ResponderImpl::setRequestReceiveTimeout(std::chrono::milliseconds timeout)
+{
+    cfg_.requestReceiveTimeout = timeout;
+}
+
+void ResponderImpl::setRequestProcessingTimeout(std::chrono::milliseconds timeout)
+{
+    cfg_.requestProcessingTimeout = timeout;
+}
+
+void ResponderImpl::setIdleConnectionTimeout(std::chrono::milliseconds timeout)
+{
+    cfg_.idleConnectionTimeout = timeout;
+    updateIdleConnectionTimer();
+}
+
 void ResponderImpl::setErrorInfoHandler(std::function<void(const std::string&)> handler)
 {
     errorInfoHandler_ = std::move(handler);
-    recordReader_.setErrorInfoHandler(errorInfoHandler_);
 }
 
+void ResponderImpl::setErrorEventHandler(std::function<void(const ErrorEvent&)> handler)
+{
+    errorEventHandler_ = std::move(handler);
+}
+
+void ResponderImpl::setAuthorizeRequestHandler(
+        std::function<void(Request&& request, AuthorizerResponse&& response)> handler)
+{
+    role_ = Role::Authorizer;
+    authorizeRequest_ = std::move(handler);
+    authorizerResponseSender_ = std::make_shared<AuthorizerResponseSender>(
+            [this](std::uint64_t connectionGeneration, std::uint16_t id, const std::string& headers)
+            {
+                if (connectionGeneration == connectionGeneration_)
+                    sendAuthorizerResponse(id, headers);
+            });
+}
+
+void ResponderImpl::setFilterRequestHandler(
+        std::function<FilterInput(Request&& request, FilterOutput&& output)> handler)
+{
+    role_ = Role::Filter;
+    filterRequest_ = std::move(handler);
+    filterOutputSender_ = std::make_shared<FilterOutputSender>(
+            [this](std::uint64_t connectionGeneration,
+                   std::uint16_t id,
+                   std::string_view data,
+                   std::string_view errorData,
+                   bool isEnd)
+            {
+                if (connectionGeneration == connectionGeneration_)
+                    sendFilterOutput(id, data, errorData, isEnd);
+            });
+}
+
+#ifdef FCGI_RESPONDER_REQUEST_TIMING
+void ResponderImpl::setRequestTimingHandler(std::function<void(const RequestTiming&)> handler)
+{
+    requestTimingHandler_ = std::move(handler);
+}
+#endif
+
 int ResponderImpl::maximumConnectionsNumber() const
 {
+    if (responderGroup_)
+        return responderGroup_->maximumConnectionsNumber();
     return cfg_.maxConnectionsNumber;
 }
 
@@ -258,10 +978,71 @@ bool ResponderImpl::isMultiplexingEnabled() const
     return cfg_.multiplexingEnabled;
 }
 
-void ResponderImpl::notifyAboutError(const std::string& errorMsg)
+std::size_t ResponderImpl::outputHighWaterMark() const
+{
+    return cfg_.outputHighWaterMark;
+}
+
+std::size_t ResponderImpl::outputQueueSize() const
+{
+    return outputQueue_.size();
+}
+
+bool ResponderImpl::isOutputQueueFull() const
+{
+    return outputQueue_.size() >= cfg_.outputHighWaterMark;
+}
+
+std::size_t ResponderImpl::maximumRequestParamsSize() const
+{
+    return cfg_.maxRequestParamsSize;
+}
+
+std::size_t ResponderImpl::maximumRequestDataSize() const
+{
+    return cfg_.maxRequestDataSize;
+}
+
+std::size_t ResponderImpl::maximumConnectionBufferSize() const
+{
+    return cfg_.maxConnectionBufferSize;
+}
+
+bool ResponderImpl::isThreadLocalSerializationBufferEnabled() const
+{
+    return cfg_.threadLocalSerializationBufferEnabled;
+}
+
+std::size_t ResponderImpl::bufferedRequestDataSize() const
+{
+    auto result = std::size_t{};
+    for (const auto& [requestId, requestData] : requestRegistry_)
+        result += requestData.paramsSize() + requestData.stdInSize();
+    return result;
+}
+
+std::chrono::milliseconds ResponderImpl::requestReceiveTimeout() const
+{
+    return cfg_.requestReceiveTimeout;
+}
+
+std::chrono::milliseconds ResponderImpl::requestProcessingTimeout() const
+{
+    return cfg_.requestProcessingTimeout;
+}
+
+std::chrono::milliseconds ResponderImpl::idleConnectionTimeout() const
+{
+    return cfg_.idleConnectionTimeout;
+}
+
+void ResponderImpl::notifyAboutError(const ErrorEvent& event)
 {
+    metrics_.onError(event);
+    if (errorEventHandler_)
+        errorEventHandler_(event);
     if (errorInfoHandler_)
-        errorInfoHandler_(errorMsg);
+        errorInfoHandler_(toString(event));
 }
 
 } //namespace fcgi
@@ -1,36 +1,90 @@
 #pragma once
+#include "connectionmetrics.h"
 #include "datawriterstream.h"
+#include "outputqueue.h"
 #include "recordreader.h"
 #include "requestdata.h"
 #include "streamdatamessage.h"
 #include "types.h"
+#include <fcgi_responder/requesttiming.h>
+#include <fcgi_responder/timerwheel.h>
+#include <chrono>
+#include <deque>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <sstream>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace fcgi {
 class Request;
 class Response;
+class AuthorizerResponse;
+class FilterOutput;
+struct FilterInput;
+struct FileRegion;
 class MsgBeginRequest;
 class MsgGetValues;
 class MsgParams;
 class Record;
+class OverloadControl;
+class ResponderGroup;
+class Metrics;
 
 class ResponderImpl {
 public:
     ResponderImpl(
             std::function<void(const std::string&)> sendData,
+            std::function<std::size_t(const std::string&)> trySendData,
+            std::function<std::size_t(const FileRegion&)> trySendFileData,
             std::function<void()> disconnect,
             std::function<void(Request&& request, Response&& response)> processRequest);
+    ~ResponderImpl();
+    ResponderImpl(const ResponderImpl&) = delete;
+    ResponderImpl& operator=(const ResponderImpl&) = delete;
     void receiveData(const char* data, std::size_t size);
+    void readAndSendFileData(const FileRegion& fileRegion);
+    void onWritable();
+    void reset();
     void setMaximumConnectionsNumber(int value);
     void setMaximumRequestsNumber(int value);
     void setMultiplexingEnabled(bool state);
+    void setOutputHighWaterMark(std::size_t size);
+    void setMaximumRequestParamsSize(std::size_t size);
+    void setMaximumRequestDataSize(std::size_t size);
+    void setMaximumConnectionBufferSize(std::size_t size);
+    void setThreadLocalSerializationBufferEnabled(bool state);
+    void setOverloadControl(std::shared_ptr<OverloadControl> overloadControl);
+    void setResponderGroup(std::shared_ptr<ResponderGroup> responderGroup);
+    void setMetrics(std::shared_ptr<Metrics> metrics);
+    void setTimerWheel(std::shared_ptr<TimerWheel> timerWheel);
+    void setRequestReceiveTimeout(std::chrono::milliseconds timeout);
+    void setRequestProcessingTimeout(std::chrono::milliseconds timeout);
+    void setIdleConnectionTimeout(std::chrono::milliseconds timeout);
     int maximumConnectionsNumber() const;
     int maximumRequestsNumber() const;
     bool isMultiplexingEnabled() const;
+    std::size_t outputHighWaterMark() const;
+    std::size_t outputQueueSize() const;
+    bool isOutputQueueFull() const;
+    std::size_t maximumRequestParamsSize() const;
+    std::size_t maximumRequestDataSize() const;
+    std::size_t maximumConnectionBufferSize() const;
+    bool isThreadLocalSerializationBufferEnabled() const;
+    std::size_t bufferedRequestDataSize() const;
+    std::chrono::milliseconds requestReceiveTimeout() const;
+    std::chrono::milliseconds requestProcessingTimeout() const;
+    std::chrono::milliseconds idleConnectionTimeout() const;
     void setErrorInfoHandler(std::function<void(const std::string&)> errorInfoHandler);
+    void setErrorEventHandler(std::function<void(const ErrorEvent&)> errorEventHandler);
+#ifdef FCGI_RESPONDER_REQUEST_TIMING
+    void setRequestTimingHandler(std::function<void(const RequestTiming&)> handler);
+#endif
+    void setAuthorizeRequestHandler(std::function<void(Request&& request, AuthorizerResponse&& response)> handler);
+    void setFilterRequestHandler(std::function<FilterInput(Request&& request, FilterOutput&& output)> handler);
 
 private:
     void onRecordRead(const Record& record);
@@ -38,38 +92,110 @@ private:
     void onGetValues(const MsgGetValues& msg);
     void onParams(std::uint16_t requestId, const MsgParams& msg);
     void onStdIn(std::uint16_t requestId, const StreamDataMessage<RecordType::StdIn>& msg);
+    void onFilterStream(
+            std::uint16_t requestId,
+            std::string_view data,
+            std::function<void(std::string_view)> FilterInput::*streamHandler);
     void onRequestReceived(std::uint16_t requestId);
     void sendRecord(const Record& record);
-    void sendResponse(std::uint16_t id, std::string&& data, std::string&& errorMsg);
+    void sendRecords(const std::vector<Record>& records);
+    void sendRecordHeader(RecordType type, std::uint16_t requestId, std::uint16_t contentLength);
+    void writeOutput(const std::string& data);
+    void writeOutput(const FileRegion& fileRegion);
+    void updateOverloadControlOutputQueueSize();
+    void updateMetricsGauges();
+    void reportProcessingLatency(std::uint16_t requestId);
+    void markRequestTime(RequestData& requestData, RequestTiming::TimePoint RequestTiming::*timePoint);
+    void addWrittenOutputSize(std::size_t size);
+    void reportRequestTiming(std::uint16_t requestId);
+    void reportWrittenRequestTimings();
+    void clearPendingRequestTimings();
+    void sendResponse(std::uint16_t id, std::string_view data, std::string&& errorMsg);
+    void sendFileResponse(std::uint16_t id, const FileRegion& fileRegion, std::string&& errorMsg);
+    void sendErrorStream(std::uint16_t id, const std::string& errorMsg);
+    void sendAuthorizerResponse(std::uint16_t id, const std::string& headers);
+    void sendFilterOutput(std::uint16_t id, std::string_view data, std::string_view errorData, bool isEnd);
 
     bool isRecordExpected(const Record& record);
     void endRequest(std::uint16_t requestId);
+    void completeRequest(std::uint16_t requestId);
+    void rejectRequest(std::uint16_t requestId);
+    bool isRecordDiscarded(const Record& record);
+    bool isBufferSizeExceeded(std::size_t requestDataSize, std::size_t requestDataSizeLimit, std::size_t incomingSize)
+            const;
+    void closeConnection();
+    void armRequestTimer(RequestData& requestData, std::chrono::milliseconds timeout);
+    void onRequestTimeout(std::uint16_t requestId);
+    void updateIdleConnectionTimer();
 
-    void notifyAboutError(const std::string& errorMsg);
+    void notifyAboutError(const ErrorEvent& event);
     void createRequest(std::uint16_t requestId, bool keepConnection);
     void deleteRequest(std::uint16_t requestId);
+    void releaseRequests();
 
 private:
     struct Config {
         int maxConnectionsNumber = 1;
         int maxRequestsNumber = 10;
         bool multiplexingEnabled = true;
+        std::size_t outputHighWaterMark = 1024 * 1024;
+        std::size_t maxRequestParamsSize = std::numeric_limits<std::size_t>::max();
+        std::size_t maxRequestDataSize = std::numeric_limits<std::size_t>::max();
+        std::size_t maxConnectionBufferSize = std::numeric_limits<std::size_t>::max();
+        bool threadLocalSerializationBufferEnabled = false;
+        std::chrono::milliseconds requestReceiveTimeout{};
+        std::chrono::milliseconds requestProcessingTimeout{};
+        std::chrono::milliseconds idleConnectionTimeout{};
     } cfg_;
 
     RecordReader recordReader_;
     std::unordered_map<std::uint16_t, RequestData> requestRegistry_;
+    std::unordered_set<std::uint16_t> discardedRequestIds_;
     std::function<void(const std::string&)> errorInfoHandler_;
+    std::function<void(const ErrorEvent&)> errorEventHandler_;
     DataWriterStream recordStream_;
     std::function<void(const std::string&)> sendData_;
+    OutputQueue outputQueue_;
+    bool isDisconnectRequested_ = false;
+    // set when the connection is closed or is being closed, so the idle connection timer isn't armed
+    bool isConnectionClosing_ = false;
+    std::shared_ptr<TimerWheel> timerWheel_;
+    TimerWheel::Timer idleConnectionTimer_;
+    std::shared_ptr<OverloadControl> overloadControl_;
+    std::size_t reportedOutputQueueSize_ = 0;
+    std::shared_ptr<ResponderGroup> responderGroup_;
+    ConnectionMetrics metrics_;
+#ifdef FCGI_RESPONDER_REQUEST_TIMING
+    std::function<void(const RequestTiming&)> requestTimingHandler_;
+    // total size of the data passed to the output queue, and timings of the requests
+    // waiting until the output queue sends the data up to the stored size
+    std::uint64_t writtenOutputSize_ = 0;
+    std::deque<std::pair<std::uint64_t, RequestTiming>> pendingRequestTimings_;
+#endif
     std::function<void()> disconnect_;
     std::function<void(Request&& request, Response&& response)> processRequest_;
+    // requests with the Authorizer or Filter role are accepted instead of the Responder ones when its handler is set
+    Role role_ = Role::Responder;
+    std::function<void(Request&& request, AuthorizerResponse&& response)> authorizeRequest_;
+    std::function<FilterInput(Request&& request, FilterOutput&& output)> filterRequest_;
 
-    using ResponseSender = std::function<void(std::uint16_t, std::string&&, std::string&&)>;
+    // incremented by reset(), so the responses of the previous connection are discarded
+    std::uint64_t connectionGeneration_ = 0;
+    using ResponseSender = std::function<void(std::uint64_t, std::uint16_t, std::string_view, std::string&&)>;
     std::shared_ptr<ResponseSender> responseSender_;
+    using FileResponseSender = std::function<void(std::uint64_t, std::uint16_t, const FileRegion&, std::string&&)>;
+    std::shared_ptr<FileResponseSender> fileResponseSender_;
+    using AuthorizerResponseSender = std::function<void(std::uint64_t, std::uint16_t, const std::string&)>;
+    std::shared_ptr<AuthorizerResponseSender> authorizerResponseSender_;
+    using FilterOutputSender =
+            std::function<void(std::uint64_t, std::uint16_t, std::string_view, std::string_view, bool)>;
+    std::shared_ptr<FilterOutputSender> filterOutputSender_;
 
 private:
     template<typename TMsg>
     void sendMessage(std::uint16_t requestId, TMsg&& msg);
+    template<typename TMsg>
+    void sendStreamData(std::uint16_t requestId, std::string_view data);
 };
 
 } // namespace fcgi
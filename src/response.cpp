@@ -1,9 +1,17 @@
+#include "cancellationtoken.h"
 #include <fcgi_responder/response.h>
 
 namespace fcgi {
 
-Response::Response(ResponseSender sender)
+Response::Response(
+        ResponseSender sender,
+        FileResponseSender fileSender,
+        SharedResponseSender sharedSender,
+        std::shared_ptr<CancellationToken> cancellationToken)
     : sender_{std::move(sender)}
+    , fileSender_{std::move(fileSender)}
+    , sharedSender_{std::move(sharedSender)}
+    , cancellationToken_{std::move(cancellationToken)}
 {
 }
 
@@ -12,15 +20,38 @@ void Response::send()
     if (!sender_)
         return;
 
-    sender_(std::move(data_), std::move(errorMsg_));
+    //response of the cancelled request is discarded
+    if (!isCancelled()) {
+        if (fileData_ && fileSender_)
+            fileSender_(*fileData_, std::move(errorMsg_));
+        else if (sharedData_ && sharedSender_)
+            sharedSender_(sharedData_, std::move(errorMsg_));
+        else if (sharedData_)
+            sender_(std::string{*sharedData_}, std::move(errorMsg_));
+        else
+            sender_(std::move(data_), std::move(errorMsg_));
+    }
 
-    //set empty sender, so response can be sent only once
+    //set empty senders, so response can be sent only once
     sender_ = ResponseSender{};
+    fileSender_ = FileResponseSender{};
+    sharedSender_ = SharedResponseSender{};
+    sharedData_.reset();
 }
 
 bool Response::isValid() const
 {
-    return sender_.operator bool();
+    return sender_ && !isCancelled();
+}
+
+bool Response::isCancelled() const
+{
+    return fcgi::isCancelled(cancellationToken_);
+}
+
+void Response::setCancellationHandler(std::function<void()> handler)
+{
+    fcgi::setCancellationHandler(cancellationToken_, std::move(handler));
 }
 
 Response::operator bool() const
@@ -31,6 +62,22 @@ Response::operator bool() const
 void Response::setData(std::string data)
 {
     data_ = std::move(data);
+    sharedData_.reset();
+    fileData_ = std::nullopt;
+}
+
+void Response::setData(std::shared_ptr<const std::string> data)
+{
+    sharedData_ = std::move(data);
+    data_.clear();
+    fileData_ = std::nullopt;
+}
+
+void Response::setFileData(const FileRegion& fileRegion)
+{
+    fileData_ = fileRegion;
+    data_.clear();
+    sharedData_.reset();
 }
 
 void Response::setErrorMsg(std::string errorMsg)
@@ -0,0 +1,200 @@
+#include <fcgi_responder/timerwheel.h>
+#include <algorithm>
+#include <utility>
+
+namespace fcgi {
+
+namespace {
+constexpr auto maxTimeoutTicks = std::uint64_t{0xFFFFFFFF};
+}
+
+TimerWheel::Timer::Timer(std::function<void()> handler)
+    : handler_{std::move(handler)}
+{
+}
+
+TimerWheel::Timer::~Timer()
+{
+    cancel();
+}
+
+TimerWheel::Timer::Timer(Timer&& other) noexcept
+    : handler_{std::move(other.handler_)}
+{
+    takeListPosition(other);
+}
+
+TimerWheel::Timer& TimerWheel::Timer::operator=(Timer&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+    cancel();
+    handler_ = std::move(other.handler_);
+    takeListPosition(other);
+    return *this;
+}
+
+void TimerWheel::Timer::takeListPosition(Timer& other)
+{
+    wheel_ = std::exchange(other.wheel_, nullptr);
+    expirationTick_ = other.expirationTick_;
+    if (!wheel_)
+        return;
+    prev = std::exchange(other.prev, nullptr);
+    next = std::exchange(other.next, nullptr);
+    prev->next = this;
+    next->prev = this;
+}
+
+void TimerWheel::Timer::setHandler(std::function<void()> handler)
+{
+    handler_ = std::move(handler);
+}
+
+void TimerWheel::Timer::cancel()
+{
+    if (!wheel_)
+        return;
+    unlink(*this);
+    --wheel_->armedTimersNumber_;
+    wheel_ = nullptr;
+}
+
+bool TimerWheel::Timer::isArmed() const
+{
+    return wheel_ != nullptr;
+}
+
+TimerWheel::TimerWheel(std::chrono::steady_clock::duration resolution, std::chrono::steady_clock::time_point startTime)
+    : resolution_{std::max(resolution, std::chrono::steady_clock::duration{1})}
+    , startTime_{startTime}
+{
+    for (auto& level : slots_)
+        for (auto& slot : level)
+            slot.prev = slot.next = &slot;
+}
+
+TimerWheel::~TimerWheel()
+{
+    for (auto& level : slots_)
+        for (auto& slot : level)
+            while (slot.next != &slot) {
+                auto& timer = static_cast<Timer&>(*slot.next);
+                unlink(timer);
+                timer.wheel_ = nullptr;
+            }
+}
+
+void TimerWheel::arm(Timer& timer, std::chrono::steady_clock::duration timeout)
+{
+    timer.cancel();
+    using Duration = std::chrono::steady_clock::duration;
+    // the timeout is rounded up, so the timer never expires earlier
+    const auto ticks = (std::max(timeout, Duration{}) + resolution_ - Duration{1}) / resolution_;
+    timer.expirationTick_ =
+            currentTick_ + std::clamp(static_cast<std::uint64_t>(ticks), std::uint64_t{1}, maxTimeoutTicks);
+    timer.wheel_ = this;
+    ++armedTimersNumber_;
+    schedule(timer);
+}
+
+void TimerWheel::tick(std::chrono::steady_clock::time_point now)
+{
+    if (now < startTime_)
+        return;
+    const auto targetTick = static_cast<std::uint64_t>((now - startTime_) / resolution_);
+    while (currentTick_ < targetTick) {
+        // positions in the wheel don't matter when it's empty, so the idle periods are skipped
+        if (!armedTimersNumber_) {
+            currentTick_ = targetTick;
+            return;
+        }
+        step();
+    }
+}
+
+std::chrono::steady_clock::time_point TimerWheel::now() const
+{
+    return startTime_ + resolution_ * static_cast<std::chrono::steady_clock::rep>(currentTick_);
+}
+
+std::chrono::steady_clock::duration TimerWheel::resolution() const
+{
+    return resolution_;
+}
+
+std::size_t TimerWheel::armedTimersNumber() const
+{
+    return armedTimersNumber_;
+}
+
+void TimerWheel::schedule(Timer& timer)
+{
+    const auto delta = timer.expirationTick_ - currentTick_;
+    auto level = 0;
+    while (level < levelsNumber - 1 && delta >= (std::uint64_t{1} << (bitsPerLevel * (level + 1))))
+        ++level;
+    const auto slotIndex = (timer.expirationTick_ >> (bitsPerLevel * level)) & (slotsPerLevel - 1);
+    link(slots_[level][slotIndex], timer);
+}
+
+void TimerWheel::step()
+{
+    ++currentTick_;
+    // timers of the higher level slot reached by the current tick are moved to the lower levels
+    for (auto level = levelsNumber - 1; level > 0; --level) {
+        const auto levelMask = (std::uint64_t{1} << (bitsPerLevel * level)) - 1;
+        if (currentTick_ & levelMask)
+            continue;
+        auto cascaded = Node{};
+        splice(slots_[level][(currentTick_ >> (bitsPerLevel * level)) & (slotsPerLevel - 1)], cascaded);
+        while (cascaded.next != &cascaded) {
+            auto& timer = static_cast<Timer&>(*cascaded.next);
+            unlink(timer);
+            schedule(timer);
+        }
+    }
+
+    // handlers can cancel or rearm any timer, so the expired ones are moved out of the wheel first
+    auto expired = Node{};
+    splice(slots_[0][currentTick_ & (slotsPerLevel - 1)], expired);
+    while (expired.next != &expired) {
+        auto& timer = static_cast<Timer&>(*expired.next);
+        unlink(timer);
+        timer.wheel_ = nullptr;
+        --armedTimersNumber_;
+        // the handler is copied as it's allowed to destroy the timer
+        if (auto handler = timer.handler_)
+            handler();
+    }
+}
+
+void TimerWheel::link(Node& list, Node& node)
+{
+    node.prev = list.prev;
+    node.next = &list;
+    list.prev->next = &node;
+    list.prev = &node;
+}
+
+void TimerWheel::unlink(Node& node)
+{
+    node.prev->next = node.next;
+    node.next->prev = node.prev;
+    node.prev = node.next = nullptr;
+}
+
+void TimerWheel::splice(Node& source, Node& target)
+{
+    if (source.next == &source) {
+        target.prev = target.next = &target;
+        return;
+    }
+    target.next = source.next;
+    target.prev = source.prev;
+    target.next->prev = &target;
+    target.prev->next = &target;
+    source.prev = source.next = &source;
+}
+
+} //namespace fcgi
@@ -0,0 +1,178 @@
+#include <msgabortrequest.h>
+#include <msgbeginrequest.h>
+#include <msgendrequest.h>
+#include <msgparams.h>
+#include <record.h>
+#include <streamdatamessage.h>
+#include <fcgi_responder/authorizer.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <optional>
+#include <sstream>
+
+using namespace fcgi;
+
+namespace {
+template<typename TMsg>
+std::string messageData(TMsg&& msg, std::uint16_t requestId)
+{
+    auto record = fcgi::Record{std::forward<TMsg>(msg), requestId};
+    auto recordStream = std::ostringstream{};
+    record.toStream(recordStream);
+    return recordStream.str();
+}
+
+std::string responseData(const std::string& headers, std::uint16_t requestId)
+{
+    return messageData(MsgStdOut{headers}, requestId) + messageData(MsgStdOut{}, requestId) +
+            messageData(MsgStdErr{}, requestId) +
+            messageData(MsgEndRequest{0, ProtocolStatus::RequestComplete}, requestId);
+}
+
+class MockAuthorizer : public Authorizer {
+public:
+    MOCK_METHOD1(sendData, void(const std::string& data));
+    MOCK_METHOD0(disconnect, void());
+    void authorizeRequest(Request&& request, AuthorizerResponse&& response) override
+    {
+        if (request.param("REMOTE_USER") == "admin") {
+            response.allow();
+            response.setVariable("ROLE", "admin");
+            response.setVariable("USER_ID", "1");
+        }
+        else if (request.param("REMOTE_USER") == "guest") {
+            response.deny(401);
+            response.setHeader("WWW-Authenticate", "Basic realm=\"test\"");
+        }
+        else if (request.param("REMOTE_USER") == "deferred") {
+            deferredResponse_.emplace(std::move(response));
+            return;
+        }
+        response.send();
+    }
+
+    void receive(const std::string& data)
+    {
+        Authorizer::receiveData(data.c_str(), data.size());
+    }
+
+    std::optional<AuthorizerResponse> deferredResponse_;
+};
+
+} //namespace
+
+class TestAuthorizer : public ::testing::TestWithParam<bool> {
+public:
+    TestAuthorizer()
+    {
+        authorizer_.setErrorInfoHandler(
+                [&errorInfo = errorInfo_](const std::string& errorMsg)
+                {
+                    errorInfo += errorMsg + "\n";
+                });
+    }
+
+protected:
+    template<typename TMsg>
+    void receiveMessage(TMsg&& msg, std::uint16_t requestId = 0)
+    {
+        authorizer_.receive(messageData(std::forward<TMsg>(msg), requestId));
+    }
+    void receiveRequest(const std::string& user, std::uint16_t requestId = 1)
+    {
+        auto params = MsgParams{};
+        params.setParam("REMOTE_USER", user);
+        receiveMessage(MsgBeginRequest{Role::Authorizer, resultConnectionState()}, requestId);
+        receiveMessage(std::move(params), requestId);
+        receiveMessage(MsgParams{}, requestId);
+    }
+    void checkConnectionState()
+    {
+        auto disconnectOnEnd = GetParam();
+        if (disconnectOnEnd)
+            EXPECT_CALL(authorizer_, disconnect());
+        else
+            EXPECT_CALL(authorizer_, disconnect()).Times(0);
+    }
+    ResultConnectionState resultConnectionState()
+    {
+        auto disconnectOnEnd = GetParam();
+        return disconnectOnEnd ? ResultConnectionState::Close : ResultConnectionState::KeepOpen;
+    }
+
+    MockAuthorizer authorizer_;
+    std::string errorInfo_;
+};
+
+TEST_P(TestAuthorizer, Allow)
+{
+    EXPECT_CALL(
+            authorizer_,
+            sendData(responseData("Status: 200 OK\r\nVariable-ROLE: admin\r\nVariable-USER_ID: 1\r\n\r\n", 1)));
+    checkConnectionState();
+    receiveRequest("admin");
+    EXPECT_TRUE(errorInfo_.empty());
+}
+
+TEST_P(TestAuthorizer, Deny)
+{
+    EXPECT_CALL(
+            authorizer_,
+            sendData(responseData("Status: 401 Unauthorized\r\nWWW-Authenticate: Basic realm=\"test\"\r\n\r\n", 1)));
+    checkConnectionState();
+    receiveRequest("guest");
+}
+
+TEST_P(TestAuthorizer, DenyByDefault)
+{
+    EXPECT_CALL(authorizer_, sendData(responseData("Status: 403 Forbidden\r\n\r\n", 1)));
+    checkConnectionState();
+    receiveRequest("unknown");
+}
+
+TEST_P(TestAuthorizer, IgnoreRequestData)
+{
+    EXPECT_CALL(authorizer_, sendData(responseData("Status: 403 Forbidden\r\n\r\n", 1)));
+    checkConnectionState();
+    receiveRequest("unknown");
+    receiveMessage(MsgStdIn{}, 1);
+    EXPECT_TRUE(errorInfo_.empty());
+}
+
+TEST_P(TestAuthorizer, DeferredResponse)
+{
+    EXPECT_CALL(authorizer_, sendData(::testing::_)).Times(0);
+    receiveRequest("deferred");
+    ASSERT_TRUE(authorizer_.deferredResponse_.has_value());
+    ::testing::Mock::VerifyAndClearExpectations(&authorizer_);
+
+    EXPECT_CALL(authorizer_, sendData(responseData("Status: 200 OK\r\n\r\n", 1)));
+    checkConnectionState();
+    authorizer_.deferredResponse_->allow();
+    authorizer_.deferredResponse_->send();
+    EXPECT_FALSE(authorizer_.deferredResponse_->isValid());
+}
+
+TEST_P(TestAuthorizer, DeferredResponseOfAbortedRequest)
+{
+    receiveRequest("deferred");
+    ASSERT_TRUE(authorizer_.deferredResponse_.has_value());
+
+    EXPECT_CALL(authorizer_, sendData(messageData(MsgEndRequest{0, ProtocolStatus::RequestComplete}, 1)));
+    checkConnectionState();
+    receiveMessage(MsgAbortRequest{}, 1);
+    ::testing::Mock::VerifyAndClearExpectations(&authorizer_);
+    EXPECT_TRUE(authorizer_.deferredResponse_->isCancelled());
+
+    EXPECT_CALL(authorizer_, sendData(::testing::_)).Times(0);
+    authorizer_.deferredResponse_->send();
+}
+
+TEST_P(TestAuthorizer, ResponderRoleIsUnknown)
+{
+    EXPECT_CALL(authorizer_, sendData(messageData(MsgEndRequest{0, ProtocolStatus::UnknownRole}, 1)));
+    checkConnectionState();
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(WithConnectionStateCheck, TestAuthorizer, ::testing::Values(false, true));
@@ -0,0 +1,90 @@
+#include <fcgi_responder/errorevent.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace fcgi;
+
+namespace {
+struct ReportedEvent {
+    ErrorCode code;
+    std::uint16_t requestId;
+    std::uint64_t suppressedEventsNumber;
+};
+
+bool operator==(const ReportedEvent& lhs, const ReportedEvent& rhs)
+{
+    return lhs.code == rhs.code && lhs.requestId == rhs.requestId &&
+            lhs.suppressedEventsNumber == rhs.suppressedEventsNumber;
+}
+
+auto reportTo(std::vector<ReportedEvent>& events)
+{
+    return [&events](const ErrorEvent& event, std::uint64_t suppressedEventsNumber)
+    {
+        events.push_back({event.code, event.requestId, suppressedEventsNumber});
+    };
+}
+} //namespace
+
+TEST(ErrorEvent, ToString)
+{
+    EXPECT_EQ(
+            toString(ErrorEvent{ErrorCode::UnexpectedRecord, 1, 2}),
+            "Received unexpected record, RecordType = 2, requestId = 1");
+    EXPECT_EQ(toString(ErrorEvent{ErrorCode::InvalidRecordType, 0, 99, 99}), "Record type \"99\" is invalid.");
+    EXPECT_EQ(
+            toString(ErrorEvent{ErrorCode::UnsupportedVersion, 0, 0, 83}),
+            "Protocol version \"83\" isn't supported.");
+    EXPECT_EQ(
+            toString(ErrorEvent{ErrorCode::MalformedRecord, 0, 0, 0, "Misaligned name-value"}),
+            "Misaligned name-value");
+    EXPECT_EQ(
+            toString(ErrorEvent{ErrorCode::RequestDataSizeExceeded, 3}),
+            "Request data size limit exceeded, requestId = 3");
+    EXPECT_EQ(
+            toString(ErrorEvent{ErrorCode::FileReadError, 0, 0, 5}),
+            "Can't read response data from file descriptor 5, closing the connection");
+    EXPECT_EQ(toString(ErrorEvent{ErrorCode::InvalidMaxReqsValue, 0, 0, 0, "foo"}), "Invalid value for MaxReqs: foo");
+    EXPECT_EQ(toString(ErrorEvent{ErrorCode::UnknownTypeReceived, 1, 0, 77}), "Received unknown record type: 77");
+}
+
+TEST(ErrorEventAggregator, SuppressRepeatedEvents)
+{
+    auto events = std::vector<ReportedEvent>{};
+    auto aggregator = ErrorEventAggregator{reportTo(events), std::chrono::hours{1}};
+    aggregator(ErrorEvent{ErrorCode::UnexpectedRecord, 1});
+    aggregator(ErrorEvent{ErrorCode::UnexpectedRecord, 2});
+    aggregator(ErrorEvent{ErrorCode::UnexpectedRecord, 3});
+    aggregator(ErrorEvent{ErrorCode::RequestDataSizeExceeded, 4});
+    aggregator(ErrorEvent{ErrorCode::RequestDataSizeExceeded, 5});
+    EXPECT_EQ(
+            events,
+            (std::vector<ReportedEvent>{
+                    {ErrorCode::UnexpectedRecord, 1, 0},
+                    {ErrorCode::RequestDataSizeExceeded, 4, 0}}));
+
+    aggregator.flush();
+    EXPECT_EQ(
+            events,
+            (std::vector<ReportedEvent>{
+                    {ErrorCode::UnexpectedRecord, 1, 0},
+                    {ErrorCode::RequestDataSizeExceeded, 4, 0},
+                    {ErrorCode::UnexpectedRecord, 3, 2},
+                    {ErrorCode::RequestDataSizeExceeded, 5, 1}}));
+
+    events.clear();
+    aggregator.flush();
+    EXPECT_TRUE(events.empty());
+}
+
+TEST(ErrorEventAggregator, ZeroInterval)
+{
+    auto events = std::vector<ReportedEvent>{};
+    auto aggregator = ErrorEventAggregator{reportTo(events), std::chrono::steady_clock::duration::zero()};
+    aggregator(ErrorEvent{ErrorCode::UnexpectedRecord, 1});
+    aggregator(ErrorEvent{ErrorCode::UnexpectedRecord, 2});
+    aggregator.flush();
+    EXPECT_EQ(
+            events,
+            (std::vector<ReportedEvent>{{ErrorCode::UnexpectedRecord, 1, 0}, {ErrorCode::UnexpectedRecord, 2, 0}}));
+}
@@ -0,0 +1,237 @@
+#include <msgabortrequest.h>
+#include <msgbeginrequest.h>
+#include <msgendrequest.h>
+#include <msgparams.h>
+#include <record.h>
+#include <streamdatamessage.h>
+#include <fcgi_responder/filter.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <optional>
+#include <sstream>
+
+using namespace fcgi;
+using namespace testing;
+
+namespace {
+template<typename TMsg>
+std::string messageData(TMsg&& msg, std::uint16_t requestId)
+{
+    auto record = fcgi::Record{std::forward<TMsg>(msg), requestId};
+    auto recordStream = std::ostringstream{};
+    record.toStream(recordStream);
+    return recordStream.str();
+}
+
+std::string toUpper(std::string_view data)
+{
+    auto result = std::string{data};
+    std::transform(
+            result.begin(),
+            result.end(),
+            result.begin(),
+            [](unsigned char ch)
+            {
+                return static_cast<char>(std::toupper(ch));
+            });
+    return result;
+}
+
+class MockFilter : public Filter {
+public:
+    MOCK_METHOD1(sendData, void(const std::string& data));
+    MOCK_METHOD0(disconnect, void());
+    FilterInput processFilterRequest(Request&& request, FilterOutput&& output) override
+    {
+        struct State {
+            FilterOutput output;
+            std::string stdIn;
+        };
+        auto state = std::make_shared<State>(State{std::move(output), {}});
+        const auto mode = request.param("MODE");
+        if (mode == "deferred") {
+            deferredOutput_.emplace(std::move(state->output));
+            return {};
+        }
+        return FilterInput{
+                [state](std::string_view data)
+                {
+                    state->stdIn += data;
+                },
+                [state, mode](std::string_view data)
+                {
+                    if (data.empty()) {
+                        state->output.write("stdin:" + state->stdIn);
+                        state->output.end();
+                        return;
+                    }
+                    state->output.write(toUpper(data));
+                    if (mode == "head")
+                        state->output.end();
+                }};
+    }
+
+    void receive(const std::string& data)
+    {
+        Filter::receiveData(data.c_str(), data.size());
+    }
+
+    std::optional<FilterOutput> deferredOutput_;
+};
+
+} //namespace
+
+class TestFilter : public TestWithParam<bool> {
+public:
+    TestFilter()
+    {
+        filter_.setErrorInfoHandler(
+                [&errorInfo = errorInfo_](const std::string& errorMsg)
+                {
+                    errorInfo += errorMsg + "\n";
+                });
+    }
+
+protected:
+    template<typename TMsg>
+    void receiveMessage(TMsg&& msg, std::uint16_t requestId = 1)
+    {
+        filter_.receive(messageData(std::forward<TMsg>(msg), requestId));
+    }
+    template<typename TMsg>
+    void expectMessageToBeSent(TMsg&& msg, std::uint16_t requestId = 1)
+    {
+        EXPECT_CALL(filter_, sendData(messageData(std::forward<TMsg>(msg), requestId)));
+    }
+    void expectRequestToBeEnded()
+    {
+        expectMessageToBeSent(MsgStdOut{});
+        expectMessageToBeSent(MsgStdErr{});
+        expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::RequestComplete});
+    }
+    void receiveRequestParams(const std::string& mode)
+    {
+        auto params = MsgParams{};
+        params.setParam("MODE", mode);
+        params.setParam("FCGI_DATA_LENGTH", "10");
+        receiveMessage(MsgBeginRequest{Role::Filter, resultConnectionState()});
+        receiveMessage(std::move(params));
+        receiveMessage(MsgParams{});
+    }
+    void checkConnectionState()
+    {
+        auto disconnectOnEnd = GetParam();
+        if (disconnectOnEnd)
+            EXPECT_CALL(filter_, disconnect());
+        else
+            EXPECT_CALL(filter_, disconnect()).Times(0);
+    }
+    ResultConnectionState resultConnectionState()
+    {
+        auto disconnectOnEnd = GetParam();
+        return disconnectOnEnd ? ResultConnectionState::Close : ResultConnectionState::KeepOpen;
+    }
+
+    MockFilter filter_;
+    std::string errorInfo_;
+};
+
+TEST_P(TestFilter, StreamsAreProcessedIncrementally)
+{
+    EXPECT_CALL(filter_, sendData(_)).Times(0);
+    receiveRequestParams("upper");
+    receiveMessage(MsgStdIn{"foo"});
+    receiveMessage(MsgStdIn{});
+    Mock::VerifyAndClearExpectations(&filter_);
+
+    expectMessageToBeSent(MsgStdOut{"HELLO"});
+    receiveMessage(MsgData{"hello"});
+    Mock::VerifyAndClearExpectations(&filter_);
+
+    expectMessageToBeSent(MsgStdOut{"WORLD"});
+    receiveMessage(MsgData{"world"});
+    Mock::VerifyAndClearExpectations(&filter_);
+
+    {
+        const auto seq = InSequence{};
+        expectMessageToBeSent(MsgStdOut{"stdin:foo"});
+        expectRequestToBeEnded();
+    }
+    checkConnectionState();
+    receiveMessage(MsgData{});
+    EXPECT_TRUE(errorInfo_.empty());
+}
+
+TEST_P(TestFilter, OutputEndedBeforeDataStream)
+{
+    {
+        const auto seq = InSequence{};
+        expectMessageToBeSent(MsgStdOut{"HELLO"});
+        expectRequestToBeEnded();
+    }
+    checkConnectionState();
+    receiveRequestParams("head");
+    receiveMessage(MsgStdIn{});
+    receiveMessage(MsgData{"hello"});
+    receiveMessage(MsgData{"world"});
+    receiveMessage(MsgData{});
+    EXPECT_TRUE(errorInfo_.empty());
+}
+
+TEST_P(TestFilter, LargeOutput)
+{
+    receiveRequestParams("deferred");
+    ASSERT_TRUE(filter_.deferredOutput_.has_value());
+
+    const auto data = std::string(70000, 'x');
+    const auto seq = InSequence{};
+    expectMessageToBeSent(MsgStdOut{std::string_view{data}.substr(0, 65535)});
+    expectMessageToBeSent(MsgStdOut{std::string_view{data}.substr(65535)});
+    expectMessageToBeSent(MsgStdErr{"error"});
+    filter_.deferredOutput_->write(data);
+    filter_.deferredOutput_->write({});
+    filter_.deferredOutput_->writeError("error");
+    Mock::VerifyAndClearExpectations(&filter_);
+
+    expectRequestToBeEnded();
+    checkConnectionState();
+    receiveMessage(MsgStdIn{});
+    receiveMessage(MsgData{});
+    filter_.deferredOutput_->end();
+    EXPECT_FALSE(filter_.deferredOutput_->isValid());
+}
+
+TEST_P(TestFilter, OutputOfAbortedRequest)
+{
+    receiveRequestParams("deferred");
+    ASSERT_TRUE(filter_.deferredOutput_.has_value());
+
+    expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::RequestComplete});
+    checkConnectionState();
+    auto isCancellationHandlerCalled = false;
+    filter_.deferredOutput_->setCancellationHandler(
+            [&isCancellationHandlerCalled]
+            {
+                isCancellationHandlerCalled = true;
+            });
+    receiveMessage(MsgAbortRequest{});
+    Mock::VerifyAndClearExpectations(&filter_);
+    EXPECT_TRUE(isCancellationHandlerCalled);
+    EXPECT_TRUE(filter_.deferredOutput_->isCancelled());
+
+    EXPECT_CALL(filter_, sendData(_)).Times(0);
+    filter_.deferredOutput_->write("data");
+    filter_.deferredOutput_->end();
+}
+
+TEST_P(TestFilter, ResponderRoleIsUnknown)
+{
+    expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::UnknownRole});
+    checkConnectionState();
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()});
+}
+
+INSTANTIATE_TEST_SUITE_P(WithConnectionStateCheck, TestFilter, ::testing::Values(false, true));
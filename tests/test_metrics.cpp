@@ -0,0 +1,342 @@
+#include <constants.h>
+#include <encoder.h>
+#include <msgabortrequest.h>
+#include <msgbeginrequest.h>
+#include <msgendrequest.h>
+#include <msggetvalues.h>
+#include <msggetvaluesresult.h>
+#include <msgparams.h>
+#include <record.h>
+#include <streamdatamessage.h>
+#include <fcgi_responder/metrics.h>
+#include <fcgi_responder/requester.h>
+#include <fcgi_responder/responder.h>
+#include <fcgi_responder/respondergroup.h>
+#include <gtest/gtest.h>
+#include <optional>
+#include <sstream>
+
+using namespace fcgi;
+
+namespace {
+template<typename TMsg>
+std::string messageData(TMsg&& msg, std::uint16_t requestId = 0)
+{
+    auto record = fcgi::Record{std::forward<TMsg>(msg), requestId};
+    auto recordStream = std::ostringstream{};
+    record.toStream(recordStream);
+    return recordStream.str();
+}
+
+std::size_t index(RecordType type)
+{
+    return static_cast<std::size_t>(type);
+}
+
+std::size_t index(ProtocolStatus status)
+{
+    return static_cast<std::size_t>(status);
+}
+
+std::size_t index(MetricsSnapshot::DecodeError error)
+{
+    return static_cast<std::size_t>(error);
+}
+
+std::string requestData(std::uint16_t requestId, const std::string& stdIn = "Hello")
+{
+    auto params = MsgParams{};
+    params.setParam("REQUEST_METHOD", "GET");
+    auto result = messageData(MsgBeginRequest{Role::Responder, ResultConnectionState::KeepOpen}, requestId);
+    result += messageData(std::move(params), requestId);
+    result += messageData(MsgParams{}, requestId);
+    result += messageData(MsgStdIn{stdIn}, requestId);
+    result += messageData(MsgStdIn{}, requestId);
+    return result;
+}
+
+class TestResponder : public Responder {
+public:
+    void receive(const std::string& data)
+    {
+        Responder::receiveData(data.c_str(), data.size());
+    }
+    void reset()
+    {
+        Responder::reset();
+    }
+    void sendResponses()
+    {
+        for (auto& response : responses)
+            response.send();
+        responses.clear();
+    }
+
+    bool isResponseDeferred = false;
+    std::string output;
+    std::vector<Response> responses;
+
+private:
+    void sendData(const std::string& data) override
+    {
+        output += data;
+    }
+    void disconnect() override
+    {
+    }
+    void processRequest(Request&& request, Response&& response) override
+    {
+        response.setData(request.stdIn());
+        if (isResponseDeferred)
+            responses.emplace_back(std::move(response));
+        else
+            response.send();
+    }
+};
+
+class TestRequester : public Requester {
+public:
+    void receive(const std::string& data)
+    {
+        Requester::receiveData(data.c_str(), data.size());
+    }
+    void send(const std::string& data)
+    {
+        Requester::sendRequest(
+                {{"REQUEST_METHOD", "GET"}},
+                data,
+                [this](const std::optional<ResponseData>& response)
+                {
+                    responseData = response;
+                },
+                true);
+    }
+
+    std::string output;
+    std::optional<ResponseData> responseData;
+
+private:
+    void sendData(const std::string& data) override
+    {
+        output += data;
+    }
+    void disconnect() override
+    {
+    }
+};
+
+} //namespace
+
+TEST(Metrics, DisabledByDefault)
+{
+    auto metrics = std::make_shared<Metrics>();
+    auto responder = TestResponder{};
+    responder.receive(requestData(1));
+
+    auto snapshot = metrics->snapshot();
+    EXPECT_EQ(snapshot.connections, 0u);
+    EXPECT_EQ(snapshot.receivedBytes, 0u);
+    EXPECT_EQ(snapshot.startedRequests, 0u);
+}
+
+TEST(Metrics, ResponderRequest)
+{
+    auto metrics = std::make_shared<Metrics>();
+    auto responder = TestResponder{};
+    responder.setMetrics(metrics);
+    auto data = requestData(1);
+    responder.receive(data);
+
+    auto snapshot = metrics->snapshot();
+    EXPECT_EQ(snapshot.connections, 1u);
+    EXPECT_EQ(snapshot.receivedBytes, data.size());
+    EXPECT_EQ(snapshot.sentBytes, responder.output.size());
+    EXPECT_EQ(snapshot.receivedRecords[index(RecordType::BeginRequest)], 1u);
+    EXPECT_EQ(snapshot.receivedRecords[index(RecordType::Params)], 2u);
+    EXPECT_EQ(snapshot.receivedRecords[index(RecordType::StdIn)], 2u);
+    EXPECT_EQ(snapshot.sentRecords[index(RecordType::StdOut)], 2u);
+    EXPECT_EQ(snapshot.sentRecords[index(RecordType::EndRequest)], 1u);
+    EXPECT_EQ(snapshot.startedRequests, 1u);
+    EXPECT_EQ(snapshot.endedRequests[index(ProtocolStatus::RequestComplete)], 1u);
+    EXPECT_EQ(snapshot.activeRequests, 0u);
+    EXPECT_EQ(snapshot.bufferedBytes, 0u);
+}
+
+TEST(Metrics, ResponderGauges)
+{
+    auto metrics = std::make_shared<Metrics>();
+    auto responder = TestResponder{};
+    responder.isResponseDeferred = true;
+    responder.setMetrics(metrics);
+    auto data = requestData(1);
+    responder.receive(data.substr(0, data.size() - messageData(MsgStdIn{}, 1).size()));
+
+    auto snapshot = metrics->snapshot();
+    EXPECT_EQ(snapshot.activeRequests, 1u);
+    EXPECT_EQ(snapshot.bufferedBytes, responder.bufferedRequestDataSize());
+    EXPECT_GT(snapshot.bufferedBytes, 0u);
+
+    responder.receive(messageData(MsgStdIn{}, 1));
+    responder.receive(requestData(2));
+    snapshot = metrics->snapshot();
+    EXPECT_EQ(snapshot.activeRequests, 2u);
+    EXPECT_EQ(snapshot.endedRequests[index(ProtocolStatus::RequestComplete)], 0u);
+
+    responder.sendResponses();
+    snapshot = metrics->snapshot();
+    EXPECT_EQ(snapshot.activeRequests, 0u);
+    EXPECT_EQ(snapshot.bufferedBytes, 0u);
+    EXPECT_EQ(snapshot.endedRequests[index(ProtocolStatus::RequestComplete)], 2u);
+}
+
+TEST(Metrics, ResponderRejectedAndAbortedRequests)
+{
+    auto metrics = std::make_shared<Metrics>();
+    auto responder = TestResponder{};
+    responder.isResponseDeferred = true;
+    responder.setMultiplexingEnabled(false);
+    responder.setMetrics(metrics);
+    responder.receive(messageData(MsgBeginRequest{Role::Authorizer, ResultConnectionState::KeepOpen}, 1));
+    responder.receive(messageData(MsgBeginRequest{Role::Responder, ResultConnectionState::KeepOpen}, 1));
+    responder.receive(messageData(MsgBeginRequest{Role::Responder, ResultConnectionState::KeepOpen}, 2));
+    responder.receive(messageData(MsgAbortRequest{}, 1));
+
+    auto snapshot = metrics->snapshot();
+    EXPECT_EQ(snapshot.startedRequests, 1u);
+    EXPECT_EQ(snapshot.abortedRequests, 1u);
+    EXPECT_EQ(snapshot.endedRequests[index(ProtocolStatus::UnknownRole)], 1u);
+    EXPECT_EQ(snapshot.endedRequests[index(ProtocolStatus::CantMpxConn)], 1u);
+    EXPECT_EQ(snapshot.endedRequests[index(ProtocolStatus::RequestComplete)], 1u);
+    EXPECT_EQ(snapshot.sentRecords[index(RecordType::EndRequest)], 3u);
+    EXPECT_EQ(snapshot.activeRequests, 0u);
+}
+
+TEST(Metrics, ResponderDecodeErrors)
+{
+    auto metrics = std::make_shared<Metrics>();
+    auto responder = TestResponder{};
+    responder.setMetrics(metrics);
+    responder.receive(messageData(MsgAbortRequest{}, 1));
+
+    auto output = std::ostringstream{};
+    auto encoder = Encoder(output);
+    encoder << hardcoded::protocolVersion << static_cast<std::uint8_t>(99) << static_cast<std::uint16_t>(1)
+            << static_cast<std::uint16_t>(0) << static_cast<std::uint8_t>(0);
+    encoder.addPadding(1);
+    responder.receive(output.str());
+
+    auto snapshot = metrics->snapshot();
+    EXPECT_EQ(snapshot.decodeErrors[index(MetricsSnapshot::DecodeError::UnexpectedRecord)], 1u);
+    EXPECT_EQ(snapshot.decodeErrors[index(MetricsSnapshot::DecodeError::InvalidRecordType)], 1u);
+    EXPECT_EQ(snapshot.sentRecords[index(RecordType::UnknownType)], 1u);
+}
+
+TEST(Metrics, DetachedConnectionsTotals)
+{
+    auto metrics = std::make_shared<Metrics>();
+    auto responderGroup = std::make_shared<ResponderGroup>();
+    responderGroup->setMetrics(metrics);
+    {
+        auto responder = TestResponder{};
+        responder.isResponseDeferred = true;
+        responder.setResponderGroup(responderGroup);
+        responder.receive(requestData(1));
+        auto otherResponder = TestResponder{};
+        otherResponder.setResponderGroup(responderGroup);
+        otherResponder.receive(requestData(1));
+
+        auto snapshot = metrics->snapshot();
+        EXPECT_EQ(snapshot.connections, 2u);
+        EXPECT_EQ(snapshot.startedRequests, 2u);
+        EXPECT_EQ(snapshot.activeRequests, 1u);
+    }
+
+    auto snapshot = metrics->snapshot();
+    EXPECT_EQ(snapshot.connections, 0u);
+    EXPECT_EQ(snapshot.startedRequests, 2u);
+    EXPECT_EQ(snapshot.endedRequests[index(ProtocolStatus::RequestComplete)], 1u);
+    EXPECT_EQ(snapshot.activeRequests, 0u);
+}
+
+TEST(Metrics, ResponderReusedAfterReset)
+{
+    auto metrics = std::make_shared<Metrics>();
+    auto responder = TestResponder{};
+    responder.isResponseDeferred = true;
+    responder.setMetrics(metrics);
+    responder.receive(requestData(1));
+    EXPECT_EQ(metrics->snapshot().connections, 1u);
+
+    responder.reset();
+    auto snapshot = metrics->snapshot();
+    EXPECT_EQ(snapshot.connections, 0u);
+    EXPECT_EQ(snapshot.startedRequests, 1u);
+    EXPECT_EQ(snapshot.activeRequests, 0u);
+
+    responder.isResponseDeferred = false;
+    responder.receive(requestData(1));
+    snapshot = metrics->snapshot();
+    EXPECT_EQ(snapshot.connections, 1u);
+    EXPECT_EQ(snapshot.startedRequests, 2u);
+    EXPECT_EQ(snapshot.endedRequests[index(ProtocolStatus::RequestComplete)], 1u);
+    EXPECT_EQ(snapshot.activeRequests, 0u);
+
+    responder.reset();
+    EXPECT_EQ(metrics->snapshot().connections, 0u);
+}
+
+TEST(Metrics, RequesterRequest)
+{
+    auto metrics = std::make_shared<Metrics>();
+    auto requester = TestRequester{};
+    requester.setMetrics(metrics);
+    requester.send("Hello");
+
+    auto getValuesResult = MsgGetValuesResult{};
+    getValuesResult.setRequestValue(ValueRequest::MaxReqs, "10");
+    getValuesResult.setRequestValue(ValueRequest::MpxsConns, "1");
+    requester.receive(messageData(getValuesResult));
+
+    auto snapshot = metrics->snapshot();
+    EXPECT_EQ(snapshot.startedRequests, 1u);
+    EXPECT_EQ(snapshot.activeRequests, 1u);
+    EXPECT_EQ(snapshot.sentRecords[index(RecordType::GetValues)], 1u);
+    EXPECT_EQ(snapshot.sentRecords[index(RecordType::BeginRequest)], 1u);
+    EXPECT_EQ(snapshot.sentRecords[index(RecordType::Params)], 2u);
+    EXPECT_EQ(snapshot.sentRecords[index(RecordType::StdIn)], 2u);
+    EXPECT_EQ(snapshot.sentBytes, requester.output.size());
+
+    requester.receive(messageData(MsgStdOut{"World"}, 1));
+    snapshot = metrics->snapshot();
+    EXPECT_EQ(snapshot.bufferedBytes, 5u);
+
+    requester.receive(messageData(MsgEndRequest{0, ProtocolStatus::RequestComplete}, 1));
+    snapshot = metrics->snapshot();
+    ASSERT_TRUE(requester.responseData);
+    EXPECT_EQ(requester.responseData->data, "World");
+    EXPECT_EQ(snapshot.receivedRecords[index(RecordType::GetValuesResult)], 1u);
+    EXPECT_EQ(snapshot.receivedRecords[index(RecordType::StdOut)], 1u);
+    EXPECT_EQ(snapshot.receivedRecords[index(RecordType::EndRequest)], 1u);
+    EXPECT_EQ(snapshot.endedRequests[index(ProtocolStatus::RequestComplete)], 1u);
+    EXPECT_EQ(snapshot.activeRequests, 0u);
+    EXPECT_EQ(snapshot.bufferedBytes, 0u);
+}
+
+TEST(Metrics, PrometheusText)
+{
+    auto snapshot = MetricsSnapshot{};
+    snapshot.receivedRecords[index(RecordType::BeginRequest)] = 3;
+    snapshot.endedRequests[index(ProtocolStatus::Overloaded)] = 2;
+    snapshot.decodeErrors[index(MetricsSnapshot::DecodeError::MalformedRecord)] = 1;
+    snapshot.receivedBytes = 100;
+    snapshot.activeRequests = 4;
+
+    auto text = toPrometheusText(snapshot, "app");
+    EXPECT_NE(text.find("# TYPE app_records_received_total counter\n"), std::string::npos);
+    EXPECT_NE(text.find("app_records_received_total{type=\"BEGIN_REQUEST\"} 3\n"), std::string::npos);
+    EXPECT_NE(text.find("app_records_received_total{type=\"UNKNOWN_TYPE\"} 0\n"), std::string::npos);
+    EXPECT_NE(text.find("app_requests_ended_total{status=\"OVERLOADED\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("app_decode_errors_total{kind=\"malformed_record\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("app_received_bytes_total 100\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE app_active_requests gauge\napp_active_requests 4\n"), std::string::npos);
+}
@@ -0,0 +1,83 @@
+#include <fcgi_responder/overloadcontrol.h>
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+TEST(OverloadControl, RequestsLimit)
+{
+    auto overloadControl = fcgi::OverloadControl{10ms, 1, 2};
+    EXPECT_EQ(overloadControl.requestsLimit(), 2);
+    EXPECT_TRUE(overloadControl.tryAcquireRequest());
+    EXPECT_TRUE(overloadControl.tryAcquireRequest());
+    EXPECT_FALSE(overloadControl.tryAcquireRequest());
+    EXPECT_EQ(overloadControl.activeRequestsNumber(), 2);
+
+    overloadControl.releaseRequest();
+    EXPECT_EQ(overloadControl.activeRequestsNumber(), 1);
+    EXPECT_TRUE(overloadControl.tryAcquireRequest());
+}
+
+TEST(OverloadControl, AcquireRequestOverLimit)
+{
+    auto overloadControl = fcgi::OverloadControl{10ms, 1, 1};
+    EXPECT_TRUE(overloadControl.tryAcquireRequest());
+    overloadControl.acquireRequest();
+    EXPECT_EQ(overloadControl.activeRequestsNumber(), 2);
+
+    overloadControl.releaseRequest();
+    EXPECT_FALSE(overloadControl.tryAcquireRequest());
+    overloadControl.releaseRequest();
+    EXPECT_TRUE(overloadControl.tryAcquireRequest());
+}
+
+TEST(OverloadControl, LatencyTargetExceeded)
+{
+    auto overloadControl = fcgi::OverloadControl{10ms, 2, 10};
+    overloadControl.setDecreaseFactor(0.5);
+    overloadControl.addLatencySample(20ms);
+    EXPECT_EQ(overloadControl.requestsLimit(), 5);
+    EXPECT_EQ(overloadControl.lastLatency(), 20ms);
+
+    // the limit isn't decreased again until the current limit number of requests is completed
+    for (auto i = 0; i < 4; ++i)
+        overloadControl.addLatencySample(20ms);
+    EXPECT_EQ(overloadControl.requestsLimit(), 5);
+
+    overloadControl.addLatencySample(20ms);
+    EXPECT_EQ(overloadControl.requestsLimit(), 2);
+
+    for (auto i = 0; i < 10; ++i)
+        overloadControl.addLatencySample(20ms);
+    EXPECT_EQ(overloadControl.requestsLimit(), 2);
+}
+
+TEST(OverloadControl, LatencyTargetMet)
+{
+    auto overloadControl = fcgi::OverloadControl{10ms, 1, 4};
+    overloadControl.setDecreaseFactor(0.5);
+    overloadControl.addLatencySample(20ms);
+    EXPECT_EQ(overloadControl.requestsLimit(), 2);
+
+    // the limit is increased by one after approximately the current limit number of requests
+    for (auto i = 0; i < 3; ++i)
+        overloadControl.addLatencySample(5ms);
+    EXPECT_EQ(overloadControl.requestsLimit(), 3);
+
+    for (auto i = 0; i < 100; ++i)
+        overloadControl.addLatencySample(5ms);
+    EXPECT_EQ(overloadControl.requestsLimit(), 4);
+}
+
+TEST(OverloadControl, OutputQueueSize)
+{
+    auto overloadControl = fcgi::OverloadControl{10ms};
+    overloadControl.setMaximumOutputQueueSize(100);
+    overloadControl.updateOutputQueueSize(0, 60);
+    overloadControl.updateOutputQueueSize(0, 40);
+    EXPECT_EQ(overloadControl.outputQueueSize(), 100);
+    EXPECT_FALSE(overloadControl.tryAcquireRequest());
+
+    overloadControl.updateOutputQueueSize(60, 10);
+    EXPECT_EQ(overloadControl.outputQueueSize(), 50);
+    EXPECT_TRUE(overloadControl.tryAcquireRequest());
+}
@@ -9,6 +9,7 @@
 #include <namevalue.h>
 #include <record.h>
 #include <streamdatamessage.h>
+#include <fcgi_responder/requestparams.h>
 #include <gtest/gtest.h>
 #include <functional>
 
@@ -131,6 +132,30 @@ TEST(RecordSerialization, MsgParams2)
         ASSERT_EQ(msg.paramValue(param), readMsg.paramValue(param));
 }
 
+TEST(RecordSerialization, RequestParams)
+{
+    const auto longName = "HTTP_" + std::string(200, 'N');
+    const auto longValue = std::string(1000, 'v');
+    auto params = fcgi::RequestParams{{"Hello", "World"}, {longName, longValue}, {"EMPTY", ""}};
+
+    auto msg = fcgi::MsgParams{};
+    msg.setParam("Hello", "World");
+    msg.setParam(longName, longValue);
+    msg.setParam("EMPTY", "");
+    auto output = std::ostringstream{};
+    msg.toStream(output);
+    EXPECT_EQ(params.data(), output.str());
+
+    auto input = std::istringstream{std::string{params.data()}};
+    auto readMsg = fcgi::MsgParams{};
+    readMsg.fromStream(input, params.data().size());
+    EXPECT_EQ(readMsg, msg);
+
+    params.clear();
+    EXPECT_TRUE(params.isEmpty());
+    EXPECT_TRUE(params.data().empty());
+}
+
 TEST(RecordSerialization, MsgUnkownType)
 {
     auto msg = fcgi::MsgUnknownType{77};
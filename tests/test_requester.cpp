@@ -10,6 +10,8 @@
 #include <streamdatamessage.h>
 #include <fcgi_responder/request.h>
 #include <fcgi_responder/requester.h>
+#include <fcgi_responder/responder.h>
+#include <fcgi_responder/timerwheel.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -27,7 +29,8 @@ public:
     }
     std::optional<fcgi::RequestHandle> send(
             const std::map<std::string, std::string>& fcgiParams,
-            const std::string& fcgiData)
+            const std::string& fcgiData,
+            bool keepConnection = false)
     {
         return Requester::sendRequest(
                 fcgiParams,
@@ -35,8 +38,78 @@ public:
                 [this](const std::optional<ResponseData>& response)
                 {
                     onResponseReceived(response);
-                });
+                },
+                keepConnection);
+    }
+    std::optional<fcgi::RequestHandle> sendStreamed(
+            const std::map<std::string, std::string>& fcgiParams,
+            const std::string& fcgiData,
+            bool keepConnection = false)
+    {
+        return Requester::sendRequest(
+                fcgiParams,
+                fcgiData,
+                ResponseStreamHandler{
+                        [this](std::string_view data)
+                        {
+                            onDataReceived(std::string{data});
+                        },
+                        [this](std::string_view errorMsg)
+                        {
+                            onErrorMsgReceived(std::string{errorMsg});
+                        },
+                        [this](bool isComplete)
+                        {
+                            onResponseEnded(isComplete);
+                        }},
+                keepConnection);
+    }
+    std::optional<fcgi::RequestHandle> sendPrepared(
+            const RequestParams& fcgiParams,
+            const std::string& fcgiData,
+            bool keepConnection = false)
+    {
+        return Requester::sendPreparedRequest(
+                fcgiParams,
+                fcgiData,
+                [this](const std::optional<ResponseData>& response)
+                {
+                    onResponseReceived(response);
+                },
+                keepConnection);
+    }
+    std::optional<fcgi::RequestDataWriter> start(
+            const std::map<std::string, std::string>& fcgiParams,
+            bool keepConnection = false)
+    {
+        return Requester::startRequest(
+                fcgiParams,
+                [this](const std::optional<ResponseData>& response)
+                {
+                    onResponseReceived(response);
+                },
+                keepConnection);
+    }
+    void notifyWritable()
+    {
+        Requester::onWritable();
     }
+    void setWritable(bool state)
+    {
+        isWritable_ = state;
+    }
+    MOCK_METHOD1(onDataReceived, void(const std::string& data));
+    MOCK_METHOD1(onErrorMsgReceived, void(const std::string& errorMsg));
+    MOCK_METHOD1(onResponseEnded, void(bool isComplete));
+
+protected:
+    bool isWritable() const override
+    {
+        return isWritable_;
+    }
+
+private:
+    bool isWritable_ = true;
 };
 
 namespace {
@@ -48,6 +121,20 @@ std::string messageData(Args&&... args)
     record.toStream(recordStream);
     return recordStream.str();
 }
+
+std::string paramsRecordData(std::string_view data, std::uint16_t requestId)
+{
+    const auto paddingLength = static_cast<std::uint8_t>((8 - data.size() % 8) % 8);
+    auto recordStream = std::ostringstream{};
+    writeRecordHeader(
+            recordStream,
+            RecordType::Params,
+            requestId,
+            static_cast<std::uint16_t>(data.size()),
+            paddingLength);
+    recordStream << data << std::string(paddingLength, '\0');
+    return recordStream.str();
+}
 } //namespace
 
 namespace fcgi {
@@ -149,7 +236,16 @@ protected:
         if (!fcgiData.empty() && lastPacketSize)
             expectMessageToBeSent(MsgStdIn{""}, requestId);
 
-        auto requestHandle = requester_.send(fcgiParams, fcgiData);
+        auto requestHandle = std::optional<fcgi::RequestHandle>{};
+        if (streamResponse_)
+            requestHandle = requester_.sendStreamed(fcgiParams, fcgiData, keepConnection_);
+        else if (prepareParams_)
+            requestHandle = requester_.sendPrepared(
+                    RequestParams{fcgiParams.begin(), fcgiParams.end()},
+                    fcgiData,
+                    keepConnection_);
+        else
+            requestHandle = requester_.send(fcgiParams, fcgiData, keepConnection_);
         if (firstRequest_) {
             auto msgGetValuesResult = MsgGetValuesResult{};
             msgGetValuesResult.setRequestValue(ValueRequest::MaxReqs, std::to_string(maxRequestsNumber));
@@ -160,9 +256,32 @@ protected:
         return requestHandle;
     }
 
+    std::optional<fcgi::RequestDataWriter> startRequest(std::uint16_t requestId = 1)
+    {
+        if (firstRequest_) {
+            auto msgGetValues = MsgGetValues{};
+            msgGetValues.requestValue(ValueRequest::MaxReqs);
+            msgGetValues.requestValue(ValueRequest::MpxsConns);
+            expectMessageToBeSent(msgGetValues);
+        }
+        expectMessageToBeSent(MsgBeginRequest{Role::Responder, ResultConnectionState::Close}, requestId);
+        expectMessageToBeSent(MsgParams{}, requestId);
+        auto requestDataWriter = requester_.start({});
+        if (firstRequest_) {
+            auto msgGetValuesResult = MsgGetValuesResult{};
+            msgGetValuesResult.setRequestValue(ValueRequest::MaxReqs, "10");
+            msgGetValuesResult.setRequestValue(ValueRequest::MpxsConns, "1");
+            receiveMessage(msgGetValuesResult);
+        }
+        firstRequest_ = false;
+        return requestDataWriter;
+    }
+
     MockRequester requester_;
     std::string errorInfo_;
     bool keepConnection_ = false;
+    bool streamResponse_ = false;
+    bool prepareParams_ = false;
     bool firstRequest_ = true;
 };
 
@@ -179,6 +298,27 @@ TEST_P(TestRequester, UnknownType)
     receiveMessage(msgUnknownType, requestId);
 }
 
+TEST_P(TestRequester, UnknownTypeErrorEvent)
+{
+    auto events = std::vector<ErrorEvent>{};
+    requester_.setErrorEventHandler(
+            [&events](const ErrorEvent& event)
+            {
+                events.push_back(event);
+            });
+    const auto seq = InSequence{};
+    const auto requestId = 1;
+    makeRequest({}, "", requestId);
+
+    expectMessageToBeSent(MsgAbortRequest{}, requestId);
+    receiveMessage(MsgUnknownType{77}, requestId);
+    ASSERT_EQ(events.size(), 1);
+    EXPECT_EQ(events[0].code, ErrorCode::UnknownTypeReceived);
+    EXPECT_EQ(events[0].requestId, requestId);
+    EXPECT_EQ(events[0].detail, 77);
+    EXPECT_EQ(errorInfo_, "Received unknown record type: 77\n");
+}
+
 TEST_P(TestRequester, NoResponseOverloaded)
 {
     const auto seq = InSequence{};
@@ -267,6 +407,24 @@ TEST_P(TestRequester, LargeRequest)
     receiveMessage(MsgEndRequest{0, ProtocolStatus::RequestComplete}, requestId);
 }
 
+TEST_P(TestRequester, LargeRequestWithThreadLocalSerializationBuffer)
+{
+    requester_.setThreadLocalSerializationBufferEnabled(true);
+    EXPECT_TRUE(requester_.isThreadLocalSerializationBufferEnabled());
+    const auto seq = InSequence{};
+    const auto requestId = 1;
+    auto requestData = std::string{};
+    for (auto i = 0; i < 3; ++i)
+        requestData += std::string(hardcoded::maxDataMessageSize, '0');
+
+    makeRequest({}, requestData, requestId);
+    expectReceiveResponse(ResponseData{"Hello world", ""});
+    receiveMessage(MsgStdOut{"Hello world"}, requestId);
+    receiveMessage(MsgStdOut{}, requestId);
+    receiveMessage(MsgStdErr{}, requestId);
+    receiveMessage(MsgEndRequest{0, ProtocolStatus::RequestComplete}, requestId);
+}
+
 TEST_P(TestRequester, ResponseDataMultiRequests)
 {
     const auto seq = InSequence{};
@@ -329,6 +487,267 @@ TEST_P(TestRequester, CancelRequestDuringResponse)
     EXPECT_EQ(requester_.availableRequestsNumber(), 10);
 }
 
+TEST_P(TestRequester, ResponseTimeout)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    auto timerWheel = std::make_shared<TimerWheel>(std::chrono::milliseconds{1}, startTime);
+    requester_.setTimerWheel(timerWheel);
+    requester_.setResponseTimeout(std::chrono::milliseconds{100});
+    EXPECT_EQ(requester_.responseTimeout(), std::chrono::milliseconds{100});
+    const auto requestId = 1;
+    makeRequest({}, "", requestId);
+    EXPECT_CALL(requester_, onResponseReceived(_)).Times(0);
+    timerWheel->tick(startTime + std::chrono::milliseconds{99});
+    Mock::VerifyAndClearExpectations(&requester_);
+
+    expectReceiveResponse(std::nullopt);
+    timerWheel->tick(startTime + std::chrono::milliseconds{100});
+    EXPECT_EQ(requester_.availableRequestsNumber(), 10);
+    EXPECT_EQ(errorInfo_, "Request timeout, requestId = 1\n");
+}
+
+TEST_P(TestRequester, ResponseTimeoutWithKeptConnection)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    auto timerWheel = std::make_shared<TimerWheel>(std::chrono::milliseconds{1}, startTime);
+    requester_.setTimerWheel(timerWheel);
+    requester_.setResponseTimeout(std::chrono::milliseconds{100});
+    keepConnection_ = true;
+    const auto requestId = 1;
+    auto requestHandle = makeRequest({}, "", requestId);
+
+    expectMessageToBeSent(MsgAbortRequest{}, requestId);
+    EXPECT_CALL(requester_, onResponseReceived(std::optional<ResponseData>{}));
+    EXPECT_CALL(requester_, disconnect()).Times(0);
+    timerWheel->tick(startTime + std::chrono::milliseconds{100});
+    requestHandle->cancelRequest();
+    // the request id isn't reused until the aborted request is ended
+    EXPECT_EQ(requester_.availableRequestsNumber(), 9);
+    receiveMessage(MsgStdOut{"Hello world"}, requestId);
+    receiveMessage(MsgEndRequest{0, ProtocolStatus::RequestComplete}, requestId);
+    EXPECT_EQ(requester_.availableRequestsNumber(), 10);
+    EXPECT_EQ(errorInfo_, "Request timeout, requestId = 1\n");
+}
+
+TEST_P(TestRequester, ConnectionInitializationTimeout)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    auto timerWheel = std::make_shared<TimerWheel>(std::chrono::milliseconds{1}, startTime);
+    requester_.setTimerWheel(timerWheel);
+    requester_.setResponseTimeout(std::chrono::milliseconds{100});
+    auto msgGetValues = MsgGetValues{};
+    msgGetValues.requestValue(ValueRequest::MaxReqs);
+    msgGetValues.requestValue(ValueRequest::MpxsConns);
+    expectMessageToBeSent(msgGetValues);
+    auto requestHandle = requester_.send({}, "");
+
+    EXPECT_CALL(requester_, onResponseReceived(std::optional<ResponseData>{}));
+    EXPECT_CALL(requester_, disconnect());
+    timerWheel->tick(startTime + std::chrono::milliseconds{100});
+    requestHandle->cancelRequest();
+    EXPECT_EQ(requester_.availableRequestsNumber(), 1);
+    EXPECT_EQ(errorInfo_, "Request timeout, requestId = 0\n");
+}
+
+TEST_P(TestRequester, StreamedResponse)
+{
+    streamResponse_ = true;
+    keepConnection_ = GetParam();
+    const auto requestId = 1;
+    makeRequest({}, "", requestId);
+
+    // the response data is passed to the handlers as soon as it's received
+    EXPECT_CALL(requester_, onDataReceived("Hello"));
+    receiveMessage(MsgStdOut{"Hello"}, requestId);
+    Mock::VerifyAndClearExpectations(&requester_);
+
+    const auto seq = InSequence{};
+    EXPECT_CALL(requester_, onErrorMsgReceived("error#1"));
+    EXPECT_CALL(requester_, onDataReceived(" world"));
+    EXPECT_CALL(requester_, onResponseEnded(true));
+    EXPECT_CALL(requester_, disconnect()).Times(keepConnection_ ? 0 : 1);
+    receiveMessage(MsgStdErr{"error#1"}, requestId);
+    receiveMessage(MsgStdOut{" world"}, requestId);
+    receiveMessage(MsgStdOut{}, requestId);
+    receiveMessage(MsgStdErr{}, requestId);
+    receiveMessage(MsgEndRequest{0, ProtocolStatus::RequestComplete}, requestId);
+    EXPECT_EQ(requester_.availableRequestsNumber(), 10);
+    EXPECT_TRUE(errorInfo_.empty());
+}
+
+TEST_P(TestRequester, StreamedResponseCancelledByHandler)
+{
+    streamResponse_ = true;
+    const auto requestId = 1;
+    auto requestHandle = makeRequest({}, "", requestId);
+
+    const auto seq = InSequence{};
+    EXPECT_CALL(requester_, onDataReceived("Hello"))
+            .WillOnce(Invoke(
+                    [&requestHandle](const std::string&)
+                    {
+                        requestHandle->cancelRequest();
+                    }));
+    EXPECT_CALL(requester_, onResponseEnded(false));
+    receiveMessage(MsgStdOut{"Hello"}, requestId);
+    EXPECT_EQ(requester_.availableRequestsNumber(), 10);
+}
+
+TEST_P(TestRequester, PreparedRequest)
+{
+    prepareParams_ = true;
+    keepConnection_ = GetParam();
+    const auto seq = InSequence{};
+    const auto requestId = 1;
+    makeRequest({{"REQUEST_METHOD", "GET"}, {"SCRIPT_NAME", "/test"}}, "Hello", requestId);
+    expectReceiveResponse(ResponseData{"Hello world", ""});
+    receiveMessage(MsgStdOut{"Hello world"}, requestId);
+    receiveMessage(MsgStdOut{}, requestId);
+    receiveMessage(MsgStdErr{}, requestId);
+    receiveMessage(MsgEndRequest{0, ProtocolStatus::RequestComplete}, requestId);
+}
+
+TEST_P(TestRequester, PreparedRequestLargeParams)
+{
+    const auto seq = InSequence{};
+    const auto requestId = 1;
+    const auto value = std::string(40000, 'v');
+    const auto largeValue = std::string(hardcoded::maxDataMessageSize, 'v');
+    const auto params = RequestParams{{"FIRST", value}, {"SECOND", value}, {"LARGE", largeValue}};
+    const auto firstPairSize = 1 + 4 + 5 + value.size();
+    const auto secondPairSize = 1 + 4 + 6 + value.size();
+
+    auto msgGetValues = MsgGetValues{};
+    msgGetValues.requestValue(ValueRequest::MaxReqs);
+    msgGetValues.requestValue(ValueRequest::MpxsConns);
+    expectMessageToBeSent(msgGetValues);
+    requester_.sendPrepared(params, "");
+
+    // the records are split on the name-value pair boundaries, only the pair exceeding the record size is split
+    auto paramsData = params.data();
+    expectMessageToBeSent(MsgBeginRequest{Role::Responder, ResultConnectionState::Close}, requestId);
+    EXPECT_CALL(requester_, sendData(paramsRecordData(paramsData.substr(0, firstPairSize), requestId)));
+    paramsData.remove_prefix(firstPairSize);
+    EXPECT_CALL(requester_, sendData(paramsRecordData(paramsData.substr(0, secondPairSize), requestId)));
+    paramsData.remove_prefix(secondPairSize);
+    EXPECT_CALL(
+            requester_,
+            sendData(paramsRecordData(paramsData.substr(0, hardcoded::maxDataMessageSize), requestId)));
+    paramsData.remove_prefix(hardcoded::maxDataMessageSize);
+    EXPECT_CALL(requester_, sendData(paramsRecordData(paramsData, requestId)));
+    expectMessageToBeSent(MsgParams{}, requestId);
+    expectMessageToBeSent(MsgStdIn{}, requestId);
+    auto msgGetValuesResult = MsgGetValuesResult{};
+    msgGetValuesResult.setRequestValue(ValueRequest::MaxReqs, "10");
+    msgGetValuesResult.setRequestValue(ValueRequest::MpxsConns, "1");
+    receiveMessage(msgGetValuesResult);
+}
+
+TEST_P(TestRequester, StreamedRequestData)
+{
+    keepConnection_ = GetParam();
+    const auto seq = InSequence{};
+    const auto requestId = 1;
+    auto msgGetValues = MsgGetValues{};
+    msgGetValues.requestValue(ValueRequest::MaxReqs);
+    msgGetValues.requestValue(ValueRequest::MpxsConns);
+    expectMessageToBeSent(msgGetValues);
+    auto requestDataWriter = requester_.start({{"REQUEST_METHOD", "POST"}}, keepConnection_);
+    ASSERT_TRUE(requestDataWriter);
+    // the data written during the connection initialization is buffered
+    requestDataWriter->write("Hello");
+    EXPECT_FALSE(requestDataWriter->isWritable());
+
+    auto writableHandlerCallsNumber = 0;
+    requestDataWriter->setWritableHandler(
+            [&]
+            {
+                if (++writableHandlerCallsNumber == 2) {
+                    requestDataWriter->write(" world");
+                    requestDataWriter->end();
+                }
+            });
+
+    expectMessageToBeSent(
+            MsgBeginRequest{
+                    Role::Responder,
+                    keepConnection_ ? ResultConnectionState::KeepOpen : ResultConnectionState::Close},
+            requestId);
+    auto paramsMsg = MsgParams{};
+    paramsMsg.setParam("REQUEST_METHOD", "POST");
+    expectMessageToBeSent(paramsMsg, requestId);
+    expectMessageToBeSent(MsgParams{}, requestId);
+    expectMessageToBeSent(MsgStdIn{"Hello"}, requestId);
+    auto msgGetValuesResult = MsgGetValuesResult{};
+    msgGetValuesResult.setRequestValue(ValueRequest::MaxReqs, "10");
+    msgGetValuesResult.setRequestValue(ValueRequest::MpxsConns, "1");
+    receiveMessage(msgGetValuesResult);
+    EXPECT_EQ(writableHandlerCallsNumber, 1);
+    EXPECT_TRUE(requestDataWriter->isWritable());
+
+    // the writers wait while the transport isn't writable
+    requester_.setWritable(false);
+    EXPECT_FALSE(requestDataWriter->isWritable());
+    requester_.setWritable(true);
+
+    expectMessageToBeSent(MsgStdIn{" world"}, requestId);
+    expectMessageToBeSent(MsgStdIn{}, requestId);
+    requester_.notifyWritable();
+    EXPECT_EQ(writableHandlerCallsNumber, 2);
+    EXPECT_FALSE(requestDataWriter->isValid());
+    requester_.notifyWritable();
+    EXPECT_EQ(writableHandlerCallsNumber, 2);
+
+    expectReceiveResponse(ResponseData{"Hello world", ""});
+    receiveMessage(MsgStdOut{"Hello world"}, requestId);
+    receiveMessage(MsgStdOut{}, requestId);
+    receiveMessage(MsgStdErr{}, requestId);
+    receiveMessage(MsgEndRequest{0, ProtocolStatus::RequestComplete}, requestId);
+    EXPECT_EQ(requester_.availableRequestsNumber(), 10);
+}
+
+TEST_P(TestRequester, StreamedRequestDataLargeChunk)
+{
+    const auto seq = InSequence{};
+    const auto requestId = 1;
+    auto requestDataWriter = startRequest(requestId);
+    ASSERT_TRUE(requestDataWriter);
+    EXPECT_TRUE(requestDataWriter->isWritable());
+
+    const auto data = std::string(hardcoded::maxDataMessageSize + 10, 'x');
+    expectMessageToBeSent(MsgStdIn{std::string_view{data.data(), hardcoded::maxDataMessageSize}}, requestId);
+    expectMessageToBeSent(MsgStdIn{std::string_view{data.data(), 10}}, requestId);
+    expectMessageToBeSent(MsgStdIn{}, requestId);
+    requestDataWriter->write(data);
+    requestDataWriter->end();
+    requestDataWriter->write(data);
+}
+
+TEST_P(TestRequester, StreamedRequestDataCancelled)
+{
+    const auto seq = InSequence{};
+    const auto requestId = 1;
+    auto requestDataWriter = startRequest(requestId);
+    ASSERT_TRUE(requestDataWriter);
+    auto writableHandlerCallsNumber = 0;
+    requestDataWriter->setWritableHandler(
+            [&]
+            {
+                ++writableHandlerCallsNumber;
+            });
+
+    EXPECT_CALL(requester_, onResponseReceived(std::optional<ResponseData>{}));
+    requestDataWriter->cancelRequest();
+    EXPECT_FALSE(*requestDataWriter);
+    EXPECT_EQ(requester_.availableRequestsNumber(), 10);
+
+    expectNoMessagesToBeSent();
+    requestDataWriter->write("Hello");
+    requestDataWriter->end();
+    requester_.notifyWritable();
+    EXPECT_EQ(writableHandlerCallsNumber, 0);
+}
+
 TEST_P(TestRequester, RequestExceedsMaxNumber)
 {
     const auto seq = InSequence{};
@@ -348,4 +767,78 @@ TEST_P(TestRequester, RequestExceedsMaxNumber)
     EXPECT_EQ(requester_.availableRequestsNumber(), 1);
 }
 
+namespace {
+class EchoResponder : public Responder {
+public:
+    std::function<void(const std::string&)> sendDataHandler;
+
+    void receive(const std::string& data)
+    {
+        receiveData(data.c_str(), data.size());
+    }
+
+private:
+    void sendData(const std::string& data) override
+    {
+        sendDataHandler(data);
+    }
+    void disconnect() override
+    {
+    }
+    void processRequest(Request&& request, Response&& response) override
+    {
+        response.setData(request.stdIn());
+        response.send();
+    }
+};
+
+class DirectRequester : public Requester {
+public:
+    std::function<void(const std::string&)> sendDataHandler;
+    using Requester::receiveData;
+
+private:
+    void sendData(const std::string& data) override
+    {
+        sendDataHandler(data);
+    }
+    void disconnect() override
+    {
+    }
+};
+} //namespace
+
+TEST(TestRequesterWithResponder, ThreadLocalSerializationBufferWithDirectConnection)
+{
+    auto responder = EchoResponder{};
+    auto requester = DirectRequester{};
+    responder.setThreadLocalSerializationBufferEnabled(true);
+    requester.setThreadLocalSerializationBufferEnabled(true);
+    responder.sendDataHandler = [&](const std::string& data)
+    {
+        requester.receiveData(data.c_str(), data.size());
+    };
+    requester.sendDataHandler = [&](const std::string& data)
+    {
+        const auto sentData = data;
+        responder.receive(data);
+        EXPECT_EQ(data, sentData);
+    };
+
+    auto requestData = std::string{};
+    for (auto i = 0; i < 3; ++i)
+        requestData += std::string(hardcoded::maxDataMessageSize, static_cast<char>('a' + i));
+    auto response = std::optional<ResponseData>{};
+    requester.sendRequest(
+            {{"REQUEST_METHOD", "POST"}},
+            requestData,
+            [&response](std::optional<ResponseData> responseData)
+            {
+                response = std::move(responseData);
+            },
+            true);
+    ASSERT_TRUE(response);
+    EXPECT_EQ(response->data, requestData);
+}
+
 INSTANTIATE_TEST_SUITE_P(TestRequester, TestRequester, Values(false, true));
\ No newline at end of file
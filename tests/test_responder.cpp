@@ -9,7 +9,10 @@
 #include <msgunknowntype.h>
 #include <record.h>
 #include <streamdatamessage.h>
+#include <fcgi_responder/overloadcontrol.h>
+#include <fcgi_responder/respondergroup.h>
 #include <fcgi_responder/responder.h>
+#include <fcgi_responder/timerwheel.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -60,7 +63,123 @@ public:
     }
 };
 
+class MockResponderWithFileProcessor : public Responder {
+public:
+    MOCK_METHOD1(sendData, void(const std::string& data));
+    MOCK_METHOD1(sendFileData, void(const FileRegion& fileRegion));
+    MOCK_METHOD0(disconnect, void());
+    void processRequest(Request&& request, Response&& response) override
+    {
+        response.setFileData(FileRegion{3, 100, std::stoul(request.stdIn())});
+        response.send();
+    }
+    void receive(const std::string& data)
+    {
+        Responder::receiveData(data.c_str(), data.size());
+    }
+};
+
+class MockResponderWithUnreadableFileProcessor : public Responder {
+public:
+    MOCK_METHOD1(sendData, void(const std::string& data));
+    MOCK_METHOD0(disconnect, void());
+    void processRequest(Request&&, Response&& response) override
+    {
+        response.setFileData(FileRegion{-1, 0, 100000});
+        response.send();
+    }
+    void receive(const std::string& data)
+    {
+        Responder::receiveData(data.c_str(), data.size());
+    }
+};
+
+class MockResponderWithSharedDataProcessor : public Responder {
+public:
+    MOCK_METHOD1(sendData, void(const std::string& data));
+    MOCK_METHOD0(disconnect, void());
+    void processRequest(Request&&, Response&& response) override
+    {
+        response.setData(payload);
+        response.send();
+    }
+    void receive(const std::string& data)
+    {
+        Responder::receiveData(data.c_str(), data.size());
+    }
+
+    std::shared_ptr<const std::string> payload = std::make_shared<const std::string>("HELLO WORLD");
+};
+
+class MockNonBlockingResponder : public Responder {
+public:
+    MOCK_METHOD1(sendData, void(const std::string& data));
+    MOCK_METHOD0(disconnect, void());
+    void processRequest(Request&& request, Response&& response) override
+    {
+        response.setData(request.stdIn());
+        response.send();
+    }
+    std::size_t trySendData(const std::string& data) override
+    {
+        auto size = std::min(data.size(), writeBudget);
+        writeBudget -= size;
+        output += data.substr(0, size);
+        return size;
+    }
+    void receive(const std::string& data)
+    {
+        Responder::receiveData(data.c_str(), data.size());
+    }
+    void makeWritable(std::size_t budget)
+    {
+        writeBudget = budget;
+        Responder::onWritable();
+    }
+
+    std::size_t writeBudget = 0;
+    std::string output;
+};
+
+class MockDeferredResponder : public Responder {
+public:
+    MOCK_METHOD1(sendData, void(const std::string& data));
+    MOCK_METHOD0(disconnect, void());
+    void processRequest(Request&& request, Response&& response) override
+    {
+        response.setData(request.stdIn());
+        responses.emplace_back(std::move(response));
+    }
+    void receive(const std::string& data)
+    {
+        Responder::receiveData(data.c_str(), data.size());
+    }
+    void reset()
+    {
+        Responder::reset();
+    }
+
+    std::vector<Response> responses;
+};
+
+namespace fcgi {
+bool operator==(const FileRegion& lhs, const FileRegion& rhs)
+{
+    return lhs.fileDescriptor == rhs.fileDescriptor && lhs.offset == rhs.offset && lhs.size == rhs.size;
+}
+} //namespace fcgi
+
 namespace {
+std::string recordHeaderData(RecordType type, std::uint16_t requestId, std::uint16_t contentLength)
+{
+    auto output = std::ostringstream{};
+    auto encoder = Encoder(output);
+    encoder << hardcoded::protocolVersion << static_cast<std::uint8_t>(type) << requestId << contentLength
+            << static_cast<std::uint8_t>(0);
+    encoder.addPadding(1);
+    return output.str();
+}
+
 template<typename... Args>
 std::string messageData(Args&&... args)
 {
@@ -126,6 +245,11 @@ protected:
 
 using TestResponder = BaseTestResponder<MockResponder>;
 using TestResponderWithTestProcessor = BaseTestResponder<MockResponderWithTestProcessor>;
+using TestResponderWithFileProcessor = BaseTestResponder<MockResponderWithFileProcessor>;
+using TestResponderWithUnreadableFileProcessor = BaseTestResponder<MockResponderWithUnreadableFileProcessor>;
+using TestResponderWithSharedDataProcessor = BaseTestResponder<MockResponderWithSharedDataProcessor>;
+using TestNonBlockingResponder = BaseTestResponder<MockNonBlockingResponder>;
+using TestDeferredResponder = BaseTestResponder<MockDeferredResponder>;
 
 TEST_F(TestResponder, UnknownType)
 {
@@ -207,6 +331,77 @@ TEST_P(TestResponder, Overloaded)
     receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, 3);
 }
 
+TEST_P(TestResponder, OverloadControlLimit)
+{
+    auto overloadControl = std::make_shared<OverloadControl>(std::chrono::milliseconds{10}, 1, 1);
+    responder_.setOverloadControl(overloadControl);
+    expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::Overloaded}, 2);
+    checkConnectionState();
+
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, 1);
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, 2);
+    EXPECT_EQ(overloadControl->activeRequestsNumber(), 1);
+}
+
+TEST_F(TestResponder, OverloadControlReplacedWithActiveRequests)
+{
+    auto overloadControl = std::make_shared<OverloadControl>(std::chrono::milliseconds{10}, 1, 2);
+    responder_.setOverloadControl(overloadControl);
+    receiveMessage(MsgBeginRequest{Role::Responder, ResultConnectionState::KeepOpen}, 1);
+    receiveMessage(MsgBeginRequest{Role::Responder, ResultConnectionState::KeepOpen}, 2);
+
+    auto otherOverloadControl = std::make_shared<OverloadControl>(std::chrono::milliseconds{10}, 1, 2);
+    responder_.setOverloadControl(otherOverloadControl);
+    EXPECT_EQ(overloadControl->activeRequestsNumber(), 0);
+    EXPECT_EQ(otherOverloadControl->activeRequestsNumber(), 2);
+
+    expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::RequestComplete}, 1);
+    receiveMessage(MsgAbortRequest{}, 1);
+    EXPECT_EQ(otherOverloadControl->activeRequestsNumber(), 1);
+    EXPECT_EQ(overloadControl->activeRequestsNumber(), 0);
+}
+
+TEST_F(TestResponder, OverloadControlGetValues)
+{
+    auto overloadControl = std::make_shared<OverloadControl>(std::chrono::milliseconds{10}, 1, 5);
+    responder_.setOverloadControl(overloadControl);
+    auto resultMsg = MsgGetValuesResult{};
+    resultMsg.setRequestValue(ValueRequest::MaxReqs, "5");
+    expectMessageToBeSent(std::move(resultMsg));
+
+    auto requestMsg = MsgGetValues{};
+    requestMsg.requestValue(ValueRequest::MaxReqs);
+    receiveMessage(std::move(requestMsg));
+}
+
+TEST_P(TestResponder, ResponderGroupSettings)
+{
+    auto responderGroup = std::make_shared<ResponderGroup>();
+    responderGroup->setMaximumRequestsNumber(1);
+    responder_.setResponderGroup(responderGroup);
+    EXPECT_EQ(responder_.maximumRequestsNumber(), 1);
+    expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::Overloaded}, 2);
+    checkConnectionState();
+
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, 1);
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, 2);
+    EXPECT_EQ(responderGroup->activeRequestsNumber(), 1);
+}
+
+TEST_F(TestResponder, ResponderGroupGetValues)
+{
+    auto responderGroup = std::make_shared<ResponderGroup>(100);
+    responder_.setResponderGroup(responderGroup);
+    responderGroup->setMaximumConnectionsNumber(50);
+    auto resultMsg = MsgGetValuesResult{};
+    resultMsg.setRequestValue(ValueRequest::MaxConns, "50");
+    expectMessageToBeSent(std::move(resultMsg));
+
+    auto requestMsg = MsgGetValues{};
+    requestMsg.requestValue(ValueRequest::MaxConns);
+    receiveMessage(std::move(requestMsg));
+}
+
 namespace fcgi {
 bool operator==(const Request& lhs, const Request& rhs)
 {
@@ -237,6 +432,29 @@ TEST_P(TestResponder, Request)
     receiveMessage(MsgStdIn{}, 1);
 }
 
+TEST_P(TestResponder, RequestWithThreadLocalSerializationBuffer)
+{
+    responder_.setThreadLocalSerializationBufferEnabled(true);
+    EXPECT_TRUE(responder_.isThreadLocalSerializationBufferEnabled());
+    auto params = MsgParams{};
+    params.setParam("test", "hello world");
+    auto inStream = MsgStdIn{"HELLO WORLD"};
+
+    auto expectedRequest = makeRequest(params, inStream);
+    ::testing::InSequence seq;
+    EXPECT_CALL(responder_, doProcessRequest(expectedRequest));
+    expectMessageToBeSent(MsgStdOut{}, 1);
+    expectMessageToBeSent(MsgStdErr{}, 1);
+    expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::RequestComplete}, 1);
+    checkConnectionState();
+
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, 1);
+    receiveMessage(std::move(params), 1);
+    receiveMessage(MsgParams{}, 1);
+    receiveMessage(std::move(inStream), 1);
+    receiveMessage(MsgStdIn{}, 1);
+}
+
 TEST_P(TestResponder, ReceivingMessagesInLargeChunks)
 {
     auto streamRecordData = std::string(hardcoded::maxDataMessageSize, '0');
@@ -300,6 +518,64 @@ TEST_F(TestResponder, Multiplexing)
     receiveMessage(MsgStdIn{}, 1);
 }
 
+TEST_P(TestResponder, RequestDataSizeExceeded)
+{
+    responder_.setMaximumRequestDataSize(16);
+    ::testing::InSequence seq;
+    EXPECT_CALL(responder_, doProcessRequest(::testing::_)).Times(0);
+    expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::Overloaded}, 1);
+    checkConnectionState();
+
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, 1);
+    receiveMessage(MsgParams{}, 1);
+    receiveMessage(MsgStdIn{"HELLO WORLD"}, 1);
+    EXPECT_EQ(responder_.bufferedRequestDataSize(), 11);
+    receiveMessage(MsgStdIn{"HELLO WORLD"}, 1);
+    EXPECT_EQ(responder_.bufferedRequestDataSize(), 0);
+    receiveMessage(MsgStdIn{"HELLO WORLD"}, 1);
+    receiveMessage(MsgStdIn{}, 1);
+    EXPECT_EQ(errorInfo_, "Request data size limit exceeded, requestId = 1\n");
+}
+
+TEST_P(TestResponder, RequestParamsSizeExceeded)
+{
+    responder_.setMaximumRequestParamsSize(8);
+    ::testing::InSequence seq;
+    EXPECT_CALL(responder_, doProcessRequest(::testing::_)).Times(0);
+    expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::Overloaded}, 1);
+    checkConnectionState();
+
+    auto params = MsgParams{};
+    params.setParam("test", "hello world");
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, 1);
+    receiveMessage(std::move(params), 1);
+    receiveMessage(MsgParams{}, 1);
+    receiveMessage(MsgStdIn{}, 1);
+    EXPECT_EQ(errorInfo_, "Request data size limit exceeded, requestId = 1\n");
+}
+
+TEST_F(TestResponder, ConnectionBufferSizeExceeded)
+{
+    responder_.setMaximumConnectionBufferSize(16);
+    auto expectedRequest = Request{{}, "HELLO"};
+
+    ::testing::InSequence seq;
+    expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::Overloaded}, 2);
+    EXPECT_CALL(responder_, doProcessRequest(expectedRequest));
+    expectMessageToBeSent(MsgStdOut{}, 1);
+    expectMessageToBeSent(MsgStdErr{}, 1);
+    expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::RequestComplete}, 1);
+    EXPECT_CALL(responder_, disconnect()).Times(0);
+
+    receiveMessage(MsgBeginRequest{Role::Responder, ResultConnectionState::KeepOpen}, 1);
+    receiveMessage(MsgBeginRequest{Role::Responder, ResultConnectionState::KeepOpen}, 2);
+    receiveMessage(MsgStdIn{"HELLO"}, 1);
+    receiveMessage(MsgStdIn{"HELLO WORLD!"}, 2);
+    EXPECT_EQ(responder_.bufferedRequestDataSize(), 5);
+    receiveMessage(MsgStdIn{}, 1);
+    EXPECT_EQ(responder_.bufferedRequestDataSize(), 0);
+}
+
 TEST_P(TestResponderWithTestProcessor, Request)
 {
     auto params = MsgParams{};
@@ -322,6 +598,111 @@ TEST_P(TestResponderWithTestProcessor, Request)
     receiveMessage(MsgStdIn{}, 1);
 }
 
+TEST_P(TestResponderWithFileProcessor, Request)
+{
+    const auto fileSize = static_cast<std::size_t>(hardcoded::maxDataMessageSize) + 10;
+    const auto maxContentLength = static_cast<std::uint16_t>(hardcoded::maxDataMessageSize);
+
+    ::testing::InSequence seq;
+    EXPECT_CALL(responder_, sendData(recordHeaderData(RecordType::StdOut, 1, maxContentLength)));
+    EXPECT_CALL(responder_, sendFileData(FileRegion{3, 100, hardcoded::maxDataMessageSize}));
+    EXPECT_CALL(responder_, sendData(recordHeaderData(RecordType::StdOut, 1, 10)));
+    EXPECT_CALL(responder_, sendFileData(FileRegion{3, 100 + hardcoded::maxDataMessageSize, 10}));
+    expectMessageToBeSent(MsgStdOut{}, 1);
+    expectMessageToBeSent(MsgStdErr{}, 1);
+    expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::RequestComplete}, 1);
+    checkConnectionState();
+
+    auto fileSizeStr = std::to_string(fileSize);
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, 1);
+    receiveMessage(MsgParams{}, 1);
+    receiveMessage(MsgStdIn{fileSizeStr}, 1);
+    receiveMessage(MsgStdIn{}, 1);
+}
+
+TEST_P(TestResponderWithUnreadableFileProcessor, FileReadError)
+{
+    // the rest of the response isn't sent to the closed connection
+    ::testing::InSequence seq;
+    EXPECT_CALL(
+            responder_,
+            sendData(recordHeaderData(RecordType::StdOut, 1, static_cast<std::uint16_t>(hardcoded::maxDataMessageSize))));
+    EXPECT_CALL(responder_, disconnect());
+
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, 1);
+    receiveMessage(MsgParams{}, 1);
+    receiveMessage(MsgStdIn{}, 1);
+    // the output queue is cleared by the failed read while it's being flushed
+    EXPECT_EQ(responder_.outputQueueSize(), 0);
+    EXPECT_FALSE(responder_.isOutputQueueFull());
+    EXPECT_EQ(errorInfo_.find("Can't read response data from file descriptor -1"), 0);
+}
+
+TEST_P(TestResponderWithSharedDataProcessor, Request)
+{
+    ::testing::InSequence seq;
+    expectMessageToBeSent(MsgStdOut{"HELLO WORLD"}, 1);
+    expectMessageToBeSent(MsgStdOut{}, 1);
+    expectMessageToBeSent(MsgStdErr{}, 1);
+    expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::RequestComplete}, 1);
+    checkConnectionState();
+
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, 1);
+    receiveMessage(MsgParams{}, 1);
+    receiveMessage(MsgStdIn{}, 1);
+    EXPECT_EQ(responder_.payload.use_count(), 1);
+}
+
+TEST_P(TestNonBlockingResponder, Request)
+{
+    const auto requestId = std::uint16_t{1};
+    EXPECT_CALL(responder_, sendData(::testing::_)).Times(0);
+    auto expectedOutput = messageData(MsgStdOut{"HELLO WORLD"}, requestId) + messageData(MsgStdOut{}, requestId) +
+            messageData(MsgStdErr{}, requestId) +
+            messageData(MsgEndRequest{0, ProtocolStatus::RequestComplete}, requestId);
+
+    responder_.writeBudget = 10;
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, 1);
+    receiveMessage(MsgParams{}, 1);
+    receiveMessage(MsgStdIn{"HELLO WORLD"}, 1);
+    receiveMessage(MsgStdIn{}, 1);
+    EXPECT_EQ(responder_.output, expectedOutput.substr(0, 10));
+    EXPECT_EQ(responder_.outputQueueSize(), expectedOutput.size() - 10);
+    ::testing::Mock::VerifyAndClearExpectations(&responder_);
+
+    responder_.makeWritable(15);
+    EXPECT_EQ(responder_.output, expectedOutput.substr(0, 25));
+    EXPECT_EQ(responder_.outputQueueSize(), expectedOutput.size() - 25);
+    ::testing::Mock::VerifyAndClearExpectations(&responder_);
+
+    checkConnectionState();
+    responder_.makeWritable(expectedOutput.size());
+    EXPECT_EQ(responder_.output, expectedOutput);
+    EXPECT_EQ(responder_.outputQueueSize(), 0);
+}
+
+TEST_P(TestNonBlockingResponder, OutputQueueOverloaded)
+{
+    const auto requestId = std::uint16_t{1};
+    const auto secondRequestId = std::uint16_t{2};
+    responder_.setOutputHighWaterMark(8);
+    receiveMessage(MsgBeginRequest{Role::Responder, ResultConnectionState::KeepOpen}, 1);
+    receiveMessage(MsgParams{}, 1);
+    receiveMessage(MsgStdIn{"HELLO WORLD"}, 1);
+    receiveMessage(MsgStdIn{}, 1);
+    EXPECT_TRUE(responder_.isOutputQueueFull());
+
+    checkConnectionState();
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, 2);
+    responder_.makeWritable(std::numeric_limits<std::size_t>::max());
+    EXPECT_FALSE(responder_.isOutputQueueFull());
+    auto expectedOutput = messageData(MsgStdOut{"HELLO WORLD"}, requestId) + messageData(MsgStdOut{}, requestId) +
+            messageData(MsgStdErr{}, requestId) +
+            messageData(MsgEndRequest{0, ProtocolStatus::RequestComplete}, requestId) +
+            messageData(MsgEndRequest{0, ProtocolStatus::Overloaded}, secondRequestId);
+    EXPECT_EQ(responder_.output, expectedOutput);
+}
+
 TEST_F(TestResponder, UnexpectedRecord)
 {
     expectNoMessagesToBeSent();
@@ -329,6 +710,23 @@ TEST_F(TestResponder, UnexpectedRecord)
     EXPECT_EQ(errorInfo_, "Received unexpected record, RecordType = 2, requestId = 1\n");
 }
 
+TEST_F(TestResponder, UnexpectedRecordErrorEvent)
+{
+    auto events = std::vector<ErrorEvent>{};
+    responder_.setErrorEventHandler(
+            [&events](const ErrorEvent& event)
+            {
+                events.push_back(event);
+            });
+    expectNoMessagesToBeSent();
+    receiveMessage(MsgAbortRequest{}, 1);
+    ASSERT_EQ(events.size(), 1);
+    EXPECT_EQ(events[0].code, ErrorCode::UnexpectedRecord);
+    EXPECT_EQ(events[0].requestId, 1);
+    EXPECT_EQ(events[0].recordType, static_cast<std::uint8_t>(RecordType::AbortRequest));
+    EXPECT_EQ(errorInfo_, "Received unexpected record, RecordType = 2, requestId = 1\n");
+}
+
 TEST_P(TestResponder, RecordReadError)
 {
     expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::RequestComplete}, 1);
@@ -371,5 +769,253 @@ TEST_P(TestResponder, RecordReadErrorMisalignedNameValue)
             "Record message read error: Misaligned name-value\nProtocol version \"83\" isn't supported.\n");
 }
 
+TEST_P(TestDeferredResponder, Reset)
+{
+    const auto requestId = std::uint16_t{1};
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, requestId);
+    receiveMessage(MsgParams{}, requestId);
+    receiveMessage(MsgStdIn{"STALE"}, requestId);
+    receiveMessage(MsgStdIn{}, requestId);
+    ASSERT_EQ(responder_.responses.size(), 1u);
+
+    // a partially received record of the previous connection is discarded too
+    receiveData(messageData(MsgBeginRequest{Role::Responder, resultConnectionState()}, requestId).substr(0, 5));
+    responder_.reset();
+
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, requestId);
+    receiveMessage(MsgParams{}, requestId);
+    receiveMessage(MsgStdIn{"HELLO"}, requestId);
+    receiveMessage(MsgStdIn{}, requestId);
+    ASSERT_EQ(responder_.responses.size(), 2u);
+
+    ::testing::InSequence seq;
+    expectMessageToBeSent(MsgStdOut{"HELLO"}, requestId);
+    expectMessageToBeSent(MsgStdOut{}, requestId);
+    expectMessageToBeSent(MsgStdErr{}, requestId);
+    expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::RequestComplete}, requestId);
+    checkConnectionState();
+    responder_.responses[0].send();
+    responder_.responses[1].send();
+    EXPECT_TRUE(errorInfo_.empty());
+}
+
+TEST_P(TestDeferredResponder, AbortCancelsResponse)
+{
+    const auto requestId = std::uint16_t{1};
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, requestId);
+    receiveMessage(MsgParams{}, requestId);
+    receiveMessage(MsgStdIn{"HELLO"}, requestId);
+    receiveMessage(MsgStdIn{}, requestId);
+    ASSERT_EQ(responder_.responses.size(), 1u);
+    auto& response = responder_.responses[0];
+    auto cancellationsNumber = 0;
+    response.setCancellationHandler(
+            [&cancellationsNumber]
+            {
+                ++cancellationsNumber;
+            });
+    EXPECT_FALSE(response.isCancelled());
+
+    expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::RequestComplete}, requestId);
+    checkConnectionState();
+    receiveMessage(MsgAbortRequest{}, requestId);
+    EXPECT_EQ(cancellationsNumber, 1);
+    EXPECT_TRUE(response.isCancelled());
+    EXPECT_FALSE(response.isValid());
+
+    // the handler set after the cancellation is called right away
+    response.setCancellationHandler(
+            [&cancellationsNumber]
+            {
+                ++cancellationsNumber;
+            });
+    EXPECT_EQ(cancellationsNumber, 2);
+
+    response.send();
+    EXPECT_TRUE(errorInfo_.empty());
+}
+
+TEST_P(TestDeferredResponder, ResetCancelsResponses)
+{
+    EXPECT_CALL(responder_, sendData(::testing::_)).Times(0);
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, 1);
+    receiveMessage(MsgParams{}, 1);
+    receiveMessage(MsgStdIn{}, 1);
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, 2);
+    receiveMessage(MsgParams{}, 2);
+    receiveMessage(MsgStdIn{}, 2);
+    ASSERT_EQ(responder_.responses.size(), 2u);
+    auto cancellationsNumber = 0;
+    for (auto& response : responder_.responses)
+        response.setCancellationHandler(
+                [&cancellationsNumber]
+                {
+                    ++cancellationsNumber;
+                });
+
+    responder_.reset();
+    EXPECT_EQ(cancellationsNumber, 2);
+    EXPECT_TRUE(responder_.responses[0].isCancelled());
+    EXPECT_TRUE(responder_.responses[1].isCancelled());
+}
+
+TEST_P(TestDeferredResponder, RequestProcessingTimeout)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    auto timerWheel = std::make_shared<TimerWheel>(std::chrono::milliseconds{1}, startTime);
+    responder_.setTimerWheel(timerWheel);
+    responder_.setRequestProcessingTimeout(std::chrono::milliseconds{100});
+    EXPECT_EQ(responder_.requestProcessingTimeout(), std::chrono::milliseconds{100});
+
+    const auto requestId = std::uint16_t{1};
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, requestId);
+    receiveMessage(MsgParams{}, requestId);
+    receiveMessage(MsgStdIn{"HELLO"}, requestId);
+    receiveMessage(MsgStdIn{}, requestId);
+    ASSERT_EQ(responder_.responses.size(), 1u);
+    timerWheel->tick(startTime + std::chrono::milliseconds{99});
+    EXPECT_FALSE(responder_.responses[0].isCancelled());
+
+    expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::RequestComplete}, requestId);
+    checkConnectionState();
+    timerWheel->tick(startTime + std::chrono::milliseconds{100});
+    EXPECT_TRUE(responder_.responses[0].isCancelled());
+    EXPECT_EQ(errorInfo_, "Request timeout, requestId = 1\n");
+    responder_.responses[0].send();
+}
+
+TEST_P(TestResponder, RequestReceiveTimeout)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    auto timerWheel = std::make_shared<TimerWheel>(std::chrono::milliseconds{1}, startTime);
+    responder_.setTimerWheel(timerWheel);
+    responder_.setRequestReceiveTimeout(std::chrono::milliseconds{100});
+    ::testing::InSequence seq;
+    EXPECT_CALL(responder_, doProcessRequest(::testing::_)).Times(0);
+    expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::RequestComplete}, 1);
+    checkConnectionState();
+
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, 1);
+    receiveMessage(MsgParams{}, 1);
+    receiveMessage(MsgStdIn{"HELLO"}, 1);
+    timerWheel->tick(startTime + std::chrono::milliseconds{100});
+    // the rest of the request data is discarded
+    receiveMessage(MsgStdIn{"WORLD"}, 1);
+    receiveMessage(MsgStdIn{}, 1);
+    EXPECT_EQ(errorInfo_, "Request timeout, requestId = 1\n");
+}
+
+TEST_F(TestResponder, IdleConnectionTimeout)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    auto timerWheel = std::make_shared<TimerWheel>(std::chrono::milliseconds{1}, startTime);
+    responder_.setTimerWheel(timerWheel);
+    responder_.setIdleConnectionTimeout(std::chrono::milliseconds{100});
+    EXPECT_CALL(responder_, sendData(::testing::_)).Times(::testing::AnyNumber());
+    EXPECT_CALL(responder_, doProcessRequest(::testing::_));
+
+    // the timer is restarted after the request is ended
+    timerWheel->tick(startTime + std::chrono::milliseconds{50});
+    receiveMessage(MsgBeginRequest{Role::Responder, ResultConnectionState::KeepOpen}, 1);
+    timerWheel->tick(startTime + std::chrono::milliseconds{120});
+    receiveMessage(MsgParams{}, 1);
+    receiveMessage(MsgStdIn{}, 1);
+    ::testing::Mock::VerifyAndClearExpectations(&responder_);
+
+    EXPECT_CALL(responder_, disconnect()).Times(0);
+    timerWheel->tick(startTime + std::chrono::milliseconds{219});
+    ::testing::Mock::VerifyAndClearExpectations(&responder_);
+    EXPECT_CALL(responder_, disconnect());
+    timerWheel->tick(startTime + std::chrono::milliseconds{220});
+    EXPECT_TRUE(errorInfo_.empty());
+}
+
+#ifdef FCGI_RESPONDER_REQUEST_TIMING
+TEST_P(TestDeferredResponder, RequestTiming)
+{
+    const auto requestId = std::uint16_t{1};
+    auto timings = std::vector<RequestTiming>{};
+    responder_.setRequestTimingHandler(
+            [&timings](const RequestTiming& timing)
+            {
+                timings.push_back(timing);
+            });
+    EXPECT_CALL(responder_, sendData(::testing::_)).Times(::testing::AnyNumber());
+    checkConnectionState();
+
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, requestId);
+    receiveMessage(MsgParams{}, requestId);
+    receiveMessage(MsgStdIn{"HELLO"}, requestId);
+    receiveMessage(MsgStdIn{}, requestId);
+    ASSERT_EQ(responder_.responses.size(), 1u);
+    EXPECT_TRUE(timings.empty());
+
+    responder_.responses[0].send();
+    ASSERT_EQ(timings.size(), 1u);
+    const auto& timing = timings[0];
+    EXPECT_EQ(timing.requestId, requestId);
+    EXPECT_NE(timing.beginRequestReceived, RequestTiming::TimePoint{});
+    EXPECT_LE(timing.beginRequestReceived, timing.paramsReceived);
+    EXPECT_LE(timing.paramsReceived, timing.stdInReceived);
+    EXPECT_LE(timing.stdInReceived, timing.processingStarted);
+    EXPECT_LE(timing.processingStarted, timing.responseSent);
+    EXPECT_LE(timing.responseSent, timing.outputWritten);
+}
+
+TEST_P(TestNonBlockingResponder, RequestTimingAfterOutputIsWritten)
+{
+    const auto requestId = std::uint16_t{1};
+    auto timings = std::vector<RequestTiming>{};
+    responder_.setRequestTimingHandler(
+            [&timings](const RequestTiming& timing)
+            {
+                timings.push_back(timing);
+            });
+    checkConnectionState();
+
+    responder_.writeBudget = 10;
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, requestId);
+    receiveMessage(MsgParams{}, requestId);
+    receiveMessage(MsgStdIn{"HELLO WORLD"}, requestId);
+    receiveMessage(MsgStdIn{}, requestId);
+    EXPECT_TRUE(timings.empty());
+
+    responder_.makeWritable(15);
+    EXPECT_TRUE(timings.empty());
+
+    responder_.makeWritable(std::numeric_limits<std::size_t>::max());
+    ASSERT_EQ(timings.size(), 1u);
+    EXPECT_EQ(timings[0].requestId, requestId);
+    EXPECT_LE(timings[0].responseSent, timings[0].outputWritten);
+}
+
+TEST_P(TestResponder, AbortedRequestTimingIsNotReported)
+{
+    auto timingsNumber = 0;
+    responder_.setRequestTimingHandler(
+            [&timingsNumber](const RequestTiming&)
+            {
+                ++timingsNumber;
+            });
+    expectMessageToBeSent(MsgEndRequest{0, ProtocolStatus::RequestComplete}, 1);
+    checkConnectionState();
+
+    receiveMessage(MsgBeginRequest{Role::Responder, resultConnectionState()}, 1);
+    receiveMessage(RecordType::AbortRequest, 1);
+    EXPECT_EQ(timingsNumber, 0);
+}
+#endif
+
 INSTANTIATE_TEST_SUITE_P(WithConnectionStateCheck, TestResponder, ::testing::Values(false, true));
 INSTANTIATE_TEST_SUITE_P(WithConnectionStateCheck, TestResponderWithTestProcessor, ::testing::Values(false, true));
+INSTANTIATE_TEST_SUITE_P(WithConnectionStateCheck, TestResponderWithFileProcessor, ::testing::Values(false, true));
+INSTANTIATE_TEST_SUITE_P(
+        WithConnectionStateCheck,
+        TestResponderWithSharedDataProcessor,
+        ::testing::Values(false, true));
+INSTANTIATE_TEST_SUITE_P(
+        WithConnectionStateCheck,
+        TestResponderWithUnreadableFileProcessor,
+        ::testing::Values(false, true));
+INSTANTIATE_TEST_SUITE_P(WithConnectionStateCheck, TestNonBlockingResponder, ::testing::Values(false, true));
+INSTANTIATE_TEST_SUITE_P(WithConnectionStateCheck, TestDeferredResponder, ::testing::Values(false, true));
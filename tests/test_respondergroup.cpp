@@ -0,0 +1,32 @@
+#include <fcgi_responder/respondergroup.h>
+#include <gtest/gtest.h>
+
+TEST(ResponderGroup, ConnectionsLimit)
+{
+    auto responderGroup = fcgi::ResponderGroup{2};
+    EXPECT_TRUE(responderGroup.tryAcquireConnection());
+    EXPECT_TRUE(responderGroup.tryAcquireConnection());
+    EXPECT_FALSE(responderGroup.tryAcquireConnection());
+    EXPECT_EQ(responderGroup.connectionsNumber(), 2);
+    EXPECT_EQ(responderGroup.rejectedConnectionsNumber(), 1u);
+
+    responderGroup.releaseConnection();
+    EXPECT_EQ(responderGroup.connectionsNumber(), 1);
+    EXPECT_TRUE(responderGroup.tryAcquireConnection());
+}
+
+TEST(ResponderGroup, ReducedConnectionsLimit)
+{
+    auto responderGroup = fcgi::ResponderGroup{};
+    EXPECT_TRUE(responderGroup.tryAcquireConnection());
+    EXPECT_TRUE(responderGroup.tryAcquireConnection());
+
+    responderGroup.setMaximumConnectionsNumber(1);
+    EXPECT_EQ(responderGroup.connectionsNumber(), 2);
+    EXPECT_FALSE(responderGroup.tryAcquireConnection());
+
+    responderGroup.releaseConnection();
+    EXPECT_FALSE(responderGroup.tryAcquireConnection());
+    responderGroup.releaseConnection();
+    EXPECT_TRUE(responderGroup.tryAcquireConnection());
+}
@@ -0,0 +1,411 @@
+#include <msgbeginrequest.h>
+#include <msgparams.h>
+#include <record.h>
+#include <streamdatamessage.h>
+#include <fcgi_responder/metrics.h>
+#include <fcgi_responder/respondergroup.h>
+#include <fcgi_responder/server.h>
+#ifdef FCGI_RESPONDER_SERVER_IO_URING
+#include <fcgi_responder/uringserver.h>
+#endif
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+using namespace fcgi;
+
+namespace {
+constexpr auto largeResponseSize = std::size_t{4 * 1024 * 1024};
+constexpr auto outputHighWaterMark = std::size_t{64 * 1024};
+
+template<typename TMsg>
+std::string messageData(TMsg&& msg, std::uint16_t requestId)
+{
+    auto record = fcgi::Record{std::forward<TMsg>(msg), requestId};
+    auto recordStream = std::ostringstream{};
+    record.toStream(recordStream);
+    return recordStream.str();
+}
+
+/// The processor responds with the request's stdIn, extended to RESPONSE_SIZE bytes when the parameter is set.
+std::string requestData(std::uint16_t requestId, const std::string& stdIn, std::size_t responseSize = 0)
+{
+    auto params = MsgParams{};
+    params.setParam("REQUEST_METHOD", "GET");
+    if (responseSize)
+        params.setParam("RESPONSE_SIZE", std::to_string(responseSize));
+    auto result = messageData(MsgBeginRequest{Role::Responder, ResultConnectionState::KeepOpen}, requestId);
+    result += messageData(std::move(params), requestId);
+    result += messageData(MsgParams{}, requestId);
+    result += messageData(MsgStdIn{stdIn}, requestId);
+    result += messageData(MsgStdIn{}, requestId);
+    return result;
+}
+
+std::string responseData(const std::string& stdIn, std::size_t responseSize = 0)
+{
+    auto result = stdIn;
+    if (responseSize)
+        result.resize(responseSize, '.');
+    return result;
+}
+
+template<typename TPredicate>
+bool waitUntil(TPredicate predicate)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    return true;
+}
+
+std::uint16_t freeTcpPort()
+{
+    auto socket = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    auto address = sockaddr_in{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    auto addressLength = socklen_t{sizeof(address)};
+    ::bind(socket, reinterpret_cast<const sockaddr*>(&address), addressLength);
+    getsockname(socket, reinterpret_cast<sockaddr*>(&address), &addressLength);
+    ::close(socket);
+    return ntohs(address.sin_port);
+}
+
+/// Blocking FastCGI web server side of a connection, it collects the StdOut streams of the responses
+class Client {
+public:
+    explicit Client(const std::string& socketPath)
+        : socket_{::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)}
+    {
+        auto address = sockaddr_un{};
+        address.sun_family = AF_UNIX;
+        std::copy(socketPath.begin(), socketPath.end(), address.sun_path);
+        connect(reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    }
+    /// Connects to the TCP port on the loopback interface
+    explicit Client(std::uint16_t port)
+        : socket_{::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)}
+    {
+        auto address = sockaddr_in{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        connect(reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    }
+    ~Client()
+    {
+        close();
+    }
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    void send(const std::string& data)
+    {
+        auto sentSize = std::size_t{};
+        while (sentSize < data.size()) {
+            auto size = ::send(socket_, data.data() + sentSize, data.size() - sentSize, MSG_NOSIGNAL);
+            if (size < 0 && errno == EINTR)
+                continue;
+            if (size < 0)
+                throw std::system_error{errno, std::generic_category(), "send"};
+            sentSize += static_cast<std::size_t>(size);
+        }
+    }
+
+    /// Returns the StdOut stream of the request, or nothing if the connection is closed before the request ends
+    std::optional<std::string> readResponse(std::uint16_t requestId)
+    {
+        while (!endedRequests_.count(requestId))
+            if (!readRecords())
+                return std::nullopt;
+        endedRequests_.erase(requestId);
+        return std::move(responses_[requestId]);
+    }
+
+    bool isClosedByServer()
+    {
+        auto data = char{};
+        auto size = ::recv(socket_, &data, 1, 0);
+        while (size < 0 && errno == EINTR)
+            size = ::recv(socket_, &data, 1, 0);
+        return size == 0 || (size < 0 && errno == ECONNRESET);
+    }
+
+    void close()
+    {
+        if (socket_ >= 0)
+            ::close(socket_);
+        socket_ = -1;
+    }
+
+private:
+    void connect(const sockaddr* address, socklen_t addressLength)
+    {
+        // reading is limited in time, so a missing response fails the test instead of blocking it
+        auto timeout = timeval{};
+        timeout.tv_sec = 5;
+        setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        if (::connect(socket_, address, addressLength) < 0)
+            throw std::system_error{errno, std::generic_category(), "connect"};
+    }
+
+    bool readRecords()
+    {
+        constexpr auto headerSize = std::size_t{8};
+        auto data = std::array<char, 65536>{};
+        auto size = ::recv(socket_, data.data(), data.size(), 0);
+        if (size < 0 && errno == EINTR)
+            return true;
+        if (size <= 0)
+            return false;
+        buffer_.append(data.data(), static_cast<std::size_t>(size));
+
+        while (buffer_.size() >= headerSize) {
+            const auto byte = [this](std::size_t index)
+            {
+                return static_cast<std::size_t>(static_cast<unsigned char>(buffer_[index]));
+            };
+            const auto type = static_cast<RecordType>(byte(1));
+            const auto requestId = static_cast<std::uint16_t>((byte(2) << 8) | byte(3));
+            const auto contentLength = (byte(4) << 8) | byte(5);
+            const auto recordSize = headerSize + contentLength + byte(6);
+            if (buffer_.size() < recordSize)
+                return true;
+            if (type == RecordType::StdOut)
+                responses_[requestId].append(buffer_, headerSize, contentLength);
+            else if (type == RecordType::EndRequest)
+                endedRequests_.insert(requestId);
+            buffer_.erase(0, recordSize);
+        }
+        return true;
+    }
+
+private:
+    int socket_;
+    std::string buffer_;
+    std::unordered_map<std::uint16_t, std::string> responses_;
+    std::set<std::uint16_t> endedRequests_;
+};
+
+} //namespace
+
+template<typename TServer>
+class TestServer : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        try {
+            server_ = std::make_unique<TServer>(
+                    [](Request&& request, Response&& response)
+                    {
+                        const auto responseSize =
+                                request.hasParam("RESPONSE_SIZE") ? std::stoul(request.param("RESPONSE_SIZE")) : 0;
+                        response.setData(responseData(request.stdIn(), responseSize));
+                        response.send();
+                    });
+        }
+        catch (const std::system_error& error) {
+            GTEST_SKIP() << "Server engine isn't supported: " << error.what();
+        }
+        responderGroup_->setMetrics(metrics_);
+        server_->setResponderGroup(responderGroup_);
+        server_->listen(socketPath_);
+    }
+
+    void TearDown() override
+    {
+        if (!thread_.joinable())
+            return;
+        server_->stop();
+        thread_.join();
+    }
+
+    void startServer()
+    {
+        thread_ = std::thread{[this]
+                              {
+                                  server_->run();
+                              }};
+    }
+
+    std::size_t bufferedBytes() const
+    {
+        return metrics_->snapshot().bufferedBytes;
+    }
+
+    const std::string socketPath_ = ::testing::TempDir() + "test_fcgi_responder_server.sock";
+    std::shared_ptr<Metrics> metrics_ = std::make_shared<Metrics>();
+    std::shared_ptr<ResponderGroup> responderGroup_ = std::make_shared<ResponderGroup>();
+    std::unique_ptr<TServer> server_;
+    std::thread thread_;
+};
+
+#ifdef FCGI_RESPONDER_SERVER_IO_URING
+// UringServer tests are skipped when the kernel doesn't support io_uring or its provided buffer rings
+using ServerEngines = ::testing::Types<Server, UringServer>;
+#else
+using ServerEngines = ::testing::Types<Server>;
+#endif
+TYPED_TEST_SUITE(TestServer, ServerEngines);
+
+TYPED_TEST(TestServer, Request)
+{
+    this->startServer();
+    auto client = Client{this->socketPath_};
+    client.send(requestData(1, "Hello world"));
+    EXPECT_EQ(client.readResponse(1), responseData("Hello world"));
+    client.send(requestData(2, "Bye"));
+    EXPECT_EQ(client.readResponse(2), responseData("Bye"));
+    EXPECT_EQ(this->server_->connectionsNumber(), 1u);
+
+    client.close();
+    EXPECT_TRUE(waitUntil(
+            [&]
+            {
+                return this->server_->connectionsNumber() == 0;
+            }));
+}
+
+TYPED_TEST(TestServer, OutputQueueBackpressure)
+{
+    this->responderGroup_->setOutputHighWaterMark(outputHighWaterMark);
+    this->startServer();
+    auto client = Client{this->socketPath_};
+    client.send(requestData(1, "Hello", largeResponseSize));
+    // the response doesn't fit into the socket's buffer, so its remaining part waits in the output queue,
+    // which pauses reading the next request until the queue is sent
+    ASSERT_TRUE(waitUntil(
+            [&]
+            {
+                return this->bufferedBytes() > outputHighWaterMark;
+            }));
+    client.send(requestData(2, "World"));
+
+    EXPECT_EQ(client.readResponse(1), responseData("Hello", largeResponseSize));
+    EXPECT_EQ(client.readResponse(2), responseData("World"));
+    EXPECT_TRUE(waitUntil(
+            [&]
+            {
+                return this->bufferedBytes() == 0;
+            }));
+}
+
+TYPED_TEST(TestServer, DisconnectWithQueuedOutput)
+{
+    this->responderGroup_->setOutputHighWaterMark(outputHighWaterMark);
+    this->startServer();
+    {
+        auto client = Client{this->socketPath_};
+        client.send(requestData(1, "Hello", largeResponseSize));
+        ASSERT_TRUE(waitUntil(
+                [&]
+                {
+                    return this->bufferedBytes() > 0;
+                }));
+    }
+    EXPECT_TRUE(waitUntil(
+            [&]
+            {
+                return this->server_->connectionsNumber() == 0 && this->metrics_->snapshot().connections == 0;
+            }));
+    EXPECT_EQ(this->bufferedBytes(), 0u);
+
+    // the closed connection is reused for the next one
+    auto client = Client{this->socketPath_};
+    client.send(requestData(1, "Hello"));
+    EXPECT_EQ(client.readResponse(1), responseData("Hello"));
+}
+
+TYPED_TEST(TestServer, ConnectionsLimit)
+{
+    this->responderGroup_->setMaximumConnectionsNumber(1);
+    this->startServer();
+    auto client = std::make_unique<Client>(this->socketPath_);
+    client->send(requestData(1, "Hello"));
+    EXPECT_EQ(client->readResponse(1), responseData("Hello"));
+
+    auto rejectedClient = Client{this->socketPath_};
+    EXPECT_TRUE(rejectedClient.isClosedByServer());
+    EXPECT_EQ(this->responderGroup_->rejectedConnectionsNumber(), 1u);
+    EXPECT_EQ(this->server_->connectionsNumber(), 1u);
+
+    client.reset();
+    ASSERT_TRUE(waitUntil(
+            [&]
+            {
+                return this->responderGroup_->connectionsNumber() == 0;
+            }));
+    auto nextClient = Client{this->socketPath_};
+    nextClient.send(requestData(1, "World"));
+    EXPECT_EQ(nextClient.readResponse(1), responseData("World"));
+}
+
+TEST(Server, MultipleEventLoops)
+{
+    auto threadIdsMutex = std::mutex{};
+    auto threadIds = std::set<std::thread::id>{};
+    auto server = Server{[&](Request&& request, Response&& response)
+                         {
+                             {
+                                 auto lock = std::scoped_lock{threadIdsMutex};
+                                 threadIds.insert(std::this_thread::get_id());
+                             }
+                             response.setData(responseData(request.stdIn()));
+                             response.send();
+                         }};
+    server.setThreadsNumber(2);
+    const auto port = freeTcpPort();
+    server.listen("127.0.0.1", port);
+    auto thread = std::thread{[&]
+                              {
+                                  server.run();
+                              }};
+
+    // each loop listens on its own socket bound with SO_REUSEPORT, and the kernel distributes
+    // the connections between them by the client's address, so both loops serve a part of them
+    constexpr auto clientsNumber = 32;
+    auto clients = std::vector<std::unique_ptr<Client>>{};
+    for (auto i = 0; i < clientsNumber; ++i) {
+        clients.emplace_back(std::make_unique<Client>(port));
+        clients.back()->send(requestData(1, "Hello " + std::to_string(i)));
+    }
+    for (auto i = 0; i < clientsNumber; ++i)
+        EXPECT_EQ(clients[i]->readResponse(1), responseData("Hello " + std::to_string(i)));
+    EXPECT_EQ(server.connectionsNumber(), static_cast<std::size_t>(clientsNumber));
+    {
+        auto lock = std::scoped_lock{threadIdsMutex};
+        EXPECT_EQ(threadIds.size(), 2u);
+    }
+
+    clients.clear();
+    EXPECT_TRUE(waitUntil(
+            [&]
+            {
+                return server.connectionsNumber() == 0;
+            }));
+    server.stop();
+    thread.join();
+}
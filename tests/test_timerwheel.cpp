@@ -0,0 +1,172 @@
+#include <fcgi_responder/timerwheel.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+using namespace fcgi;
+using namespace std::chrono_literals;
+
+namespace {
+const auto startTime = std::chrono::steady_clock::time_point{} + 1h;
+} //namespace
+
+TEST(TimerWheel, Expiration)
+{
+    auto wheel = TimerWheel{1ms, startTime};
+    auto expirationsNumber = 0;
+    auto timer = TimerWheel::Timer{[&expirationsNumber]
+                                   {
+                                       ++expirationsNumber;
+                                   }};
+    wheel.arm(timer, 100ms);
+    EXPECT_TRUE(timer.isArmed());
+    EXPECT_EQ(wheel.armedTimersNumber(), 1u);
+
+    wheel.tick(startTime + 99ms);
+    EXPECT_EQ(expirationsNumber, 0);
+    wheel.tick(startTime + 100ms);
+    EXPECT_EQ(expirationsNumber, 1);
+    EXPECT_FALSE(timer.isArmed());
+    EXPECT_EQ(wheel.armedTimersNumber(), 0u);
+    wheel.tick(startTime + 1s);
+    EXPECT_EQ(expirationsNumber, 1);
+}
+
+TEST(TimerWheel, TimeoutIsRoundedUpToResolution)
+{
+    auto wheel = TimerWheel{10ms, startTime};
+    auto isExpired = false;
+    auto timer = TimerWheel::Timer{[&isExpired]
+                                   {
+                                       isExpired = true;
+                                   }};
+    wheel.arm(timer, 15ms);
+    wheel.tick(startTime + 19ms);
+    EXPECT_FALSE(isExpired);
+    wheel.tick(startTime + 20ms);
+    EXPECT_TRUE(isExpired);
+}
+
+TEST(TimerWheel, CancelAndRearm)
+{
+    auto wheel = TimerWheel{1ms, startTime};
+    auto expirationsNumber = 0;
+    auto timer = TimerWheel::Timer{[&expirationsNumber]
+                                   {
+                                       ++expirationsNumber;
+                                   }};
+    wheel.arm(timer, 10ms);
+    timer.cancel();
+    EXPECT_FALSE(timer.isArmed());
+    EXPECT_EQ(wheel.armedTimersNumber(), 0u);
+    wheel.tick(startTime + 20ms);
+    EXPECT_EQ(expirationsNumber, 0);
+
+    wheel.arm(timer, 10ms);
+    wheel.tick(startTime + 25ms);
+    wheel.arm(timer, 10ms);
+    wheel.tick(startTime + 30ms);
+    EXPECT_EQ(expirationsNumber, 0);
+    wheel.tick(startTime + 35ms);
+    EXPECT_EQ(expirationsNumber, 1);
+}
+
+TEST(TimerWheel, LongTimeoutsAreCascaded)
+{
+    auto wheel = TimerWheel{1ms, startTime};
+    auto expirationTimes = std::vector<std::chrono::milliseconds>{};
+    auto currentTime = 0ms;
+    auto timers = std::vector<TimerWheel::Timer>{};
+    const auto timeouts = std::vector<std::chrono::milliseconds>{70000ms, 300ms, 256ms, 65536ms, 257ms, 1ms};
+    for (auto timeout : timeouts)
+        timers.emplace_back(
+                [&expirationTimes, &currentTime]
+                {
+                    expirationTimes.push_back(currentTime);
+                });
+    for (auto i = std::size_t{}; i < timeouts.size(); ++i)
+        wheel.arm(timers[i], timeouts[i]);
+
+    for (currentTime = 1ms; currentTime <= 70000ms; ++currentTime)
+        wheel.tick(startTime + currentTime);
+    EXPECT_EQ(
+            expirationTimes,
+            (std::vector<std::chrono::milliseconds>{1ms, 256ms, 257ms, 300ms, 65536ms, 70000ms}));
+}
+
+TEST(TimerWheel, HandlerCanDestroyAndArmTimers)
+{
+    auto wheel = TimerWheel{1ms, startTime};
+    auto expirationsNumber = 0;
+    auto destroyedTimer = std::make_unique<TimerWheel::Timer>();
+    auto cancelledTimer = TimerWheel::Timer{[&expirationsNumber]
+                                            {
+                                                ++expirationsNumber;
+                                            }};
+    auto rearmedTimer = TimerWheel::Timer{};
+    destroyedTimer->setHandler(
+            [&]
+            {
+                ++expirationsNumber;
+                destroyedTimer.reset();
+                cancelledTimer.cancel();
+                wheel.arm(rearmedTimer, 1ms);
+            });
+    rearmedTimer.setHandler(
+            [&expirationsNumber]
+            {
+                ++expirationsNumber;
+            });
+    wheel.arm(*destroyedTimer, 5ms);
+    wheel.arm(cancelledTimer, 5ms);
+
+    wheel.tick(startTime + 5ms);
+    EXPECT_EQ(expirationsNumber, 1);
+    EXPECT_EQ(wheel.armedTimersNumber(), 1u);
+    wheel.tick(startTime + 6ms);
+    EXPECT_EQ(expirationsNumber, 2);
+}
+
+TEST(TimerWheel, MovedTimerStaysArmed)
+{
+    auto wheel = TimerWheel{1ms, startTime};
+    auto isExpired = false;
+    auto timer = TimerWheel::Timer{[&isExpired]
+                                   {
+                                       isExpired = true;
+                                   }};
+    wheel.arm(timer, 10ms);
+    auto movedTimer = std::move(timer);
+    EXPECT_TRUE(movedTimer.isArmed());
+    EXPECT_EQ(wheel.armedTimersNumber(), 1u);
+    wheel.tick(startTime + 10ms);
+    EXPECT_TRUE(isExpired);
+}
+
+TEST(TimerWheel, IdlePeriodIsSkipped)
+{
+    auto wheel = TimerWheel{1ms, startTime};
+    wheel.tick(startTime + 24h);
+    EXPECT_EQ(wheel.now(), startTime + 24h);
+
+    auto isExpired = false;
+    auto timer = TimerWheel::Timer{[&isExpired]
+                                   {
+                                       isExpired = true;
+                                   }};
+    wheel.arm(timer, 1s);
+    wheel.tick(startTime + 24h + 999ms);
+    EXPECT_FALSE(isExpired);
+    wheel.tick(startTime + 24h + 1s);
+    EXPECT_TRUE(isExpired);
+}
+
+TEST(TimerWheel, DestroyedWheelDisarmsTimers)
+{
+    auto timer = TimerWheel::Timer{};
+    {
+        auto wheel = TimerWheel{1ms, startTime};
+        wheel.arm(timer, 10ms);
+    }
+    EXPECT_FALSE(timer.isArmed());
+}
@@ -66,11 +66,12 @@ private:
     ///
     void processRequest(fcgi::Request&&, fcgi::Response&& response) override
     {
-        static auto payload = generateText(responseSize_);
-        response.setData("HTTP/1.1 200 OK\r\n "
-                         "Content-Type: text/html\r\n"
-                         "\r\n"
-                         + payload);
+        static const auto payload = std::make_shared<const std::string>(
+                "HTTP/1.1 200 OK\r\n "
+                "Content-Type: text/html\r\n"
+                "\r\n"
+                + generateText(responseSize_));
+        response.setData(payload);
         response.send();
     }
 
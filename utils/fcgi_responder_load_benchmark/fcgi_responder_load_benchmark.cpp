@@ -0,0 +1,456 @@
+#include "asio.hpp"
+#include <fcgi_responder/asio.h>
+#include <fcgi_responder/requester.h>
+#include <cmdlime/gnuconfig.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+///
+/// Self-contained load generator for FastCGI applications, built on fcgi::Requester.
+/// It sends requests with the parameters set like the ones sent by nginx, and prints
+/// the throughput and latency percentiles as JSON. When the application's address isn't set,
+/// the requests are sent to the built-in application based on fcgi::AsioResponderConnection.
+///
+
+using unixdomain = asio::local::stream_protocol;
+using tcp = asio::ip::tcp;
+
+struct Cfg : public cmdlime::GNUConfig{
+    CMDLIME_PARAM(address, std::string)() << "unix domain socket path of the FastCGI application, "
+                                             "if neither address nor host is set, the built-in application is used";
+    CMDLIME_PARAM(host, std::string)() << "TCP host of the FastCGI application";
+    CMDLIME_PARAM(port, int)(9000) << "TCP port of the FastCGI application";
+    CMDLIME_PARAM(requests, int)(100000) << "number of requests"
+                                         << [](int value) {
+                                              if (value < 1)
+                                                  throw cmdlime::ValidationError{"requests number must be greater than 0"};
+                                         };
+    CMDLIME_PARAM(connections, int)(10) << "number of concurrent connections"
+                                        << [](int value) {
+                                             if (value < 1)
+                                                 throw cmdlime::ValidationError{"connections number must be greater than 0"};
+                                        };
+    CMDLIME_FLAG(keepAlive) << "keep the connections open between the requests, like nginx with fastcgi_keep_conn on";
+    CMDLIME_PARAM(multiplexing, int)(1) << "number of concurrent requests on each keep-alive connection"
+                                        << [](int value) {
+                                             if (value < 1)
+                                                 throw cmdlime::ValidationError{"multiplexing must be greater than 0"};
+                                        };
+    CMDLIME_PARAM(bodySize, int)(0) << "minimum request body size in bytes";
+    CMDLIME_PARAM(bodySizeMax, int)(0) << "maximum request body size in bytes, "
+                                          "body sizes are uniformly distributed between body-size and body-size-max";
+    CMDLIME_PARAM(fragmentSize, int)(0) << "size of the fragments the request data is written in, 0 to write it at once";
+    CMDLIME_PARAM(responseSize, int)(1024) << "response size of the built-in application in bytes";
+};
+
+///
+/// Built-in application, it's served in its own thread
+///
+class AppConnection : public fcgi::AsioResponderConnection<unixdomain::socket>{
+public:
+    AppConnection(unixdomain::socket&& socket, std::shared_ptr<const std::string> response)
+        : fcgi::AsioResponderConnection<unixdomain::socket>{std::move(socket)}
+        , response_{std::move(response)}
+    {
+    }
+
+private:
+    void processRequest(fcgi::Request&&, fcgi::Response&& response) override
+    {
+        response.setData(response_);
+        response.send();
+    }
+
+private:
+    std::shared_ptr<const std::string> response_;
+};
+
+class App{
+public:
+    App(const std::string& socketPath, std::size_t responseSize)
+        : acceptor_{io_, makeEndpoint(socketPath)}
+        , response_{std::make_shared<const std::string>(
+                  "Status: 200 OK\r\n"
+                  "Content-Type: text/html\r\n"
+                  "\r\n"
+                  + std::string(responseSize, 'a'))}
+    {
+        accept();
+        thread_ = std::thread{[this]{ io_.run(); }};
+    }
+
+    ~App()
+    {
+        io_.stop();
+        thread_.join();
+    }
+
+private:
+    static unixdomain::endpoint makeEndpoint(const std::string& socketPath)
+    {
+        unlink(socketPath.c_str());
+        return unixdomain::endpoint{socketPath};
+    }
+
+    void accept()
+    {
+        acceptor_.async_accept([this](const auto& error, unixdomain::socket socket){
+            if (!error)
+                std::make_shared<AppConnection>(std::move(socket), response_)->start();
+            accept();
+        });
+    }
+
+private:
+    asio::io_context io_;
+    unixdomain::acceptor acceptor_;
+    std::shared_ptr<const std::string> response_;
+    std::thread thread_;
+};
+
+///
+/// Parameters set by nginx with the default fastcgi_params file
+///
+std::map<std::string, std::string> makeParams(int requestIndex, std::size_t bodySize)
+{
+    const auto uri = "/index.php?page=" + std::to_string(requestIndex % 100);
+    return {{"QUERY_STRING", "page=" + std::to_string(requestIndex % 100)},
+            {"REQUEST_METHOD", bodySize ? "POST" : "GET"},
+            {"CONTENT_TYPE", bodySize ? "application/x-www-form-urlencoded" : ""},
+            {"CONTENT_LENGTH", bodySize ? std::to_string(bodySize) : ""},
+            {"SCRIPT_NAME", "/index.php"},
+            {"SCRIPT_FILENAME", "/var/www/html/index.php"},
+            {"REQUEST_URI", uri},
+            {"DOCUMENT_URI", "/index.php"},
+            {"DOCUMENT_ROOT", "/var/www/html"},
+            {"SERVER_PROTOCOL", "HTTP/1.1"},
+            {"REQUEST_SCHEME", "http"},
+            {"GATEWAY_INTERFACE", "CGI/1.1"},
+            {"SERVER_SOFTWARE", "nginx/1.24.0"},
+            {"REMOTE_ADDR", "127.0.0.1"},
+            {"REMOTE_PORT", std::to_string(32768 + requestIndex % 28232)},
+            {"SERVER_ADDR", "127.0.0.1"},
+            {"SERVER_PORT", "80"},
+            {"SERVER_NAME", "localhost"},
+            {"REDIRECT_STATUS", "200"},
+            {"HTTP_HOST", "localhost"},
+            {"HTTP_USER_AGENT", "Mozilla/5.0 (X11; Linux x86_64; rv:109.0) Gecko/20100101 Firefox/115.0"},
+            {"HTTP_ACCEPT", "text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;q=0.8"},
+            {"HTTP_ACCEPT_LANGUAGE", "en-US,en;q=0.5"},
+            {"HTTP_ACCEPT_ENCODING", "gzip, deflate, br"},
+            {"HTTP_CONNECTION", "keep-alive"},
+            {"HTTP_COOKIE", "session=5f2b7c1e9a4d4b0c8e3f6a7d2c1b0e9f"}};
+}
+
+class LoadGenerator;
+
+template<typename TProtocol>
+class Client : public fcgi::Requester, public std::enable_shared_from_this<Client<TProtocol>>{
+public:
+    Client(typename TProtocol::socket&& socket, LoadGenerator& generator);
+    void start();
+
+private:
+    void sendRequests();
+    void read();
+    void write();
+    void close();
+    void sendData(const std::string& data) override;
+    void disconnect() override;
+
+private:
+    typename TProtocol::socket socket_;
+    LoadGenerator& generator_;
+    std::array<char, 65536> readBuffer_;
+    std::string pendingData_;
+    std::string writingData_;
+    std::size_t writeOffset_ = 0;
+    int activeRequestsNumber_ = 0;
+    bool isWriting_ = false;
+    bool isClosed_ = false;
+};
+
+class LoadGenerator{
+public:
+    explicit LoadGenerator(const Cfg& cfg)
+        : cfg_{cfg}
+        , body_(static_cast<std::size_t>(std::max(cfg.bodySize, cfg.bodySizeMax)), 'b')
+        , bodySizeDistribution_{cfg.bodySize, std::max(cfg.bodySize, cfg.bodySizeMax)}
+    {
+        latencies_.reserve(static_cast<std::size_t>(cfg.requests));
+    }
+
+    void run(const std::function<void(LoadGenerator&)>& connector)
+    {
+        connector_ = connector;
+        startTime_ = std::chrono::steady_clock::now();
+        for (auto i = 0; i < cfg_.connections && i < cfg_.requests; ++i)
+            connect();
+        io_.run();
+        duration_ = std::chrono::steady_clock::now() - startTime_;
+    }
+
+    asio::io_context& io()
+    {
+        return io_;
+    }
+
+    const Cfg& cfg() const
+    {
+        return cfg_;
+    }
+
+    bool hasRequestsToSend() const
+    {
+        return sentRequestsNumber_ < cfg_.requests;
+    }
+
+    template<typename TRequester>
+    void sendRequest(TRequester& requester, std::function<void()> responseHandler)
+    {
+        const auto requestIndex = sentRequestsNumber_++;
+        const auto bodySize = static_cast<std::size_t>(bodySizeDistribution_(random_));
+        const auto requestTime = std::chrono::steady_clock::now();
+        requester.sendRequest(
+                makeParams(requestIndex, bodySize),
+                body_.substr(0, bodySize),
+                [this, requestTime, responseHandler = std::move(responseHandler)](
+                        const std::optional<fcgi::ResponseData>& response)
+                {
+                    if (response) {
+                        const auto latency = std::chrono::steady_clock::now() - requestTime;
+                        latencies_.push_back(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+                    }
+                    else
+                        ++failedRequestsNumber_;
+                    responseHandler();
+                },
+                cfg_.keepAlive);
+    }
+
+    void onRequestsLost(int requestsNumber)
+    {
+        failedRequestsNumber_ += requestsNumber;
+    }
+
+    void onConnectionClosed()
+    {
+        if (hasRequestsToSend())
+            connect();
+    }
+
+    void onConnectionFailed()
+    {
+        ++failedConnectionsNumber_;
+        if (failedConnectionsNumber_ > cfg_.requests) {
+            std::cerr << "Can't connect to the FastCGI application" << std::endl;
+            io_.stop();
+            return;
+        }
+        onConnectionClosed();
+    }
+
+    void printReport() const
+    {
+        auto latencies = latencies_;
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&latencies](double value) -> long long
+        {
+            if (latencies.empty())
+                return 0;
+            const auto index = static_cast<std::size_t>(std::ceil(value * static_cast<double>(latencies.size())));
+            return latencies[std::clamp<std::size_t>(index, 1, latencies.size()) - 1];
+        };
+        const auto durationSec = std::chrono::duration<double>(duration_).count();
+
+        std::cout << "{"
+                  << "\"connections\":" << cfg_.connections << ","
+                  << "\"keep_alive\":" << (cfg_.keepAlive ? "true" : "false") << ","
+                  << "\"multiplexing\":" << cfg_.multiplexing << ","
+                  << "\"body_size\":" << cfg_.bodySize << ","
+                  << "\"body_size_max\":" << std::max(cfg_.bodySize, cfg_.bodySizeMax) << ","
+                  << "\"fragment_size\":" << cfg_.fragmentSize << ","
+                  << "\"requests\":" << latencies.size() << ","
+                  << "\"failed_requests\":" << failedRequestsNumber_ << ","
+                  << "\"duration_s\":" << durationSec << ","
+                  << "\"throughput_rps\":" << (durationSec > 0 ? static_cast<double>(latencies.size()) / durationSec : 0) << ","
+                  << "\"latency_us\":{"
+                  << "\"p50\":" << percentile(0.5) << ","
+                  << "\"p99\":" << percentile(0.99) << ","
+                  << "\"p99.9\":" << percentile(0.999) << ","
+                  << "\"max\":" << (latencies.empty() ? 0 : latencies.back())
+                  << "}}" << std::endl;
+    }
+
+private:
+    void connect()
+    {
+        connector_(*this);
+    }
+
+private:
+    const Cfg& cfg_;
+    asio::io_context io_;
+    std::function<void(LoadGenerator&)> connector_;
+    std::string body_;
+    std::mt19937 random_{1};
+    std::uniform_int_distribution<int> bodySizeDistribution_;
+    std::vector<long long> latencies_;
+    int sentRequestsNumber_ = 0;
+    int failedRequestsNumber_ = 0;
+    int failedConnectionsNumber_ = 0;
+    std::chrono::steady_clock::time_point startTime_;
+    std::chrono::steady_clock::duration duration_{};
+};
+
+template<typename TProtocol>
+Client<TProtocol>::Client(typename TProtocol::socket&& socket, LoadGenerator& generator)
+    : socket_{std::move(socket)}
+    , generator_{generator}
+{
+}
+
+template<typename TProtocol>
+void Client<TProtocol>::start()
+{
+    read();
+    sendRequests();
+}
+
+template<typename TProtocol>
+void Client<TProtocol>::sendRequests()
+{
+    const auto maxActiveRequestsNumber = generator_.cfg().keepAlive ? generator_.cfg().multiplexing : 1;
+    while (!isClosed_ && activeRequestsNumber_ < maxActiveRequestsNumber && availableRequestsNumber() > 0 &&
+           generator_.hasRequestsToSend()) {
+        ++activeRequestsNumber_;
+        // Requester keeps the response handler of the first request, so it can't own the client
+        generator_.sendRequest(*this, [this]{
+            --activeRequestsNumber_;
+            // the request id is released after the response handler call, so the next request is sent later
+            asio::post(socket_.get_executor(), [self = this->shared_from_this()]{ self->sendRequests(); });
+        });
+    }
+    if (!isClosed_ && activeRequestsNumber_ == 0 && !generator_.hasRequestsToSend())
+        close();
+}
+
+template<typename TProtocol>
+void Client<TProtocol>::read()
+{
+    socket_.async_read_some(asio::buffer(readBuffer_), [self = this->shared_from_this()](const auto& error, std::size_t size){
+        if (self->isClosed_)
+            return;
+        if (error) {
+            self->generator_.onRequestsLost(self->activeRequestsNumber_);
+            self->activeRequestsNumber_ = 0;
+            self->close();
+            return;
+        }
+        self->receiveData(self->readBuffer_.data(), size);
+        self->read();
+    });
+}
+
+template<typename TProtocol>
+void Client<TProtocol>::sendData(const std::string& data)
+{
+    pendingData_ += data;
+    write();
+}
+
+template<typename TProtocol>
+void Client<TProtocol>::write()
+{
+    if (isWriting_ || isClosed_)
+        return;
+    if (writeOffset_ == writingData_.size()) {
+        if (pendingData_.empty())
+            return;
+        writingData_.clear();
+        std::swap(writingData_, pendingData_);
+        writeOffset_ = 0;
+    }
+    auto size = writingData_.size() - writeOffset_;
+    if (generator_.cfg().fragmentSize > 0)
+        size = std::min(size, static_cast<std::size_t>(generator_.cfg().fragmentSize));
+
+    isWriting_ = true;
+    asio::async_write(socket_, asio::buffer(writingData_.data() + writeOffset_, size),
+                      [self = this->shared_from_this()](const auto& error, std::size_t size){
+                          self->isWriting_ = false;
+                          if (error)
+                              return;
+                          self->writeOffset_ += size;
+                          self->write();
+                      });
+}
+
+template<typename TProtocol>
+void Client<TProtocol>::disconnect()
+{
+    close();
+}
+
+template<typename TProtocol>
+void Client<TProtocol>::close()
+{
+    if (isClosed_)
+        return;
+    isClosed_ = true;
+    auto error = asio::error_code{};
+    socket_.shutdown(TProtocol::socket::shutdown_both, error);
+    socket_.close(error);
+    generator_.onConnectionClosed();
+}
+
+template<typename TProtocol>
+void connect(LoadGenerator& generator, const typename TProtocol::endpoint& endpoint)
+{
+    auto socket = std::make_shared<typename TProtocol::socket>(generator.io());
+    socket->async_connect(endpoint, [&generator, socket](const auto& error){
+        if (error) {
+            generator.onConnectionFailed();
+            return;
+        }
+        std::make_shared<Client<TProtocol>>(std::move(*socket), generator)->start();
+    });
+}
+
+int main (int argc, char** argv)
+{
+    auto cfg = Cfg{};
+    auto configReader = cmdlime::ConfigReader{cfg, "fcgi_responder_load_benchmark"};
+    if (!configReader.readCommandLine(argc, argv))
+        return configReader.exitCode();
+
+    auto app = std::unique_ptr<App>{};
+    auto socketPath = cfg.address;
+    if (socketPath.empty() && cfg.host.empty()) {
+        socketPath = "/tmp/fcgi_responder_load_benchmark.sock";
+        app = std::make_unique<App>(socketPath, static_cast<std::size_t>(std::max(cfg.responseSize, 0)));
+    }
+
+    auto generator = LoadGenerator{cfg};
+    if (!socketPath.empty())
+        generator.run([endpoint = unixdomain::endpoint{socketPath}](LoadGenerator& generator){
+            connect<unixdomain>(generator, endpoint);
+        });
+    else {
+        auto endpoint = tcp::endpoint{asio::ip::make_address(cfg.host), static_cast<unsigned short>(cfg.port)};
+        generator.run([endpoint](LoadGenerator& generator){
+            connect<tcp>(generator, endpoint);
+        });
+    }
+    generator.printReport();
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include <fcgi_responder/requester.h>
+#include <fcgi_responder/responder.h>
+#include <cmdlime/gnuconfig.h>
+#include <unistd.h>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+///
+/// Measures the memory used by the Responders of idle keep-alive connections:
+/// each Responder receives a single request, sends the response and waits for the next request.
+///
+
+class Connection : public fcgi::Responder{
+public:
+    explicit Connection(const std::shared_ptr<const std::string>& response)
+        : response_{response}
+    {
+    }
+
+    void process(const std::string& requestData)
+    {
+        receiveData(requestData.data(), requestData.size());
+    }
+
+    static int processedRequestsNumber()
+    {
+        return processedRequestsNumber_;
+    }
+
+private:
+    void sendData(const std::string&) override
+    {
+    }
+
+    void disconnect() override
+    {
+    }
+
+    void processRequest(fcgi::Request&&, fcgi::Response&& response) override
+    {
+        response.setData(response_);
+        response.send();
+        ++processedRequestsNumber_;
+    }
+
+private:
+    std::shared_ptr<const std::string> response_;
+    static inline int processedRequestsNumber_ = 0;
+};
+
+///
+/// Responder used to reply to the FCGI_GET_VALUES record, which the Requester sends before its first request
+///
+class ConnectionSettingsReplier : public fcgi::Responder{
+public:
+    std::string reply(const std::string& getValuesData)
+    {
+        receiveData(getValuesData.data(), getValuesData.size());
+        return std::move(data_);
+    }
+
+private:
+    void sendData(const std::string& data) override
+    {
+        data_ += data;
+    }
+
+    void disconnect() override
+    {
+    }
+
+    void processRequest(fcgi::Request&&, fcgi::Response&&) override
+    {
+    }
+
+private:
+    std::string data_;
+};
+
+///
+/// Requester used to get the data of a request sent by the web server
+///
+class RequestWriter : public fcgi::Requester{
+public:
+    std::string makeRequest()
+    {
+        sendRequest({{"REQUEST_METHOD", "GET"},
+                     {"REMOTE_ADDR", "127.0.0.1"},
+                     {"HTTP_HOST", "localhost"},
+                     {"REQUEST_URI", "/"}},
+                    {},
+                    [](const std::optional<fcgi::ResponseData>&) {},
+                    true);
+        // the request records are sent only after the application replies with its connection settings
+        const auto getValuesResultData = ConnectionSettingsReplier{}.reply(std::exchange(data_, {}));
+        receiveData(getValuesResultData.data(), getValuesResultData.size());
+        return std::move(data_);
+    }
+
+private:
+    void sendData(const std::string& data) override
+    {
+        data_ += data;
+    }
+
+    void disconnect() override
+    {
+    }
+
+private:
+    std::string data_;
+};
+
+std::size_t residentMemorySize()
+{
+    auto statm = std::ifstream{"/proc/self/statm"};
+    auto totalPages = std::size_t{};
+    auto residentPages = std::size_t{};
+    statm >> totalPages >> residentPages;
+    return residentPages * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+struct Cfg : public cmdlime::GNUConfig{
+    CMDLIME_PARAM(connections, int)(20000) << "number of idle connections"
+                                           << [](int value) {
+                                                if (value < 1)
+                                                    throw cmdlime::ValidationError{"connections number must be greater than 0"};
+                                           };
+    CMDLIME_PARAM(responseSize, int)(200) << "response size in bytes"
+                                          << [](int value) {
+                                               if (value < 0)
+                                                   throw cmdlime::ValidationError{"response size can't be negative"};
+                                          };
+};
+
+int main (int argc, char** argv)
+{
+    auto cfg = Cfg{};
+    auto configReader = cmdlime::ConfigReader{cfg, "fcgi_responder_memory_benchmark"};
+    if (!configReader.readCommandLine(argc, argv))
+        return configReader.exitCode();
+
+    const auto response = std::make_shared<const std::string>(
+            "Status: 200 OK\r\n"
+            "Content-Type: text/html\r\n"
+            "\r\n"
+            + std::string(static_cast<std::size_t>(cfg.responseSize), 'a'));
+    const auto requestData = RequestWriter{}.makeRequest();
+
+    auto connections = std::vector<std::unique_ptr<Connection>>{};
+    connections.reserve(static_cast<std::size_t>(cfg.connections));
+    const auto initialMemorySize = residentMemorySize();
+    for (auto i = 0; i < cfg.connections; ++i) {
+        auto& connection = connections.emplace_back(std::make_unique<Connection>(response));
+        connection->process(requestData);
+    }
+    const auto memorySize = residentMemorySize() - initialMemorySize;
+    if (Connection::processedRequestsNumber() != cfg.connections) {
+        std::cerr << "Processed requests: " << Connection::processedRequestsNumber() << ", expected "
+                  << cfg.connections << std::endl;
+        return 1;
+    }
+
+    std::cout << "Idle connections: " << cfg.connections << std::endl;
+    std::cout << "Memory used: " << memorySize / 1024 << " KB" << std::endl;
+    std::cout << "Memory per idle connection: " << memorySize / connections.size() << " bytes" << std::endl;
+    return 0;
+}
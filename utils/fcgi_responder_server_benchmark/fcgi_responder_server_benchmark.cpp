@@ -0,0 +1,88 @@
+#include <fcgi_responder/server.h>
+#ifdef FCGI_RESPONDER_SERVER_IO_URING
+#include <fcgi_responder/uringserver.h>
+#endif
+#include <cmdlime/gnuconfig.h>
+#include <sys/stat.h>
+#include <iostream>
+#include <numeric>
+#include <type_traits>
+
+std::string generateText(std::size_t sizeKb)
+{
+    auto res = std::string{};
+    for (auto i = 0u; i < sizeKb; ++i)
+        res += "Lorem ipsum dolor sit amet, consectetuer adipiscing elit. Aenean commodo ligula eget dolor. Aenean massa. Cum sociis natoque penatibus et magnis dis parturient montes, nascetur ridiculus mus. Donec quam felis, ultricies nec, pellentesque eu, pretium quis, sem. Nulla consequat massa quis enim. Donec pede justo, fringilla vel, aliquet nec, vulputate eget, arcu. In enim justo, rhoncus ut, imperdiet a, venenatis vitae, justo. Nullam dictum felis eu pede mollis pretium. Integer tincidunt. Cras dapibus. Vivamus elementum semper nisi. Aenean vulputate eleifend tellus. Aenean leo ligula, porttitor eu, consequat vitae, eleifend ac, enim. Aliquam lorem ante, dapibus in, viverra quis, feugiat a, tellus. Phasellus viverra nulla ut metus varius laoreet. Quisque rutrum. Aenean imperdiet. Etiam ultricies nisi vel augue. Curabitur ullamcorper ultricies nisi. Nam eget dui. Etiam rhoncus. Maecenas tempus, tellus eget condimentum rhoncus, sem quam semper libero, sit amet adipiscing sem neque sed ipsum. Nam quam nunc, blandit  \n";
+    return res;
+}
+
+struct Cfg : public cmdlime::GNUConfig{
+    CMDLIME_PARAM(responseSize, int) << "response size in kb"
+                                     << [](int value) {
+                                          if (value < 1)
+                                              throw cmdlime::ValidationError{"response size must be greater than 0"};
+                                     };
+    CMDLIME_PARAM(engine, std::string)("epoll") << "server engine: epoll or io_uring"
+                                                << [](const std::string& value) {
+                                                     if (value != "epoll" && value != "io_uring")
+                                                         throw cmdlime::ValidationError{"engine must be epoll or io_uring"};
+                                                };
+    CMDLIME_PARAM(threads, int)(1) << "number of event loop threads (epoll engine only)"
+                                   << [](int value) {
+                                        if (value < 1)
+                                            throw cmdlime::ValidationError{"threads number must be greater than 0"};
+                                   };
+    CMDLIME_FLAG(pinThreads) << "pin each event loop thread to its own CPU core";
+};
+
+template<typename TServer>
+void runServer(const Cfg& cfg)
+{
+    const auto payload = std::make_shared<const std::string>(
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: text/html\r\n"
+            "\r\n"
+            + generateText(static_cast<std::size_t>(cfg.responseSize)));
+
+    auto server = TServer{[payload](fcgi::Request&&, fcgi::Response&& response)
+                          {
+                              response.setData(payload);
+                              response.send();
+                          }};
+    server.setErrorInfoHandler([](const std::string& errorInfo)
+                               {
+                                   std::cerr << errorInfo << std::endl;
+                               });
+    if constexpr (std::is_same_v<TServer, fcgi::Server>) {
+        server.setThreadsNumber(cfg.threads);
+        if (cfg.pinThreads) {
+            auto cpuIds = std::vector<int>(static_cast<std::size_t>(cfg.threads));
+            std::iota(cpuIds.begin(), cpuIds.end(), 0);
+            server.setCpuAffinity(std::move(cpuIds));
+        }
+    }
+    auto socketPath = std::string{"/tmp/fcgi.sock"};
+    umask(0);
+    server.listen(socketPath);
+    server.run();
+}
+
+int main (int argc, char** argv)
+{
+    auto cfg = Cfg{};
+    auto configReader = cmdlime::ConfigReader{cfg, "fcgi_responder_server_benchmark"};
+    if (!configReader.readCommandLine(argc, argv))
+        return configReader.exitCode();
+
+    if (cfg.engine == "epoll")
+        runServer<fcgi::Server>(cfg);
+    else {
+#ifdef FCGI_RESPONDER_SERVER_IO_URING
+        runServer<fcgi::UringServer>(cfg);
+#else
+        std::cerr << "io_uring engine isn't available, rebuild with ENABLE_SERVER_IO_URING option" << std::endl;
+        return 1;
+#endif
+    }
+    return 0;
+}